@@ -4,30 +4,56 @@
 #
 #-------------------------------------------------
 
-QT       += core gui opengl  #x11extras
+QT       += core gui opengl concurrent  #x11extras
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 TARGET = OccWidget
 TEMPLATE = app
 
+CONFIG += c++11
+
 
 SOURCES += main.cpp\
         mainwindow.cpp \
-    occview.cpp
+    occview.cpp \
+    instancelibrary.cpp \
+    scenecommands.cpp \
+    subshapeselection.cpp \
+    selectionactivator.cpp \
+    stylepalette.cpp \
+    staticbatch.cpp \
+    viewculler.cpp \
+    viewprojection.cpp \
+    sectionplanes.cpp \
+    propertiespanel.cpp \
+    inputtrace.cpp \
+    inputreplay.cpp
 
 HEADERS  += mainwindow.h \
-    occview.h
+    occview.h \
+    instancelibrary.h \
+    scenecommands.h \
+    subshapeselection.h \
+    selectionactivator.h \
+    stylepalette.h \
+    staticbatch.h \
+    viewculler.h \
+    viewprojection.h \
+    sectionplanes.h \
+    propertiespanel.h \
+    inputtrace.h \
+    inputreplay.h
 
 FORMS    += mainwindow.ui
 
-INCLUDEPATH += /usr/include/oce
+# the modeling code is in the modeling library, build from occqt.pro.
+include(modeling/modeling.pri)
 
-LIBS += -L/usr/lib64/oce -lTKernel -lPTKernel -lTKMath -lTKService -lTKV3d -lTKOpenGl \
-        -lTKBRep -lTKIGES -lTKSTL -lTKVRML -lTKSTEP -lTKSTEPAttr -lTKSTEP209 \
-        -lTKSTEPBase -lTKShapeSchema -lTKGeomBase -lTKGeomAlgo -lTKG3d -lTKG2d \
-        -lTKXSBase -lTKPShape -lTKShHealing -lTKHLR -lTKTopAlgo -lTKMesh -lTKPrim \
-        -lTKCDF -lTKBool -lTKBO -lTKFillet -lTKOffset \
+# the viewer toolkits, the data exchange ones are linked by plugins/exchange
+# only. occqt.pro builds that plugin into the plugins directory next to the
+# application, where ToolkitPlugins loads it on the first export.
+LIBS += -L/usr/lib64/oce -lPTKernel -lTKV3d -lTKOpenGl \
         #-lfreeimage
         #-lX11
 
@@ -0,0 +1,21 @@
+#-------------------------------------------------
+#
+# Headless batch tool, runs job files on servers without a display.
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+QT       -= widgets
+
+TARGET = occbatch
+TEMPLATE = app
+
+CONFIG += console c++11
+CONFIG -= app_bundle
+
+# next to the application, so both find the plugins directory.
+DESTDIR = $$OUT_PWD/..
+
+SOURCES += main.cpp
+
+include(../modeling/modeling.pri)
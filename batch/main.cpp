@@ -0,0 +1,70 @@
+#include "batchrunner.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThreadPool>
+
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser aParser;
+    aParser.setApplicationDescription("Run modeling job files without GUI and print a timing summary.");
+    aParser.addHelpOption();
+    aParser.addPositionalArgument("file", "The job file.");
+
+    QCommandLineOption aThreadsOption("threads", "Number of worker threads, all cores by default.", "count");
+    QCommandLineOption aRepeatOption("repeat", "Run the jobs this many times and print the throughput.", "count", "1");
+    aParser.addOption(aThreadsOption);
+    aParser.addOption(aRepeatOption);
+    aParser.process(a);
+
+    if (aParser.positionalArguments().size() != 1)
+    {
+        aParser.showHelp(2);
+    }
+
+    if (aParser.isSet(aThreadsOption))
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, aParser.value(aThreadsOption).toInt()));
+    }
+
+    const int aRepeatCount = qMax(1, aParser.value(aRepeatOption).toInt());
+
+    int aFailures = 0;
+    int aJobCount = 0;
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    for (int i = 0; i < aRepeatCount; ++i)
+    {
+        // a new runner each time, no result is reused between the runs.
+        BatchRunner aRunner;
+
+        if (!aRunner.load(aParser.positionalArguments().first()))
+        {
+            std::fprintf(stderr, "%s\n", aRunner.errorString().toLocal8Bit().constData());
+            return 2;
+        }
+
+        aFailures += aRunner.run();
+        aJobCount += aRunner.jobCount();
+
+        if (i == aRepeatCount - 1)
+        {
+            std::fputs(aRunner.summary().toLocal8Bit().constData(), stdout);
+        }
+    }
+
+    if (aRepeatCount > 1)
+    {
+        const double aSeconds = qMax<qint64>(1, aTimer.elapsed()) / 1000.0;
+        std::printf("%d runs, %d jobs in %.3f s, %.1f jobs/s\n", aRepeatCount, aJobCount, aSeconds, aJobCount / aSeconds);
+    }
+
+    return aFailures == 0 ? 0 : 1;
+}
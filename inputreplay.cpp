@@ -0,0 +1,142 @@
+#include "inputreplay.h"
+#include "occview.h"
+
+#include <QCoreApplication>
+#include <QMouseEvent>
+#include <QTimer>
+#include <QWheelEvent>
+
+#include <algorithm>
+
+InputReplay::InputReplay(OccView* theView, QObject* theParent)
+    : QObject(theParent),
+      mView(theView),
+      mIsRealTime(false),
+      mNext(-1),
+      mWallTime(0)
+{
+}
+
+void InputReplay::start(const InputTrace& theTrace, const bool isRealTime)
+{
+    mTrace = theTrace;
+    mIsRealTime = isRealTime;
+    mNext = 0;
+    mWallTime = 0;
+    mTimes.clear();
+
+    mTrace.restore(mView);
+
+    mClock.start();
+
+    const qint64 aDelay = mIsRealTime && !mTrace.events().isEmpty() ? mTrace.events().first().time : 0;
+
+    QTimer::singleShot(int(aDelay), this, SLOT(next()));
+}
+
+bool InputReplay::isRunning() const
+{
+    return mNext >= 0;
+}
+
+void InputReplay::next()
+{
+    const QVector<InputTrace::Event>& anEvents = mTrace.events();
+
+    if (mNext < anEvents.size())
+    {
+        const InputTrace::Event& anEvent = anEvents.at(mNext);
+
+        QElapsedTimer aTimer;
+        aTimer.start();
+
+        dispatch(anEvent);
+
+        mTimes[kindOf(anEvent)].append(aTimer.nsecsElapsed() / 1.0e6);
+
+        ++mNext;
+    }
+
+    if (mNext < anEvents.size())
+    {
+        // behind the recorded pace the next event is sent at once.
+        const qint64 aDelay = mIsRealTime ? qMax<qint64>(0, anEvents.at(mNext).time - mClock.elapsed()) : 0;
+
+        QTimer::singleShot(int(aDelay), this, SLOT(next()));
+        return;
+    }
+
+    mWallTime = mClock.elapsed();
+    mNext = -1;
+
+    emit finished();
+}
+
+QString InputReplay::kindOf(const InputTrace::Event& theEvent)
+{
+    if (theEvent.type == InputTrace::Move)
+    {
+        return theEvent.buttons == Qt::NoButton ? "hover" : "drag";
+    }
+
+    return InputTrace::typeName(theEvent.type);
+}
+
+void InputReplay::dispatch(const InputTrace::Event& theEvent)
+{
+    const Qt::MouseButtons aButtons(theEvent.buttons);
+    const Qt::KeyboardModifiers aModifiers(theEvent.modifiers);
+
+    if (theEvent.type == InputTrace::Wheel)
+    {
+        QWheelEvent aWheel(theEvent.pos, theEvent.delta, aButtons, aModifiers);
+        QCoreApplication::sendEvent(mView, &aWheel);
+        return;
+    }
+
+    const QEvent::Type aTypes[] = { QEvent::MouseButtonPress, QEvent::MouseButtonRelease, QEvent::MouseMove };
+
+    QMouseEvent aMouse(aTypes[theEvent.type], theEvent.pos, Qt::MouseButton(theEvent.button), aButtons, aModifiers);
+    QCoreApplication::sendEvent(mView, &aMouse);
+}
+
+QString InputReplay::report() const
+{
+    QString aReport("event,count,mean_ms,p50_ms,p95_ms,max_ms\n");
+
+    for (QMap<QString, QVector<double> >::const_iterator anIter = mTimes.constBegin(); anIter != mTimes.constEnd(); ++anIter)
+    {
+        QVector<double> aTimes = anIter.value();
+        std::sort(aTimes.begin(), aTimes.end());
+
+        double aSum = 0.0;
+
+        foreach (double aTime, aTimes)
+        {
+            aSum += aTime;
+        }
+
+        aReport += QString("%1,%2,%3,%4,%5,%6\n")
+                .arg(anIter.key())
+                .arg(aTimes.size())
+                .arg(aSum / aTimes.size(), 0, 'f', 3)
+                .arg(aTimes.at(aTimes.size() / 2), 0, 'f', 3)
+                .arg(aTimes.at(qMin(aTimes.size() - 1, aTimes.size() * 95 / 100)), 0, 'f', 3)
+                .arg(aTimes.last(), 0, 'f', 3);
+    }
+
+    aReport += QString("%1 events, recorded %2 ms, replayed %3 ms %4\n")
+            .arg(mTrace.events().size())
+            .arg(mTrace.duration())
+            .arg(mWallTime)
+            .arg(mIsRealTime ? "at the recorded pace" : "at maximum speed");
+
+    if (mTrace.size() != mView->size())
+    {
+        aReport += QString("warning: recorded on a %1x%2 view, replayed on %3x%4\n")
+                .arg(mTrace.size().width()).arg(mTrace.size().height())
+                .arg(mView->width()).arg(mView->height());
+    }
+
+    return aReport;
+}
@@ -0,0 +1,58 @@
+#ifndef INPUTREPLAY_H
+#define INPUTREPLAY_H
+
+#include <QElapsedTimer>
+#include <QMap>
+#include <QObject>
+#include <QVector>
+
+#include "inputtrace.h"
+
+class OccView;
+
+//! Feeds a recorded InputTrace back to an OccView, either at the recorded
+//! pace or each event as soon as the previous one is handled, and times
+//! how long the view takes for each event. Drags and wheel steps measure
+//! the redraws, hover moves the detection and releases the picking.
+class InputReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit InputReplay(OccView* theView, QObject* theParent = 0);
+
+    //! restore the recorded view state and start sending the events.
+    void start(const InputTrace& theTrace, const bool isRealTime);
+
+    bool isRunning() const;
+
+    //! per kind of event: count, mean, median, 95th percentile and max in ms.
+    QString report() const;
+
+signals:
+    void finished(void);
+
+private slots:
+    void next(void);
+
+private:
+    //! the timing category of an event.
+    static QString kindOf(const InputTrace::Event& theEvent);
+
+    void dispatch(const InputTrace::Event& theEvent);
+
+    OccView* mView;
+
+    InputTrace mTrace;
+    bool mIsRealTime;
+    int mNext;
+
+    //! time since the first event.
+    QElapsedTimer mClock;
+    qint64 mWallTime;
+
+    //! handling times in ms by kind of event.
+    QMap<QString, QVector<double> > mTimes;
+};
+
+#endif // INPUTREPLAY_H
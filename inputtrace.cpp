@@ -0,0 +1,232 @@
+#include "inputtrace.h"
+#include "occview.h"
+
+#include <QFile>
+#include <QMouseEvent>
+#include <QStringList>
+#include <QTextStream>
+#include <QWheelEvent>
+
+namespace
+{
+    const char* THE_TYPE_NAMES[] = { "press", "release", "move", "wheel" };
+}
+
+InputTrace::InputTrace()
+    : mMode(OccView::CurAction3d_DynamicRotation)
+{
+    for (int i = 0; i < 10; ++i)
+    {
+        mCamera[i] = 0.0;
+    }
+}
+
+void InputTrace::start(OccView* theView)
+{
+    mEvents.clear();
+    mSize = theView->size();
+    mMode = theView->currentAction();
+
+    Handle_V3d_View aView = theView->getMyView();
+    aView->Eye(mCamera[0], mCamera[1], mCamera[2]);
+    aView->At(mCamera[3], mCamera[4], mCamera[5]);
+    aView->Up(mCamera[6], mCamera[7], mCamera[8]);
+    mCamera[9] = aView->Scale();
+
+    mTimer.start();
+}
+
+void InputTrace::record(const Type theType, const QMouseEvent* theEvent)
+{
+    Event anEvent;
+    anEvent.time = mTimer.elapsed();
+    anEvent.type = theType;
+    anEvent.pos = theEvent->pos();
+    anEvent.button = theEvent->button();
+    anEvent.buttons = theEvent->buttons();
+    anEvent.modifiers = theEvent->modifiers();
+    anEvent.delta = 0;
+
+    mEvents.append(anEvent);
+}
+
+void InputTrace::record(const QWheelEvent* theEvent)
+{
+    Event anEvent;
+    anEvent.time = mTimer.elapsed();
+    anEvent.type = Wheel;
+    anEvent.pos = theEvent->pos();
+    anEvent.button = Qt::NoButton;
+    anEvent.buttons = theEvent->buttons();
+    anEvent.modifiers = theEvent->modifiers();
+    anEvent.delta = theEvent->delta();
+
+    mEvents.append(anEvent);
+}
+
+void InputTrace::restore(OccView* theView) const
+{
+    theView->setCurrentAction(OccView::CurrentAction3d(mMode));
+
+    Handle_V3d_View aView = theView->getMyView();
+
+    const Standard_Boolean wasImmediate = aView->SetImmediateUpdate(Standard_False);
+    aView->SetAt(mCamera[3], mCamera[4], mCamera[5]);
+    aView->SetEye(mCamera[0], mCamera[1], mCamera[2]);
+    aView->SetUp(mCamera[6], mCamera[7], mCamera[8]);
+    aView->SetScale(mCamera[9]);
+    aView->SetImmediateUpdate(wasImmediate);
+
+    theView->redraw();
+}
+
+const QVector<InputTrace::Event>& InputTrace::events() const
+{
+    return mEvents;
+}
+
+QSize InputTrace::size() const
+{
+    return mSize;
+}
+
+qint64 InputTrace::duration() const
+{
+    return mEvents.isEmpty() ? 0 : mEvents.last().time;
+}
+
+QString InputTrace::typeName(const Type theType)
+{
+    return THE_TYPE_NAMES[theType];
+}
+
+bool InputTrace::save(const QString& theFileName, QString& theError) const
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        theError = QString("cannot write %1").arg(theFileName);
+        return false;
+    }
+
+    QTextStream aStream(&aFile);
+    aStream.setRealNumberPrecision(17);
+
+    aStream << "# occqt input trace\n";
+    aStream << "size " << mSize.width() << " " << mSize.height() << "\n";
+    aStream << "mode " << mMode << "\n";
+    aStream << "camera";
+
+    for (int i = 0; i < 10; ++i)
+    {
+        aStream << " " << mCamera[i];
+    }
+
+    aStream << "\n# time type x y button buttons modifiers delta\n";
+
+    foreach (const Event& anEvent, mEvents)
+    {
+        aStream << anEvent.time << " " << typeName(anEvent.type) << " "
+                << anEvent.pos.x() << " " << anEvent.pos.y() << " "
+                << anEvent.button << " " << anEvent.buttons << " "
+                << anEvent.modifiers << " " << anEvent.delta << "\n";
+    }
+
+    // a full disk only shows once the buffers are written.
+    aStream.flush();
+    aFile.close();
+
+    if (aStream.status() != QTextStream::Ok || aFile.error() != QFile::NoError)
+    {
+        theError = QString("cannot write %1: %2").arg(theFileName).arg(aFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool InputTrace::load(const QString& theFileName, QString& theError)
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        theError = QString("cannot read %1").arg(theFileName);
+        return false;
+    }
+
+    mEvents.clear();
+
+    QTextStream aStream(&aFile);
+
+    for (int aLine = 1; !aStream.atEnd(); ++aLine)
+    {
+        const QStringList aWords = aStream.readLine().split(' ', QString::SkipEmptyParts);
+
+        if (aWords.isEmpty() || aWords.first().startsWith('#'))
+        {
+            continue;
+        }
+
+        if (aWords.first() == "size" && aWords.size() == 3)
+        {
+            mSize = QSize(aWords.at(1).toInt(), aWords.at(2).toInt());
+        }
+        else if (aWords.first() == "mode" && aWords.size() == 2)
+        {
+            bool isOk = false;
+            const int aMode = aWords.at(1).toInt(&isOk);
+
+            if (!isOk || aMode < OccView::CurAction3d_Nothing || aMode > OccView::CurAction3d_SectionMoving)
+            {
+                theError = QString("%1:%2: unknown mode '%3'").arg(theFileName).arg(aLine).arg(aWords.at(1));
+                return false;
+            }
+
+            mMode = aMode;
+        }
+        else if (aWords.first() == "camera" && aWords.size() == 11)
+        {
+            for (int i = 0; i < 10; ++i)
+            {
+                mCamera[i] = aWords.at(i + 1).toDouble();
+            }
+        }
+        else if (aWords.size() == 8)
+        {
+            Event anEvent;
+            anEvent.time = aWords.at(0).toLongLong();
+            anEvent.type = Type(-1);
+
+            for (int i = Press; i <= Wheel; ++i)
+            {
+                if (aWords.at(1) == THE_TYPE_NAMES[i])
+                {
+                    anEvent.type = Type(i);
+                }
+            }
+
+            if (anEvent.type == Type(-1))
+            {
+                theError = QString("%1:%2: unknown event '%3'").arg(theFileName).arg(aLine).arg(aWords.at(1));
+                return false;
+            }
+
+            anEvent.pos = QPoint(aWords.at(2).toInt(), aWords.at(3).toInt());
+            anEvent.button = aWords.at(4).toInt();
+            anEvent.buttons = aWords.at(5).toInt();
+            anEvent.modifiers = aWords.at(6).toInt();
+            anEvent.delta = aWords.at(7).toInt();
+
+            mEvents.append(anEvent);
+        }
+        else
+        {
+            theError = QString("%1:%2: syntax error").arg(theFileName).arg(aLine);
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,74 @@
+#ifndef INPUTTRACE_H
+#define INPUTTRACE_H
+
+#include <QElapsedTimer>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+#include <QVector>
+
+class QMouseEvent;
+class QWheelEvent;
+class OccView;
+
+//! The mouse and wheel events received by an OccView, with their time since
+//! the start of the recording. The trace also keeps the view size, the mouse
+//! mode and the camera at the start, so a replay begins from the same state.
+//! It is saved as text, one event per line.
+class InputTrace
+{
+public:
+    enum Type
+    {
+        Press,
+        Release,
+        Move,
+        Wheel
+    };
+
+    struct Event
+    {
+        qint64 time;
+        Type type;
+        QPoint pos;
+        int button;
+        int buttons;
+        int modifiers;
+        int delta;
+    };
+
+    InputTrace();
+
+    //! forget the events and take the size, mode and camera of theView.
+    void start(OccView* theView);
+
+    //! append an event at the time elapsed since start().
+    void record(const Type theType, const QMouseEvent* theEvent);
+    void record(const QWheelEvent* theEvent);
+
+    //! put theView back in the state of the start of the recording.
+    void restore(OccView* theView) const;
+
+    const QVector<Event>& events() const;
+    QSize size() const;
+
+    //! the time of the last event in milliseconds.
+    qint64 duration() const;
+
+    bool save(const QString& theFileName, QString& theError) const;
+    bool load(const QString& theFileName, QString& theError);
+
+    static QString typeName(const Type theType);
+
+private:
+    QVector<Event> mEvents;
+    QElapsedTimer mTimer;
+
+    QSize mSize;
+    int mMode;
+
+    //! eye, at, up and scale of the camera.
+    double mCamera[10];
+};
+
+#endif // INPUTTRACE_H
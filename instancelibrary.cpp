@@ -0,0 +1,118 @@
+#include "instancelibrary.h"
+#include "meshcache.h"
+
+#include <TopLoc_Location.hxx>
+
+InstanceLibrary::InstanceLibrary(const Handle_AIS_InteractiveContext& theContext, MeshCache& theMeshCache)
+    : mContext(theContext),
+      mMeshCache(theMeshCache)
+{
+}
+
+Handle_AIS_Shape InstanceLibrary::addPrototype(const QString& theName, const TopoDS_Shape& theShape, const Quantity_Color& theColor)
+{
+    if (mPrototypes.contains(theName))
+    {
+        return mPrototypes.value(theName);
+    }
+
+    // the triangulation lives in the TShape, so meshing the prototype meshes every instance.
+    mMeshCache.mesh(theShape, MeshCache::deflection(theShape));
+
+    Handle_AIS_Shape aPrototype = new AIS_Shape(theShape);
+    aPrototype->SetColor(theColor);
+
+    mPrototypes.insert(theName, aPrototype);
+
+    return aPrototype;
+}
+
+bool InstanceLibrary::contains(const QString& theName) const
+{
+    return mPrototypes.contains(theName);
+}
+
+Handle_AIS_Shape InstanceLibrary::prototype(const QString& theName) const
+{
+    return mPrototypes.value(theName);
+}
+
+Handle_AIS_ConnectedInteractive InstanceLibrary::instantiate(const QString& theName, const gp_Trsf& theTrsf, const Standard_Boolean theToUpdateViewer)
+{
+    Handle_AIS_ConnectedInteractive anInstance = place(theName, theTrsf);
+
+    if (!anInstance.IsNull())
+    {
+        mContext->Display(anInstance, theToUpdateViewer);
+    }
+
+    return anInstance;
+}
+
+Handle_AIS_ConnectedInteractive InstanceLibrary::place(const QString& theName, const gp_Trsf& theTrsf)
+{
+    Handle_AIS_ConnectedInteractive anInstance;
+
+    if (!mPrototypes.contains(theName))
+    {
+        return anInstance;
+    }
+
+    anInstance = new AIS_ConnectedInteractive();
+    anInstance->Connect(mPrototypes.value(theName), theTrsf);
+
+    Placement aPlacement;
+    aPlacement.name = theName;
+    aPlacement.trsf = theTrsf;
+
+    mInstances.insert(anInstance.Access(), anInstance);
+    mPlacements.insert(anInstance.Access(), aPlacement);
+
+    return anInstance;
+}
+
+TopoDS_Shape InstanceLibrary::placedShape(const QString& theName, const gp_Trsf& theTrsf) const
+{
+    if (!mPrototypes.contains(theName))
+    {
+        return TopoDS_Shape();
+    }
+
+    return mPrototypes.value(theName)->Shape().Moved(TopLoc_Location(theTrsf));
+}
+
+TopoDS_Shape InstanceLibrary::placedShape(const Handle_AIS_InteractiveObject& theInstance) const
+{
+    if (theInstance.IsNull() || !mPlacements.contains(theInstance.Access()))
+    {
+        return TopoDS_Shape();
+    }
+
+    const Placement& aPlacement = mPlacements[theInstance.Access()];
+
+    return placedShape(aPlacement.name, aPlacement.trsf);
+}
+
+void InstanceLibrary::clear()
+{
+    foreach (const Handle_AIS_ConnectedInteractive& anInstance, mInstances)
+    {
+        mContext->Remove(anInstance, Standard_False);
+    }
+
+    mInstances.clear();
+    mPlacements.clear();
+    mPrototypes.clear();
+
+    mContext->UpdateCurrentViewer();
+}
+
+int InstanceLibrary::prototypeCount() const
+{
+    return mPrototypes.size();
+}
+
+int InstanceLibrary::instanceCount() const
+{
+    return mInstances.size();
+}
@@ -0,0 +1,66 @@
+#ifndef INSTANCELIBRARY_H
+#define INSTANCELIBRARY_H
+
+#include <QHash>
+#include <QString>
+
+#include <TopoDS_Shape.hxx>
+#include <gp_Trsf.hxx>
+
+#include <AIS_ConnectedInteractive.hxx>
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+
+class MeshCache;
+
+//! Shared prototypes and their located instances.
+//! A prototype is one AIS_Shape (one TShape, one triangulation, one
+//! presentation), every instance is an AIS_ConnectedInteractive that only
+//! adds a transformation, so N placements cost one part plus N transforms.
+class InstanceLibrary
+{
+public:
+    InstanceLibrary(const Handle_AIS_InteractiveContext& theContext, MeshCache& theMeshCache);
+
+    //! register a prototype, an existing prototype with the same name is kept.
+    Handle_AIS_Shape addPrototype(const QString& theName, const TopoDS_Shape& theShape, const Quantity_Color& theColor);
+
+    bool contains(const QString& theName) const;
+    Handle_AIS_Shape prototype(const QString& theName) const;
+
+    //! create one placement of a prototype without displaying it, for example for an undo command.
+    Handle_AIS_ConnectedInteractive place(const QString& theName, const gp_Trsf& theTrsf);
+
+    //! display one placement of a prototype.
+    Handle_AIS_ConnectedInteractive instantiate(const QString& theName, const gp_Trsf& theTrsf, const Standard_Boolean theToUpdateViewer = Standard_False);
+
+    //! the prototype shape moved to theTrsf, it shares the TShape for modeling algorithms.
+    TopoDS_Shape placedShape(const QString& theName, const gp_Trsf& theTrsf) const;
+
+    //! the located shape of an instance created by this library, null otherwise.
+    TopoDS_Shape placedShape(const Handle_AIS_InteractiveObject& theInstance) const;
+
+    //! erase all the instances and forget the prototypes.
+    void clear();
+
+    int prototypeCount() const;
+    int instanceCount() const;
+
+private:
+    struct Placement
+    {
+        QString name;
+        gp_Trsf trsf;
+    };
+
+    Handle_AIS_InteractiveContext mContext;
+    MeshCache& mMeshCache;
+
+    QHash<QString, Handle_AIS_Shape> mPrototypes;
+
+    //! instances keyed by their address, the handle keeps them alive.
+    QHash<const void*, Handle_AIS_ConnectedInteractive> mInstances;
+    QHash<const void*, Placement> mPlacements;
+};
+
+#endif // INSTANCELIBRARY_H
@@ -1,11 +1,174 @@
 #include "mainwindow.h"
+#include "batchrunner.h"
+#include "toolkitplugins.h"
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QThreadPool>
+#include <QTimer>
+
+#include <cstdio>
+
+//! run a job file without creating any window or display connection, as occbatch does.
+static int runBatch(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+
+    QCommandLineParser aParser;
+    aParser.addHelpOption();
+
+    QCommandLineOption aBatchOption("batch", "Run the job file without GUI and print a timing summary.", "file");
+    QCommandLineOption aThreadsOption("threads", "Number of worker threads, all cores by default.", "count");
+    aParser.addOption(aBatchOption);
+    aParser.addOption(aThreadsOption);
+    aParser.process(a);
+
+    if (aParser.isSet(aThreadsOption))
+    {
+        QThreadPool::globalInstance()->setMaxThreadCount(qMax(1, aParser.value(aThreadsOption).toInt()));
+    }
+
+    BatchRunner aRunner;
+
+    if (!aRunner.load(aParser.value(aBatchOption)))
+    {
+        std::fprintf(stderr, "%s\n", aRunner.errorString().toLocal8Bit().constData());
+        return 2;
+    }
+
+    const int aFailures = aRunner.run();
+    std::fputs(aRunner.summary().toLocal8Bit().constData(), stdout);
+
+    return aFailures == 0 ? 0 : 1;
+}
 
 int main(int argc, char *argv[])
 {
+    // the startup benchmark counts from here.
+    QElapsedTimer aStartup;
+    aStartup.start();
+
+    // the batch mode must be detected before a QApplication opens the display.
+    for (int i = 1; i < argc; ++i)
+    {
+        if (QByteArray(argv[i]) == "--batch" || QByteArray(argv[i]).startsWith("--batch="))
+        {
+            return runBatch(argc, argv);
+        }
+    }
+
     QApplication a(argc, argv);
+
+    QCommandLineParser aParser;
+    aParser.addHelpOption();
+
+    QCommandLineOption aStressOption("stress", "Run the stress benchmark for the comma separated counts and quit.", "counts");
+    QCommandLineOption aSeedOption("seed", "Seed of the stress scene generator.", "seed", "42");
+    QCommandLineOption aStartupOption("startup-benchmark", "Print the time to the first frame and quit.");
+    QCommandLineOption aReplayOption("replay", "Replay an input trace on the view, print its timings and quit.", "file");
+    QCommandLineOption aReplayPaceOption("replay-pace", "Replay at the recorded pace instead of maximum speed.");
+    QCommandLineOption aReplaySceneOption("replay-scene", "Generate this many shapes of each kind before the replay.", "count");
+    aParser.addOption(aStressOption);
+    aParser.addOption(aSeedOption);
+    aParser.addOption(aStartupOption);
+    aParser.addOption(aReplayOption);
+    aParser.addOption(aReplayPaceOption);
+    aParser.addOption(aReplaySceneOption);
+    aParser.process(a);
+
+    // a bad count would silently run empty rows, it is rejected before the window opens.
+    QList<int> aStressCounts;
+
+    foreach (const QString& aCount, aParser.value(aStressOption).split(',', QString::SkipEmptyParts))
+    {
+        bool isNumber = false;
+        const int aValue = aCount.trimmed().toInt(&isNumber);
+
+        if (!isNumber || aValue <= 0)
+        {
+            std::fprintf(stderr, "Invalid --stress count '%s', expected positive integers separated by commas.\n\n%s",
+                         aCount.toLocal8Bit().constData(), aParser.helpText().toLocal8Bit().constData());
+            return 2;
+        }
+
+        aStressCounts.append(aValue);
+    }
+
+    if (aParser.isSet(aStressOption) && aStressCounts.isEmpty())
+    {
+        std::fprintf(stderr, "--stress needs at least one count.\n\n%s", aParser.helpText().toLocal8Bit().constData());
+        return 2;
+    }
+
+    const qint64 anApplicationTime = aStartup.elapsed();
+
     MainWindow w;
+
+    const qint64 aWindowTime = aStartup.elapsed();
+
     w.show();
 
+    const qint64 aShowTime = aStartup.elapsed();
+
+    if (aParser.isSet(aStartupOption))
+    {
+        QObject::connect(&w, &MainWindow::firstFrame, [&aStartup, anApplicationTime, aWindowTime, aShowTime]()
+        {
+            std::printf("application,window,show,first frame (ms)\n%lld,%lld,%lld,%lld\n",
+                        anApplicationTime, aWindowTime, aShowTime, aStartup.elapsed());
+            std::printf("exchange plugin loaded: %s\n", ToolkitPlugins::isExchangeLoaded() ? "yes" : "no");
+            std::fflush(stdout);
+            QApplication::quit();
+        });
+    }
+
+    if (aParser.isSet(aReplayOption))
+    {
+        const QString aTrace = aParser.value(aReplayOption);
+        const bool isRealTime = aParser.isSet(aReplayPaceOption);
+        const int aSceneCount = aParser.value(aReplaySceneOption).toInt();
+        const quint32 aSeed = aParser.value(aSeedOption).toUInt();
+
+        QObject::connect(&w, &MainWindow::replayFinished, [](const QString& theReport)
+        {
+            std::fputs(theReport.toLocal8Bit().constData(), stdout);
+            QApplication::quit();
+        });
+
+        // the trace is replayed on a real view, once it has been drawn.
+        QObject::connect(&w, &MainWindow::firstFrame, [&w, aTrace, isRealTime, aSceneCount, aSeed]()
+        {
+            QTimer::singleShot(0, &w, [&w, aTrace, isRealTime, aSceneCount, aSeed]()
+            {
+                // the same seed gives the same scene for every build compared.
+                if (aSceneCount > 0)
+                {
+                    w.runStressBenchmark(QList<int>() << aSceneCount, aSeed);
+                }
+
+                QString anError;
+
+                if (!w.startReplay(aTrace, isRealTime, anError))
+                {
+                    std::fprintf(stderr, "%s\n", anError.toLocal8Bit().constData());
+                    QApplication::exit(2);
+                }
+            });
+        });
+    }
+
+    if (aParser.isSet(aStressOption))
+    {
+        const quint32 aSeed = aParser.value(aSeedOption).toUInt();
+
+        // run once the window is mapped so the frame rate is measured on a real view.
+        QTimer::singleShot(0, &w, [&w, aStressCounts, aSeed]()
+        {
+            const QString aReport = w.runStressBenchmark(aStressCounts, aSeed);
+            std::fputs(aReport.toLocal8Bit().constData(), stdout);
+            QApplication::quit();
+        });
+    }
+
     return a.exec();
 }
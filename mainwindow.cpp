@@ -12,40 +12,90 @@
 
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
+#include <BRep_Builder.hxx>
+#include <TopoDS_Compound.hxx>
+#include <Precision.hxx>
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
-#include <BRepBuilderAPI_Transform.hxx>
 #include <BRepBuilderAPI_MakePolygon.hxx>
 
-#include <BRepPrimAPI_MakeBox.hxx>
-#include <BRepPrimAPI_MakeCone.hxx>
-#include <BRepPrimAPI_MakeSphere.hxx>
-#include <BRepPrimAPI_MakeCylinder.hxx>
-#include <BRepPrimAPI_MakeTorus.hxx>
-#include <BRepPrimAPI_MakePrism.hxx>
-#include <BRepPrimAPI_MakeRevol.hxx>
-#include <BRepFilletAPI_MakeFillet.hxx>
-#include <BRepFilletAPI_MakeFillet2d.hxx>
-#include <BRepFilletAPI_MakeChamfer.hxx>
-
-#include <BRepOffsetAPI_ThruSections.hxx>
-
-#include <BRepAlgoAPI_Cut.hxx>
-#include <BRepAlgoAPI_Fuse.hxx>
-#include <BRepAlgoAPI_Common.hxx>
-
 #include <Aspect_DisplayConnection.hxx>
 #include <OpenGl_GraphicDriver.hxx>
 
+#include <QApplication>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QStatusBar>
+#include <QLabel>
+#include <QInputDialog>
+#include <QColorDialog>
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QSet>
+#include <QFile>
 #include <QDebug>
 
+#include <climits>
+
 #include <BRepBndLib.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
-#include <BRepTools_ReShape.hxx>
+#include <PrsMgr_Presentations.hxx>
+#include <PrsMgr_Presentation.hxx>
+#include <TColStd_ListIteratorOfListOfInteger.hxx>
+
+#include "gltfexporter.h"
+#include "drawingexporter.h"
+#include "interferencecheck.h"
+#include "propertiespanel.h"
+#include "shapehealer.h"
+#include "instancelibrary.h"
+#include "shapefactory.h"
+#include "scenegenerator.h"
+#include "analyticmesher.h"
+#include "topologyindex.h"
+#include "subshapeselection.h"
+#include "inputreplay.h"
+
+namespace
+{
+    //! resident set size in megabytes, -1 where /proc is not available.
+    double residentMemoryMB()
+    {
+        QFile aFile("/proc/self/status");
+
+        if (!aFile.open(QIODevice::ReadOnly | QIODevice::Text))
+        {
+            return -1.0;
+        }
 
-#define MAX2(X, Y)      (  Abs(X) > Abs(Y)? Abs(X) : Abs(Y) )
-#define MAX3(X, Y, Z)   ( MAX2 ( MAX2(X,Y) , Z) )
+        foreach (const QByteArray& aLine, aFile.readAll().split('\n'))
+        {
+            if (aLine.startsWith("VmRSS:"))
+            {
+                // "VmRSS:     123456 kB"
+                return aLine.mid(6).trimmed().split(' ').first().toDouble() / 1024.0;
+            }
+        }
+
+        return -1.0;
+    }
+
+    //! take an object out of a list, a null object leaves the list as it is.
+    void removeObject(AIS_ListOfInteractive& theList, const Handle_AIS_InteractiveObject& theObject)
+    {
+        for (AIS_ListIteratorOfListOfInteractive anIter(theList); anIter.More(); )
+        {
+            if (!theObject.IsNull() && anIter.Value() == theObject)
+            {
+                theList.Remove(anIter);
+            }
+            else
+            {
+                anIter.Next();
+            }
+        }
+    }
+}
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -56,7 +106,27 @@ MainWindow::MainWindow(QWidget *parent) :
     // occ modeler.
     InitializeModeler();
 
+    mInstances = new InstanceLibrary(mContext, mMeshCache);
+    mSelectionActivator = new SelectionActivator(mContext);
+
+    mStyles = new StylePalette(mContext);
+    mStyles->define("steel", Quantity_NOC_GRAY70, Graphic3d_NOM_STEEL);
+    mStyles->define("copper", Quantity_NOC_ORANGE3, Graphic3d_NOM_COPPER);
+    mStyles->define("warning", Quantity_NOC_RED, Graphic3d_NOM_PLASTIC);
+
+    mUndoStack = new QUndoStack(this);
+    mUndoStack->setUndoLimit(1000);
+
     occView = new OccView(mContext, this);
+    occView->setSelectionActivator(mSelectionActivator);
+    connect(occView, SIGNAL(selectionChanged()), this, SLOT(reportSelection()));
+    connect(occView, SIGNAL(culled(int,int,int)), this, SLOT(reportCulling(int,int,int)));
+    connect(occView, SIGNAL(firstFrame()), this, SIGNAL(firstFrame()));
+
+    mSections = new SectionPlanes(mContext);
+    occView->setSectionPlanes(mSections);
+    connect(occView, SIGNAL(sectionMoved()), this, SLOT(updateSections()));
+    connect(mUndoStack, SIGNAL(indexChanged(int)), this, SLOT(sceneChanged()));
     this->setCentralWidget(occView);
 
     this->resize(this->width()+15, this->height()+15);
@@ -64,13 +134,30 @@ MainWindow::MainWindow(QWidget *parent) :
     this->createMenus();
     this->createToolBars();
 
-    //Single shot to force timer redraw the mainwindow and uptdate occView to resize
-    //FIXME:This is a bug to fix
-    QTimer::singleShot(100, this, SLOT(timerRedraw()));
+    mPropertiesId = UINT_MAX;
+    mPropertiesPanel = new PropertiesPanel(mMassProperties, this);
+
+    QDockWidget* aPropertiesDock = new QDockWidget(tr("Properties"), this);
+    aPropertiesDock->setObjectName("PropertiesDock");
+    aPropertiesDock->setWidget(mPropertiesPanel);
+    addDockWidget(Qt::RightDockWidgetArea, aPropertiesDock);
+    mViewMenu->addSeparator();
+    mViewMenu->addAction(aPropertiesDock->toggleViewAction());
+
+    mCullingLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(mCullingLabel);
+
+    mShowReplayReport = false;
+    mInputReplay = new InputReplay(occView, this);
+    connect(mInputReplay, SIGNAL(finished()), this, SLOT(reportReplay()));
 }
 
 MainWindow::~MainWindow()
 {
+    delete mInstances;
+    delete mSelectionActivator;
+    delete mStyles;
+    delete mSections;
     delete ui;
 }
 
@@ -109,6 +196,14 @@ void MainWindow::createActions()
     mExitAction->setStatusTip(tr("Exit the application"));
     connect(mExitAction, SIGNAL(triggered()), this, SLOT(close()));
 
+    mExportGlbAction = new QAction(tr("Export GLB..."), this);
+    mExportGlbAction->setStatusTip(tr("Export the displayed shapes to glTF binary"));
+    connect(mExportGlbAction, SIGNAL(triggered()), this, SLOT(exportGlb()));
+
+    mExportDrawingAction = new QAction(tr("Export drawing..."), this);
+    mExportDrawingAction->setStatusTip(tr("Export front, top, side and iso hidden line views of the selected or displayed shapes"));
+    connect(mExportDrawingAction, SIGNAL(triggered()), this, SLOT(exportDrawing()));
+
     mViewZoomAction = new QAction(tr("Zoom"), this);
     mViewZoomAction->setIcon(QIcon(":/Resources/Zoom.png"));
     mViewZoomAction->setStatusTip(tr("Zoom the view"));
@@ -212,8 +307,21 @@ void MainWindow::createActions()
 void MainWindow::createMenus()
 {
     mFileMenu = menuBar()->addMenu(tr("&File"));
+    mFileMenu->addAction(mExportGlbAction);
+    mFileMenu->addAction(mExportDrawingAction);
+    mFileMenu->addSeparator();
     mFileMenu->addAction(mExitAction);
 
+    mEditMenu = menuBar()->addMenu(tr("&Edit"));
+
+    QAction* anUndoAction = mUndoStack->createUndoAction(this, tr("&Undo"));
+    anUndoAction->setShortcut(QKeySequence::Undo);
+    mEditMenu->addAction(anUndoAction);
+
+    QAction* aRedoAction = mUndoStack->createRedoAction(this, tr("&Redo"));
+    aRedoAction->setShortcut(QKeySequence::Redo);
+    mEditMenu->addAction(aRedoAction);
+
     mViewMenu = menuBar()->addMenu(tr("&View"));
     mViewMenu->addAction(mViewZoomAction);
     mViewMenu->addAction(mViewPanAction);
@@ -221,6 +329,22 @@ void MainWindow::createMenus()
     mViewMenu->addSeparator();
     mViewMenu->addAction(mViewResetAction);
     mViewMenu->addAction(mViewFitallAction);
+    mViewMenu->addSeparator();
+
+    QAction* aSectionAction = new QAction(tr("Add section plane..."), this);
+    aSectionAction->setStatusTip(tr("Cut the scene with a plane through its middle"));
+    connect(aSectionAction, SIGNAL(triggered()), this, SLOT(addSectionPlane()));
+    mViewMenu->addAction(aSectionAction);
+
+    aSectionAction = new QAction(tr("Move section plane"), this);
+    aSectionAction->setStatusTip(tr("Drag with the middle button to move the last section plane"));
+    connect(aSectionAction, SIGNAL(triggered()), occView, SLOT(moveSection()));
+    mViewMenu->addAction(aSectionAction);
+
+    aSectionAction = new QAction(tr("Remove section planes"), this);
+    aSectionAction->setStatusTip(tr("Remove all the section planes"));
+    connect(aSectionAction, SIGNAL(triggered()), this, SLOT(removeSectionPlanes()));
+    mViewMenu->addAction(aSectionAction);
 
     mPrimitiveMenu = menuBar()->addMenu(tr("&Primitive"));
     mPrimitiveMenu->addAction(mMakeBoxAction);
@@ -272,6 +396,78 @@ void MainWindow::createMenus()
 
     mExtrasMenu->addAction(action);
 
+    action = new QAction(tr("Check interference"), this);
+    action->setStatusTip(tr("Find the shapes that clash with each other and select them"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(checkInterference()));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Check clearance..."), this);
+    action->setStatusTip(tr("Measure the distances of the selected shapes to their neighbours"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(checkClearance()));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Check && heal"), this);
+    action->setStatusTip(tr("Check the validity of the selected or displayed shapes and fix the invalid ones"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(checkAndHeal()));
+
+    mExtrasMenu->addAction(action);
+
+    mRecordInputAction = new QAction(tr("Record input"), this);
+    mRecordInputAction->setCheckable(true);
+    mRecordInputAction->setStatusTip(tr("Record the mouse and wheel events of the view to a trace file"));
+    connect(mRecordInputAction, SIGNAL(toggled(bool)), this, SLOT(recordInput(bool)));
+
+    mExtrasMenu->addAction(mRecordInputAction);
+
+    action = new QAction(tr("Replay input..."), this);
+    action->setStatusTip(tr("Replay a recorded trace on the view and measure the frame and detection times"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(replayInput()));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Stress benchmark..."), this);
+    action->setStatusTip(tr("Fill the scene with generated shapes and measure build, mesh, display and frame times"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(stressBenchmark()));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Lazy selection"), this);
+    action->setStatusTip(tr("Build the selection data of a shape when it is first picked instead of at display"));
+    action->setCheckable(true);
+    action->setChecked(mSelectionActivator->isLazy());
+    connect(action, SIGNAL(toggled(bool)), this, SLOT(setLazySelection(bool)));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Apply style..."), this);
+    action->setStatusTip(tr("Make the selected shapes, or all shapes, use a shared style"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(applyStyle()));
+
+    mExtrasMenu->addAction(action);
+
+    action = new QAction(tr("Edit style..."), this);
+    action->setStatusTip(tr("Change the color of a shared style and of every shape using it"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(editStyle()));
+
+    mExtrasMenu->addAction(action);
+
+    mBatchAction = new QAction(tr("Static batching"), this);
+    mBatchAction->setStatusTip(tr("Draw the unselected shapes from a few merged arrays, one per color"));
+    mBatchAction->setCheckable(true);
+    connect(mBatchAction, SIGNAL(toggled(bool)), this, SLOT(setStaticBatching(bool)));
+
+    mExtrasMenu->addAction(mBatchAction);
+
+    action = new QAction(tr("View culling"), this);
+    action->setStatusTip(tr("Skip the shapes outside the view or smaller than a pixel when drawing"));
+    action->setCheckable(true);
+    action->setChecked(occView->culler().isEnabled());
+    connect(action, SIGNAL(toggled(bool)), this, SLOT(setViewCulling(bool)));
+
+    mExtrasMenu->addAction(action);
+
     //Create delete menu
     mDeleteMenu = menuBar()->addMenu("&Delete");
 
@@ -321,6 +517,12 @@ void MainWindow::createMenus()
 
     mModifyMenu->addAction(action);
 
+    action = new QAction(tr("Edit feature box height..."), this);
+    action->setStatusTip(tr("Change the box under the fillet and the chamfer and recompute what depends on it"));
+    connect(action, SIGNAL(triggered(bool)), this, SLOT(editFeatureBox()));
+
+    mModifyMenu->addAction(action);
+
 }
 
 void MainWindow::createToolBars()
@@ -365,16 +567,125 @@ void MainWindow::about()
                           "<p>occQt is a demo applicaton about Qt and OpenCASCADE."));
 }
 
+void MainWindow::exportGlb()
+{
+    QString aFileName = QFileDialog::getSaveFileName(this, tr("Export GLB"), QString(), tr("glTF binary (*.glb)"));
+
+    if (aFileName.isEmpty())
+    {
+        return;
+    }
+
+    GltfExporter anExporter;
+
+    AIS_ListOfInteractive aDisplayedList;
+    mContext->DisplayedObjects(aDisplayedList);
+
+    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
+    for (; anIter.More(); anIter.Next())
+    {
+        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
+        TopoDS_Shape aTopoShape;
+        QString aName;
+
+        if (!aShape.IsNull())
+        {
+            aTopoShape = aShape->Shape();
+
+            unsigned int anId = mapIntShapes.key(aShape, UINT_MAX);
+
+            if (anId != UINT_MAX)
+            {
+                aName = QString("shape_%1").arg(anId);
+            }
+        }
+        else
+        {
+            // instances export the prototype TShape with their own placement.
+            Handle(AIS_ConnectedInteractive) anInstance = Handle(AIS_ConnectedInteractive)::DownCast (anIter.Value());
+            aTopoShape = mInstances->placedShape(anInstance);
+
+            if (aTopoShape.IsNull())
+            {
+                continue;
+            }
+
+            aShape = Handle(AIS_Shape)::DownCast (anInstance->ConnectedTo());
+
+            unsigned int anId = mapIntInstances.key(anInstance, UINT_MAX);
+
+            if (anId != UINT_MAX)
+            {
+                aName = QString("instance_%1").arg(anId);
+            }
+        }
+
+        // a palette style leaves HasColor() as it was, the palette knows the drawn color.
+        const Quantity_Color aColor = aShape.IsNull() ? Quantity_Color(Quantity_NOC_GOLDENROD) : mStyles->colorOf(aShape);
+
+        anExporter.add(aTopoShape, aColor, aName);
+    }
+
+    if (!anExporter.write(aFileName))
+    {
+        QMessageBox::warning(this, tr("Export GLB"), anExporter.errorString());
+        return;
+    }
+
+    statusBar()->showMessage(tr("Exported %1 nodes sharing %2 meshes")
+                             .arg(anExporter.nodeCount())
+                             .arg(anExporter.geometryCount()));
+}
+
+void MainWindow::exportDrawing()
+{
+    QString aFileName = QFileDialog::getSaveFileName(this, tr("Export drawing"), QString(),
+                                                     tr("SVG drawing (*.svg);;DXF drawing (*.dxf)"));
+
+    if (aFileName.isEmpty())
+    {
+        return;
+    }
+
+    AIS_ListOfInteractive anObjects;
+
+    for (mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        anObjects.Append(mContext->Current());
+    }
+
+    if (anObjects.IsEmpty())
+    {
+        mContext->DisplayedObjects(anObjects);
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    DrawingExporter anExporter;
+
+    foreach (const TopoDS_Shape& aShape, shapesOf(anObjects))
+    {
+        anExporter.add(aShape);
+    }
+
+    if (!anExporter.compute() || !anExporter.write(aFileName))
+    {
+        QMessageBox::warning(this, tr("Export drawing"), anExporter.errorString());
+        return;
+    }
+
+    statusBar()->showMessage(tr("Exported %1 polylines in %2 ms").arg(anExporter.polylineCount()).arg(aTimer.elapsed()));
+}
+
 void MainWindow::makeBox()
 {
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(3.0, 4.0, 5.0).Shape();
+    TopoDS_Shape aTopoBox = ShapeFactory::makeBox(gp_Ax2(), 3.0, 4.0, 5.0);
     Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
 
     anAisBox->SetColor(Quantity_NOC_AZURE);
 
-    mContext->Display(anAisBox);
-
-    mapIntShapes.insert(0, anAisBox);
+    displayShape(0, anAisBox);
 }
 
 void MainWindow::makeCone()
@@ -382,22 +693,19 @@ void MainWindow::makeCone()
     gp_Ax2 anAxis;
     anAxis.SetLocation(gp_Pnt(0.0, 10.0, 0.0));
 
-    TopoDS_Shape aTopoReducer = BRepPrimAPI_MakeCone(anAxis, 3.0, 1.5, 5.0).Shape();
+    TopoDS_Shape aTopoReducer = ShapeFactory::makeCone(anAxis, 3.0, 1.5, 5.0);
     Handle_AIS_Shape anAisReducer = new AIS_Shape(aTopoReducer);
 
     anAisReducer->SetColor(Quantity_NOC_BISQUE);
 
     anAxis.SetLocation(gp_Pnt(8.0, 10.0, 0.0));
-    TopoDS_Shape aTopoCone = BRepPrimAPI_MakeCone(anAxis, 3.0, 0.0, 5.0).Shape();
+    TopoDS_Shape aTopoCone = ShapeFactory::makeCone(anAxis, 3.0, 0.0, 5.0);
     Handle_AIS_Shape anAisCone = new AIS_Shape(aTopoCone);
 
     anAisCone->SetColor(Quantity_NOC_CHOCOLATE);
 
-    mContext->Display(anAisReducer);
-    mContext->Display(anAisCone);
-
-    mapIntShapes.insert(1, anAisReducer);
-    mapIntShapes.insert(2, anAisCone);
+    displayShape(1, anAisReducer);
+    displayShape(2, anAisCone);
 }
 
 void MainWindow::makeSphere()
@@ -405,14 +713,12 @@ void MainWindow::makeSphere()
     gp_Ax2 anAxis;
     anAxis.SetLocation(gp_Pnt(0.0, 20.0, 0.0));
 
-    TopoDS_Shape aTopoSphere = BRepPrimAPI_MakeSphere(anAxis, 3.0).Shape();
+    TopoDS_Shape aTopoSphere = ShapeFactory::makeSphere(anAxis, 3.0);
     Handle_AIS_Shape anAisSphere = new AIS_Shape(aTopoSphere);
 
     anAisSphere->SetColor(Quantity_NOC_BLUE1);
 
-    mContext->Display(anAisSphere);
-
-    mapIntShapes.insert(3, anAisSphere);
+    displayShape(3, anAisSphere);
 
 }
 
@@ -421,22 +727,19 @@ void MainWindow::makeCylinder()
     gp_Ax2 anAxis;
     anAxis.SetLocation(gp_Pnt(0.0, 30.0, 0.0));
 
-    TopoDS_Shape aTopoCylinder = BRepPrimAPI_MakeCylinder(anAxis, 3.0, 5.0).Shape();
+    TopoDS_Shape aTopoCylinder = ShapeFactory::makeCylinder(anAxis, 3.0, 5.0);
     Handle_AIS_Shape anAisCylinder = new AIS_Shape(aTopoCylinder);
 
     anAisCylinder->SetColor(Quantity_NOC_RED);
 
     anAxis.SetLocation(gp_Pnt(8.0, 30.0, 0.0));
-    TopoDS_Shape aTopoPie = BRepPrimAPI_MakeCylinder(anAxis, 3.0, 5.0, M_PI_2 * 3.0).Shape();
+    TopoDS_Shape aTopoPie = ShapeFactory::makeCylinder(anAxis, 3.0, 5.0, M_PI_2 * 3.0);
     Handle_AIS_Shape anAisPie = new AIS_Shape(aTopoPie);
 
     anAisPie->SetColor(Quantity_NOC_TAN);
 
-    mContext->Display(anAisCylinder);
-    mContext->Display(anAisPie);
-
-    mapIntShapes.insert(4, anAisCylinder);
-    mapIntShapes.insert(5, anAisPie);
+    displayShape(4, anAisCylinder);
+    displayShape(5, anAisPie);
 }
 
 void MainWindow::makeTorus()
@@ -444,84 +747,84 @@ void MainWindow::makeTorus()
     gp_Ax2 anAxis;
     anAxis.SetLocation(gp_Pnt(0.0, 40.0, 0.0));
 
-    TopoDS_Shape aTopoTorus = BRepPrimAPI_MakeTorus(anAxis, 3.0, 1.0).Shape();
+    TopoDS_Shape aTopoTorus = ShapeFactory::makeTorus(anAxis, 3.0, 1.0);
     Handle_AIS_Shape anAisTorus = new AIS_Shape(aTopoTorus);
 
     anAisTorus->SetColor(Quantity_NOC_YELLOW);
 
     anAxis.SetLocation(gp_Pnt(8.0, 40.0, 0.0));
-    TopoDS_Shape aTopoElbow = BRepPrimAPI_MakeTorus(anAxis, 3.0, 1.0, M_PI_2).Shape();
+    TopoDS_Shape aTopoElbow = ShapeFactory::makeTorus(anAxis, 3.0, 1.0, M_PI_2);
     Handle_AIS_Shape anAisElbow = new AIS_Shape(aTopoElbow);
 
     anAisElbow->SetColor(Quantity_NOC_THISTLE);
 
-    mContext->Display(anAisTorus);
-    mContext->Display(anAisElbow);
-
-    mapIntShapes.insert(6, anAisTorus);
-    mapIntShapes.insert(7, anAisElbow);
+    displayShape(6, anAisTorus);
+    displayShape(7, anAisElbow);
 }
 
 void MainWindow::makeFillet()
 {
-    gp_Ax2 anAxis;
-    anAxis.SetLocation(gp_Pnt(0.0, 50.0, 0.0));
+    // a repeated fillet shows the feature made before instead of adding nodes.
+    FeatureGraph::NodeId aFillet = mapIntFeatures.value(8, -1);
+
+    if (aFillet < 0)
+    {
+        FeatureGraph::NodeId aBox = mFeatures.addNode(FeatureGraph::Box, QVector<double>() << 0.0 << 50.0 << 0.0 << 3.0 << 4.0 << 5.0);
+        aFillet = mFeatures.addNode(FeatureGraph::Fillet, QVector<double>() << 1.0, QList<FeatureGraph::NodeId>() << aBox);
+    }
 
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(anAxis, 3.0, 4.0, 5.0).Shape();
-    BRepFilletAPI_MakeFillet MF(aTopoBox);
+    mFeatures.recompute();
 
-    // Add all the edges to fillet.
-    for (TopExp_Explorer ex(aTopoBox, TopAbs_EDGE); ex.More(); ex.Next())
+    if (mFeatures.shape(aFillet).IsNull())
     {
-        MF.Add(1.0, TopoDS::Edge(ex.Current()));
+        statusBar()->showMessage(mFeatures.error(aFillet));
+        return;
     }
 
-    Handle_AIS_Shape anAisShape = new AIS_Shape(MF.Shape());
+    Handle_AIS_Shape anAisShape = new AIS_Shape(mFeatures.shape(aFillet));
     anAisShape->SetColor(Quantity_NOC_VIOLET);
 
-    mContext->Display(anAisShape);
-
-    mapIntShapes.insert(8, anAisShape);
+    mapIntFeatures.insert(8, aFillet);
+    displayShape(8, anAisShape);
 
 }
 
 void MainWindow::makeChamfer()
 {
-    gp_Ax2 anAxis;
-    anAxis.SetLocation(gp_Pnt(8.0, 50.0, 0.0));
+    // a repeated chamfer shows the feature made before instead of adding nodes.
+    FeatureGraph::NodeId aChamfer = mapIntFeatures.value(9, -1);
 
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(anAxis, 3.0, 4.0, 5.0).Shape();
-    BRepFilletAPI_MakeChamfer MC(aTopoBox);
-    TopTools_IndexedDataMapOfShapeListOfShape aEdgeFaceMap;
+    if (aChamfer < 0)
+    {
+        FeatureGraph::NodeId aBox = mFeatures.addNode(FeatureGraph::Box, QVector<double>() << 8.0 << 50.0 << 0.0 << 3.0 << 4.0 << 5.0);
+        aChamfer = mFeatures.addNode(FeatureGraph::Chamfer, QVector<double>() << 0.6, QList<FeatureGraph::NodeId>() << aBox);
+    }
 
-    TopExp::MapShapesAndAncestors(aTopoBox, TopAbs_EDGE, TopAbs_FACE, aEdgeFaceMap);
+    mFeatures.recompute();
 
-    for (Standard_Integer i = 1; i <= aEdgeFaceMap.Extent(); ++i)
+    if (mFeatures.shape(aChamfer).IsNull())
     {
-        TopoDS_Edge anEdge = TopoDS::Edge(aEdgeFaceMap.FindKey(i));
-        TopoDS_Face aFace = TopoDS::Face(aEdgeFaceMap.FindFromIndex(i).First());
-
-        MC.Add(0.6, 0.6, anEdge, aFace);
+        statusBar()->showMessage(mFeatures.error(aChamfer));
+        return;
     }
 
-    Handle_AIS_Shape anAisShape = new AIS_Shape(MC.Shape());
+    Handle_AIS_Shape anAisShape = new AIS_Shape(mFeatures.shape(aChamfer));
     anAisShape->SetColor(Quantity_NOC_TOMATO);
 
-    mContext->Display(anAisShape);
-
-    mapIntShapes.insert(9, anAisShape);
+    mapIntFeatures.insert(9, aChamfer);
+    displayShape(9, anAisShape);
 }
 
 void MainWindow::makeExtrude()
 {
     // prism a vertex result is an edge.
     TopoDS_Vertex aVertex = BRepBuilderAPI_MakeVertex(gp_Pnt(0.0, 60.0, 0.0));
-    TopoDS_Shape aPrismVertex = BRepPrimAPI_MakePrism(aVertex, gp_Vec(0.0, 0.0, 5.0));
+    TopoDS_Shape aPrismVertex = ShapeFactory::prism(aVertex, gp_Vec(0.0, 0.0, 5.0));
     Handle_AIS_Shape anAisPrismVertex = new AIS_Shape(aPrismVertex);
 
     // prism an edge result is a face.
     TopoDS_Edge anEdge = BRepBuilderAPI_MakeEdge(gp_Pnt(5.0, 60.0, 0.0), gp_Pnt(10.0, 60.0, 0.0));
-    TopoDS_Shape aPrismEdge = BRepPrimAPI_MakePrism(anEdge, gp_Vec(0.0, 0.0, 5.0));
+    TopoDS_Shape aPrismEdge = ShapeFactory::prism(anEdge, gp_Vec(0.0, 0.0, 5.0));
     Handle_AIS_Shape anAisPrismEdge = new AIS_Shape(aPrismEdge);
 
     // prism a wire result is a shell.
@@ -530,7 +833,7 @@ void MainWindow::makeExtrude()
 
     TopoDS_Edge aCircleEdge = BRepBuilderAPI_MakeEdge(gp_Circ(anAxis, 3.0));
     TopoDS_Wire aCircleWire = BRepBuilderAPI_MakeWire(aCircleEdge);
-    TopoDS_Shape aPrismCircle = BRepPrimAPI_MakePrism(aCircleWire, gp_Vec(0.0, 0.0, 5.0));
+    TopoDS_Shape aPrismCircle = ShapeFactory::prism(aCircleWire, gp_Vec(0.0, 0.0, 5.0));
     Handle_AIS_Shape anAisPrismCircle = new AIS_Shape(aPrismCircle);
 
     // prism a face or a shell result is a solid.
@@ -538,7 +841,7 @@ void MainWindow::makeExtrude()
     TopoDS_Edge aEllipseEdge = BRepBuilderAPI_MakeEdge(gp_Elips(anAxis, 3.0, 2.0));
     TopoDS_Wire aEllipseWire = BRepBuilderAPI_MakeWire(aEllipseEdge);
     TopoDS_Face aEllipseFace = BRepBuilderAPI_MakeFace(gp_Pln(gp::XOY()), aEllipseWire);
-    TopoDS_Shape aPrismEllipse = BRepPrimAPI_MakePrism(aEllipseFace, gp_Vec(0.0, 0.0, 5.0));
+    TopoDS_Shape aPrismEllipse = ShapeFactory::prism(aEllipseFace, gp_Vec(0.0, 0.0, 5.0));
     Handle_AIS_Shape anAisPrismEllipse = new AIS_Shape(aPrismEllipse);
 
     anAisPrismVertex->SetColor(Quantity_NOC_PAPAYAWHIP);
@@ -546,15 +849,10 @@ void MainWindow::makeExtrude()
     anAisPrismCircle->SetColor(Quantity_NOC_PERU);
     anAisPrismEllipse->SetColor(Quantity_NOC_PINK);
 
-    mContext->Display(anAisPrismVertex);
-    mContext->Display(anAisPrismEdge);
-    mContext->Display(anAisPrismCircle);
-    mContext->Display(anAisPrismEllipse);
-
-    mapIntShapes.insert(10, anAisPrismVertex);
-    mapIntShapes.insert(11, anAisPrismEdge);
-    mapIntShapes.insert(12, anAisPrismCircle);
-    mapIntShapes.insert(13, anAisPrismEllipse);
+    displayShape(10, anAisPrismVertex);
+    displayShape(11, anAisPrismEdge);
+    displayShape(12, anAisPrismCircle);
+    displayShape(13, anAisPrismEllipse);
 }
 
 void MainWindow::makeRevol()
@@ -564,13 +862,13 @@ void MainWindow::makeRevol()
     // revol a vertex result is an edge.
     anAxis.SetLocation(gp_Pnt(0.0, 70.0, 0.0));
     TopoDS_Vertex aVertex = BRepBuilderAPI_MakeVertex(gp_Pnt(2.0, 70.0, 0.0));
-    TopoDS_Shape aRevolVertex = BRepPrimAPI_MakeRevol(aVertex, anAxis);
+    TopoDS_Shape aRevolVertex = ShapeFactory::revolved(aVertex, anAxis);
     Handle_AIS_Shape anAisRevolVertex = new AIS_Shape(aRevolVertex);
 
     // revol an edge result is a face.
     anAxis.SetLocation(gp_Pnt(8.0, 70.0, 0.0));
     TopoDS_Edge anEdge = BRepBuilderAPI_MakeEdge(gp_Pnt(6.0, 70.0, 0.0), gp_Pnt(6.0, 70.0, 5.0));
-    TopoDS_Shape aRevolEdge = BRepPrimAPI_MakeRevol(anEdge, anAxis);
+    TopoDS_Shape aRevolEdge = ShapeFactory::revolved(anEdge, anAxis);
     Handle_AIS_Shape anAisRevolEdge = new AIS_Shape(aRevolEdge);
 
     // revol a wire result is a shell.
@@ -579,7 +877,7 @@ void MainWindow::makeRevol()
 
     TopoDS_Edge aCircleEdge = BRepBuilderAPI_MakeEdge(gp_Circ(gp_Ax2(gp_Pnt(15.0, 70.0, 0.0), gp::DZ()), 1.5));
     TopoDS_Wire aCircleWire = BRepBuilderAPI_MakeWire(aCircleEdge);
-    TopoDS_Shape aRevolCircle = BRepPrimAPI_MakeRevol(aCircleWire, anAxis, M_PI_2);
+    TopoDS_Shape aRevolCircle = ShapeFactory::revolved(aCircleWire, anAxis, M_PI_2);
     Handle_AIS_Shape anAisRevolCircle = new AIS_Shape(aRevolCircle);
 
     // revol a face result is a solid.
@@ -589,7 +887,7 @@ void MainWindow::makeRevol()
     TopoDS_Edge aEllipseEdge = BRepBuilderAPI_MakeEdge(gp_Elips(gp_Ax2(gp_Pnt(25.0, 70.0, 0.0), gp::DZ()), 3.0, 2.0));
     TopoDS_Wire aEllipseWire = BRepBuilderAPI_MakeWire(aEllipseEdge);
     TopoDS_Face aEllipseFace = BRepBuilderAPI_MakeFace(gp_Pln(gp::XOY()), aEllipseWire);
-    TopoDS_Shape aRevolEllipse = BRepPrimAPI_MakeRevol(aEllipseFace, anAxis, M_PI_4);
+    TopoDS_Shape aRevolEllipse = ShapeFactory::revolved(aEllipseFace, anAxis, M_PI_4);
     Handle_AIS_Shape anAisRevolEllipse = new AIS_Shape(aRevolEllipse);
 
     anAisRevolVertex->SetColor(Quantity_NOC_LIMEGREEN);
@@ -597,15 +895,10 @@ void MainWindow::makeRevol()
     anAisRevolCircle->SetColor(Quantity_NOC_MAGENTA1);
     anAisRevolEllipse->SetColor(Quantity_NOC_MAROON);
 
-    mContext->Display(anAisRevolVertex);
-    mContext->Display(anAisRevolEdge);
-    mContext->Display(anAisRevolCircle);
-    mContext->Display(anAisRevolEllipse);
-
-    mapIntShapes.insert(14, anAisRevolVertex);
-    mapIntShapes.insert(15, anAisRevolEdge);
-    mapIntShapes.insert(16, anAisRevolCircle);
-    mapIntShapes.insert(17, anAisRevolEllipse);
+    displayShape(14, anAisRevolVertex);
+    displayShape(15, anAisRevolEdge);
+    displayShape(16, anAisRevolCircle);
+    displayShape(17, anAisRevolEllipse);
 }
 
 void MainWindow::makeLoft()
@@ -622,280 +915,1310 @@ void MainWindow::makeLoft()
     aPolygon.Add(gp_Pnt(-3.0, 83.0, 6.0));
     aPolygon.Close();
 
-    BRepOffsetAPI_ThruSections aShellGenerator;
-    BRepOffsetAPI_ThruSections aSolidGenerator(true);
-
-    aShellGenerator.AddWire(aCircleWire);
-    aShellGenerator.AddWire(aPolygon.Wire());
-
-    aSolidGenerator.AddWire(aCircleWire);
-    aSolidGenerator.AddWire(aPolygon.Wire());
+    const QList<TopoDS_Wire> aSections = QList<TopoDS_Wire>() << aCircleWire << aPolygon.Wire();
 
     // translate the solid.
-    gp_Trsf aTrsf;
-    aTrsf.SetTranslation(gp_Vec(18.0, 0.0, 0.0));
-    BRepBuilderAPI_Transform aTransform(aSolidGenerator.Shape(), aTrsf);
+    TopoDS_Shape aShell = ShapeFactory::loft(aSections, false);
+    TopoDS_Shape aSolid = ShapeFactory::translated(ShapeFactory::loft(aSections, true), gp_Vec(18.0, 0.0, 0.0));
 
-    Handle_AIS_Shape anAisShell = new AIS_Shape(aShellGenerator.Shape());
-    Handle_AIS_Shape anAisSolid = new AIS_Shape(aTransform.Shape());
+    Handle_AIS_Shape anAisShell = new AIS_Shape(aShell);
+    Handle_AIS_Shape anAisSolid = new AIS_Shape(aSolid);
 
     anAisShell->SetColor(Quantity_NOC_OLIVEDRAB);
     anAisSolid->SetColor(Quantity_NOC_PEACHPUFF);
 
-    mContext->Display(anAisShell);
-    mContext->Display(anAisSolid);
-
-    mapIntShapes.insert(18, anAisShell);
-    mapIntShapes.insert(19, anAisSolid);
+    displayShape(18, anAisShell);
+    displayShape(19, anAisSolid);
 }
 
 void MainWindow::testCut()
 {
-    gp_Ax2 anAxis;
-    anAxis.SetLocation(gp_Pnt(0.0, 90.0, 0.0));
+    // the operands are shared prototypes placed by a translation.
+    addOperandPrototypes();
 
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(anAxis, 3.0, 4.0, 5.0).Shape();
-    TopoDS_Shape aTopoSphere = BRepPrimAPI_MakeSphere(anAxis, 2.5).Shape();
-    TopoDS_Shape aCuttedShape1 = BRepAlgoAPI_Cut(aTopoBox, aTopoSphere);
-    TopoDS_Shape aCuttedShape2 = BRepAlgoAPI_Cut(aTopoSphere, aTopoBox);
+    gp_Trsf aPlacement;
+    aPlacement.SetTranslation(gp_Vec(0.0, 90.0, 0.0));
 
-    gp_Trsf aTrsf;
-    aTrsf.SetTranslation(gp_Vec(8.0, 0.0, 0.0));
-    BRepBuilderAPI_Transform aTransform1(aCuttedShape1, aTrsf);
+    TopoDS_Shape aTopoBox = mInstances->placedShape("operand box", aPlacement);
+    TopoDS_Shape aTopoSphere = mInstances->placedShape("operand sphere", aPlacement);
+    TopoDS_Shape aCuttedShape1 = ShapeFactory::cut(aTopoBox, aTopoSphere);
+    TopoDS_Shape aCuttedShape2 = ShapeFactory::cut(aTopoSphere, aTopoBox);
 
-    aTrsf.SetTranslation(gp_Vec(16.0, 0.0, 0.0));
-    BRepBuilderAPI_Transform aTransform2(aCuttedShape2, aTrsf);
+    Handle_AIS_Shape anAisCuttedShape1 = new AIS_Shape(ShapeFactory::translated(aCuttedShape1, gp_Vec(8.0, 0.0, 0.0)));
+    Handle_AIS_Shape anAisCuttedShape2 = new AIS_Shape(ShapeFactory::translated(aCuttedShape2, gp_Vec(16.0, 0.0, 0.0)));
 
-    Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
-    Handle_AIS_Shape anAisSphere = new AIS_Shape(aTopoSphere);
-    Handle_AIS_Shape anAisCuttedShape1 = new AIS_Shape(aTransform1.Shape());
-    Handle_AIS_Shape anAisCuttedShape2 = new AIS_Shape(aTransform2.Shape());
-
-    anAisBox->SetColor(Quantity_NOC_SPRINGGREEN);
-    anAisSphere->SetColor(Quantity_NOC_STEELBLUE);
     anAisCuttedShape1->SetColor(Quantity_NOC_TAN);
     anAisCuttedShape2->SetColor(Quantity_NOC_SALMON);
 
-    mContext->Display(anAisBox);
-    mContext->Display(anAisSphere);
-    mContext->Display(anAisCuttedShape1);
-    mContext->Display(anAisCuttedShape2);
-
-    mapIntShapes.insert(20, anAisBox);
-    mapIntShapes.insert(21, anAisSphere);
-    mapIntShapes.insert(22, anAisCuttedShape1);
-    mapIntShapes.insert(23, anAisCuttedShape2);
+    displayInstance(20, "operand box", aPlacement);
+    displayInstance(21, "operand sphere", aPlacement);
+    displayShape(22, anAisCuttedShape1);
+    displayShape(23, anAisCuttedShape2);
 }
 
 void MainWindow::testFuse()
 {
-    gp_Ax2 anAxis;
-    anAxis.SetLocation(gp_Pnt(0.0, 100.0, 0.0));
+    // the operands are shared prototypes placed by a translation.
+    addOperandPrototypes();
 
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(anAxis, 3.0, 4.0, 5.0).Shape();
-    TopoDS_Shape aTopoSphere = BRepPrimAPI_MakeSphere(anAxis, 2.5).Shape();
-    TopoDS_Shape aFusedShape = BRepAlgoAPI_Fuse(aTopoBox, aTopoSphere);
+    gp_Trsf aPlacement;
+    aPlacement.SetTranslation(gp_Vec(0.0, 100.0, 0.0));
 
-    gp_Trsf aTrsf;
-    aTrsf.SetTranslation(gp_Vec(8.0, 0.0, 0.0));
-    BRepBuilderAPI_Transform aTransform(aFusedShape, aTrsf);
+    TopoDS_Shape aTopoBox = mInstances->placedShape("operand box", aPlacement);
+    TopoDS_Shape aTopoSphere = mInstances->placedShape("operand sphere", aPlacement);
+    TopoDS_Shape aFusedShape = ShapeFactory::fuse(aTopoBox, aTopoSphere);
 
-    Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
-    Handle_AIS_Shape anAisSphere = new AIS_Shape(aTopoSphere);
-    Handle_AIS_Shape anAisFusedShape = new AIS_Shape(aTransform.Shape());
+    Handle_AIS_Shape anAisFusedShape = new AIS_Shape(ShapeFactory::translated(aFusedShape, gp_Vec(8.0, 0.0, 0.0)));
 
-    anAisBox->SetColor(Quantity_NOC_SPRINGGREEN);
-    anAisSphere->SetColor(Quantity_NOC_STEELBLUE);
     anAisFusedShape->SetColor(Quantity_NOC_ROSYBROWN);
 
-    mContext->Display(anAisBox);
-    mContext->Display(anAisSphere);
-    mContext->Display(anAisFusedShape);
-
-    mapIntShapes.insert(24, anAisBox);
-    mapIntShapes.insert(25, anAisSphere);
-    mapIntShapes.insert(26, anAisFusedShape);
+    displayInstance(24, "operand box", aPlacement);
+    displayInstance(25, "operand sphere", aPlacement);
+    displayShape(26, anAisFusedShape);
 
 }
 
 void MainWindow::testCommon()
 {
-    gp_Ax2 anAxis;
-    anAxis.SetLocation(gp_Pnt(0.0, 110.0, 0.0));
+    // the operands are shared prototypes placed by a translation.
+    addOperandPrototypes();
 
-    TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(anAxis, 3.0, 4.0, 5.0).Shape();
-    TopoDS_Shape aTopoSphere = BRepPrimAPI_MakeSphere(anAxis, 2.5).Shape();
-    TopoDS_Shape aCommonShape = BRepAlgoAPI_Common(aTopoBox, aTopoSphere);
+    gp_Trsf aPlacement;
+    aPlacement.SetTranslation(gp_Vec(0.0, 110.0, 0.0));
 
-    gp_Trsf aTrsf;
-    aTrsf.SetTranslation(gp_Vec(8.0, 0.0, 0.0));
-    BRepBuilderAPI_Transform aTransform(aCommonShape, aTrsf);
+    TopoDS_Shape aTopoBox = mInstances->placedShape("operand box", aPlacement);
+    TopoDS_Shape aTopoSphere = mInstances->placedShape("operand sphere", aPlacement);
+    TopoDS_Shape aCommonShape = ShapeFactory::common(aTopoBox, aTopoSphere);
 
-    Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
-    Handle_AIS_Shape anAisSphere = new AIS_Shape(aTopoSphere);
-    Handle_AIS_Shape anAisCommonShape = new AIS_Shape(aTransform.Shape());
+    Handle_AIS_Shape anAisCommonShape = new AIS_Shape(ShapeFactory::translated(aCommonShape, gp_Vec(8.0, 0.0, 0.0)));
 
-    anAisBox->SetColor(Quantity_NOC_SPRINGGREEN);
-    anAisSphere->SetColor(Quantity_NOC_STEELBLUE);
     anAisCommonShape->SetColor(Quantity_NOC_ROYALBLUE);
 
-    mContext->Display(anAisBox);
-    mContext->Display(anAisSphere);
-    mContext->Display(anAisCommonShape);
-
-    mapIntShapes.insert(27, anAisBox);
-    mapIntShapes.insert(28, anAisSphere);
-    mapIntShapes.insert(29, anAisCommonShape);
+    displayInstance(27, "operand box", aPlacement);
+    displayInstance(28, "operand sphere", aPlacement);
+    displayShape(29, anAisCommonShape);
 }
 
-void MainWindow::timerRedraw()
+void MainWindow::displayShape(const unsigned int theId, const Handle_AIS_Shape& theShape)
 {
-    this->resize(this->width() * 2, this->height() * 2);
-}
+    // mesh with the deflection of the viewer so Display() finds the triangulation.
+    mMeshCache.mesh(theShape->Shape(), MeshCache::deflection(theShape->Shape()));
 
-void MainWindow::selectEdges()
-{
-    //    mContext->Select(this->x() - this->width(), this->y() - this->height(), this->width(), this->height(), occView->getMyView(), true);
+    mUndoStack->push(new DisplayShapeCommand(mContext, mapIntShapes, theId, theShape, mSelectionActivator));
 
-    mContext->CloseAllContexts();
-    mContext->OpenLocalContext();
-    mContext->ActivateStandardMode(TopAbs_FACE);
+    mContext->UpdateCurrentViewer();
+}
 
-    //Roman Lygin - start of the test
-    //select all edges of all displayed objects
-    AIS_ListOfInteractive aDisplayedList;
-    Standard_Boolean aNeutralPointOnly = Standard_True;
-    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+bool MainWindow::updateShape(const unsigned int theId, const TopoDS_Shape& theNewShape)
+{
+    Handle(AIS_Shape) aShape = mapIntShapes.value(theId);
 
-    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
-    for (; anIter.More(); anIter.Next())
+    if (aShape.IsNull() || theNewShape.IsNull())
     {
-        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
-
-        if (!aShape.IsNull()) {
-            TopExp_Explorer anExp (aShape->Shape(), TopAbs_EDGE);
-            for (; anExp.More(); anExp.Next()) {
-                mContext->AddOrRemoveSelected (anExp.Current(), Standard_False);
-            }
-        }
+        return false;
     }
-    mContext->UpdateCurrentViewer(); //now update the context
 
+    // the old shape stays in the history, the object and its id are kept.
+    mUndoStack->push(new ModifyShapeCommand(mContext, aShape, theNewShape, &mMeshCache));
+    mContext->UpdateCurrentViewer();
+
+    return true;
 }
 
-void MainWindow::deleteSelections()
+void MainWindow::eraseObject(const Handle_AIS_InteractiveObject& theObject)
 {
-    for(mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
-    {
-        mContext->Erase(mContext->Current(), true);
-    }
+    mUndoStack->push(new EraseObjectCommand(mContext, theObject, mSelectionActivator));
 
-    mContext->ClearSelected();
+    mContext->UpdateCurrentViewer();
 }
 
-void MainWindow::drawBoundingBox()
+void MainWindow::displayInstance(const unsigned int theId, const QString& thePrototype, const gp_Trsf& thePlacement)
 {
-    mContext->CloseAllContexts();
-    mContext->OpenLocalContext();
-
-    //Roman Lygin - start of the test
-    //select all edges of all displayed objects
-    AIS_ListOfInteractive aDisplayedList;
-    Standard_Boolean aNeutralPointOnly = Standard_True;
-    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+    Handle_AIS_ConnectedInteractive anInstance = mInstances->place(thePrototype, thePlacement);
 
-    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
-    for (; anIter.More(); anIter.Next())
+    if (anInstance.IsNull())
     {
-//        http://www.opencascade.com/content/how-get-proper-bounding-box-any-shape
-        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
+        return;
+    }
 
-        Standard_Real aDeflection = 0.001, deflection;
-        Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+    mUndoStack->push(new DisplayInstanceCommand(mContext, mapIntInstances, theId, anInstance, mSelectionActivator));
 
-        Bnd_Box box;
-        BRepBndLib::Add(aShape->Shape(), box);
-        box.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
-        deflection= MAX3( aXmax-aXmin , aYmax-aYmin , aZmax-aZmin)*aDeflection;
+    mContext->UpdateCurrentViewer();
+}
 
-        BRepMesh_IncrementalMesh Inc(aShape->Shape(), deflection);
+void MainWindow::addOperandPrototypes()
+{
+    mInstances->addPrototype("operand box", ShapeFactory::makeBox(gp_Ax2(), 3.0, 4.0, 5.0), Quantity_NOC_SPRINGGREEN);
+    mInstances->addPrototype("operand sphere", ShapeFactory::makeSphere(gp_Ax2(), 2.5), Quantity_NOC_STEELBLUE);
+}
 
-        box.SetVoid();
-        BRepBndLib::Add(aShape->Shape(), box);
-        box.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+void MainWindow::clearScene()
+{
+    mContext->CloseAllContexts();
 
+    // the batch goes with RemoveAll(), its members and the clash markers too.
+    mBatch.Nullify();
+    mUnbatched.clear();
+    mMarkers.clear();
+
+    mInstances->clear();
+    mContext->RemoveAll();
+
+    mapIntShapes.clear();
+    mapIntInstances.clear();
+    mapIntFeatures.clear();
+    mFeatures.clear();
+    TopologyIndex::clearCache();
+    mSelectionActivator->clear();
+    occView->culler().clear();
+    mSections->clear();
+    mSections->clearCache();
+    mMassProperties.clear();
+    showProperties(UINT_MAX);
+    mStyles->clear();
+
+    // the history refers to objects that are gone.
+    mUndoStack->clear();
+}
 
-        TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(box.CornerMin(), box.CornerMax()).Shape();
-        Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
+QString MainWindow::runStressBenchmark(const QList<int>& theCounts, const quint32 theSeed)
+{
+    const int aFrameCount = 30;
 
-        anAisBox->SetColor(Quantity_NOC_AZURE);
-        anAisBox->SetTransparency(0.8);
+    QString aReport("count,shapes,failures,build_ms,mesh_ms,display_ms,rss_mb,fps,analytic_faces\n");
 
-        mContext->Display(anAisBox,false);
+    foreach (int aCount, theCounts)
+    {
+        clearScene();
+
+        QElapsedTimer aTimer;
+
+        // 1. build the shapes.
+        aTimer.start();
+        SceneGenerator aGenerator(theSeed);
+        QVector<SceneGenerator::Item> anItems = aGenerator.generate(aCount);
+        const qint64 aBuildTime = aTimer.elapsed();
+
+        // 2. mesh them, bypassing the mesh cache to measure the meshers themselves.
+        // only the faces meshed in closed form are counted, not shapes meshed before.
+        int anAnalyticCount = 0;
+        aTimer.restart();
+        for (int i = 0; i < anItems.size(); ++i)
+        {
+            const TopoDS_Shape& aShape = anItems.at(i).shape;
+            const Standard_Real aDeflection = MeshCache::deflection(aShape);
+
+            int aFaceCount = 0;
+
+            if (AnalyticMesher::perform(aShape, aDeflection, 0.5, &aFaceCount))
+            {
+                anAnalyticCount += aFaceCount;
+            }
+            else
+            {
+                BRepMesh_IncrementalMesh(aShape, aDeflection);
+            }
+        }
+        const qint64 aMeshTime = aTimer.elapsed();
 
+        // 3. display them with a single viewer update.
+        aTimer.restart();
+        for (int i = 0; i < anItems.size(); ++i)
+        {
+            Handle_AIS_Shape anAisShape = new AIS_Shape(anItems.at(i).shape);
+            anAisShape->SetColor(anItems.at(i).color);
+
+            mSelectionActivator->display(anAisShape, Standard_False);
+        }
+        occView->fitAll();
+        const qint64 aDisplayTime = aTimer.elapsed();
+
+        // 4. frame rate of full redraws.
+        Handle_V3d_View aView = occView->getMyView();
+        aTimer.restart();
+        for (int i = 0; i < aFrameCount; ++i)
+        {
+            aView->Redraw();
+        }
+        const qint64 aFrameTime = qMax(aTimer.elapsed(), qint64(1));
+
+        const QString aRow = QString("%1,%2,%3,%4,%5,%6,%7,%8,%9")
+                .arg(aCount)
+                .arg(anItems.size())
+                .arg(aGenerator.failures())
+                .arg(aBuildTime)
+                .arg(aMeshTime)
+                .arg(aDisplayTime)
+                .arg(residentMemoryMB(), 0, 'f', 1)
+                .arg(aFrameCount * 1000.0 / aFrameTime, 0, 'f', 1)
+                .arg(anAnalyticCount);
+
+        aReport += aRow + "\n";
     }
 
-    mContext->UpdateCurrentViewer(); //now update the context
+    return aReport;
 }
 
-void MainWindow::unsetColorOfAllShapes()
+void MainWindow::setLazySelection(bool theIsLazy)
 {
+    mSelectionActivator->setLazy(theIsLazy);
+}
 
-    //    mContext->CloseAllContexts();
-    //    mContext->OpenLocalContext();
-    //    mContext->ActivateStandardMode(TopAbs_EDGE);
-
-    //Roman Lygin - start of the test
-    //select all edges of all displayed objects
-    AIS_ListOfInteractive aDisplayedList;
-    Standard_Boolean aNeutralPointOnly = Standard_True;
-    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+void MainWindow::applyStyle()
+{
+    bool isOk = false;
+    const QString aStyle = QInputDialog::getItem(this, tr("Apply style"), tr("Style:"), mStyles->names(), 0, false, &isOk);
 
-    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
-    for (; anIter.More(); anIter.Next())
+    if (!isOk)
     {
-        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
+        return;
+    }
 
+    AIS_ListOfInteractive anObjects;
 
-        if (!aShape.IsNull()) {
+    for (mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        anObjects.Append(mContext->Current());
+    }
 
-            aShape->UnsetColor();
+    if (anObjects.IsEmpty())
+    {
+        mContext->DisplayedObjects(anObjects, Standard_True);
 
-        }
+        // the batch would take the style as a whole, its members are styled and it is built again.
+        removeObject(anObjects, mBatch);
     }
 
-    mContext->UpdateCurrentViewer(); //now update the context
+    mUndoStack->push(new ApplyStyleCommand(*mStyles, anObjects, aStyle));
+    mContext->UpdateCurrentViewer();
 
+    statusBar()->showMessage(tr("%1 shapes use style %2").arg(mStyles->memberCount(aStyle)).arg(aStyle));
 }
 
-void MainWindow::deleteAllShapes()
+void MainWindow::editStyle()
 {
-#if 1
-    //    mContext->CloseAllContexts();
-    //    mContext->OpenLocalContext();
-    //    mContext->ActivateStandardMode(TopAbs_EDGE);
-
-    //Roman Lygin - start of the test
-    //select all edges of all displayed objects
-    AIS_ListOfInteractive aDisplayedList;
-    Standard_Boolean aNeutralPointOnly = Standard_True;
-    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+    bool isOk = false;
+    const QString aStyle = QInputDialog::getItem(this, tr("Edit style"), tr("Style:"), mStyles->names(), 0, false, &isOk);
 
-    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
-    for (; anIter.More(); anIter.Next())
+    if (!isOk)
     {
-        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
-
-
-        if (!aShape.IsNull()) {
+        return;
+    }
 
-            aShape->UnsetColor();
+    Standard_Real aRed, aGreen, aBlue;
+    mStyles->color(aStyle).Values(aRed, aGreen, aBlue, Quantity_TOC_RGB);
 
-            mContext->Erase(aShape, false);
+    const QColor aColor = QColorDialog::getColor(QColor::fromRgbF(aRed, aGreen, aBlue), this, tr("Color of %1").arg(aStyle));
 
-        }
+    if (!aColor.isValid())
+    {
+        return;
     }
 
+    mUndoStack->push(new DefineStyleCommand(*mStyles, aStyle, Quantity_Color(aColor.redF(), aColor.greenF(), aColor.blueF(), Quantity_TOC_RGB),
+                                            mStyles->material(aStyle)));
+    mContext->UpdateCurrentViewer();
+}
+
+void MainWindow::buildBatch()
+{
+    if (!mBatch.IsNull())
+    {
+        return;
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    Handle_StaticBatch aBatch = new StaticBatch();
+    QSet<unsigned int> aSelected;
+
+    for (QMap<unsigned int, Handle(AIS_Shape)>::const_iterator anIter = mapIntShapes.constBegin(); anIter != mapIntShapes.constEnd(); ++anIter)
+    {
+        const Handle(AIS_Shape)& aShape = anIter.value();
+
+        if (aShape.IsNull() || !mContext->IsDisplayed(aShape))
+        {
+            continue;
+        }
+
+        // selected shapes stay on their own, they are likely to be edited.
+        if (mContext->IsSelected(aShape))
+        {
+            aSelected.insert(anIter.key());
+            continue;
+        }
+
+        const Quantity_Color aColor = mStyles->colorOf(aShape);
+
+        mMeshCache.mesh(aShape->Shape(), MeshCache::deflection(aShape->Shape()));
+        aBatch->Add(anIter.key(), aShape->Shape(), aColor, aShape);
+    }
+
+    if (aBatch->NbMembers() == 0)
+    {
+        return;
+    }
+
+    mBatch = aBatch;
+    mUnbatched = aSelected;
+
+    for (Standard_Integer i = 0; i < mBatch->NbMembers(); ++i)
+    {
+        holdBatched(i);
+    }
+
+    mBatch->Update();
+    mContext->Display(mBatch, Standard_True);
+
+    statusBar()->showMessage(tr("Batched %1 shapes into %2 arrays in %3 ms")
+                             .arg(mBatch->NbMembers()).arg(mBatch->NbGroups()).arg(aTimer.elapsed()));
+}
+
+void MainWindow::dissolveBatch()
+{
+    if (mBatch.IsNull())
+    {
+        return;
+    }
+
+    mContext->Remove(mBatch, Standard_False);
+
+    for (Standard_Integer i = 0; i < mBatch->NbMembers(); ++i)
+    {
+        releaseBatched(i);
+    }
+
+    mBatch.Nullify();
+    mUnbatched.clear();
+    mContext->UpdateCurrentViewer();
+}
+
+void MainWindow::holdBatched(const Standard_Integer theIndex)
+{
+    // the member stays displayed for the context, its structures are hidden
+    // and its selection is off, the batch draws and picks for it.
+    const Handle_AIS_InteractiveObject& anOriginal = mBatch->Original(theIndex);
+
+    mContext->ActivatedModes(anOriginal, mBatch->Modes(theIndex));
+    mContext->Deactivate(anOriginal);
+    mSelectionActivator->setHeld(anOriginal, true);
+    occView->culler().setExcluded(anOriginal, true);
+
+    const PrsMgr_Presentations& aPresentations = anOriginal->Presentations();
+
+    for (Standard_Integer j = 1; j <= aPresentations.Length(); ++j)
+    {
+        aPresentations(j).Presentation()->Presentation()->SetVisible(Standard_False);
+    }
+}
+
+void MainWindow::releaseBatched(const Standard_Integer theIndex)
+{
+    const Handle_AIS_InteractiveObject& anOriginal = mBatch->Original(theIndex);
+    occView->culler().setExcluded(anOriginal, false);
+
+    if (mContext->DisplayStatus(anOriginal) == AIS_DS_None)
+    {
+        return;
+    }
+
+    const PrsMgr_Presentations& aPresentations = anOriginal->Presentations();
+
+    for (Standard_Integer j = 1; j <= aPresentations.Length(); ++j)
+    {
+        aPresentations(j).Presentation()->Presentation()->SetVisible(Standard_True);
+    }
+
+    for (TColStd_ListIteratorOfListOfInteger aMode(mBatch->Modes(theIndex)); aMode.More(); aMode.Next())
+    {
+        mContext->Activate(anOriginal, aMode.Value());
+    }
+
+    mSelectionActivator->setHeld(anOriginal, false);
+}
+
+void MainWindow::addToBatch(const unsigned int theId)
+{
+    const Handle(AIS_Shape) aShape = mapIntShapes.value(theId);
+
+    mMeshCache.mesh(aShape->Shape(), MeshCache::deflection(aShape->Shape()));
+    mBatch->Add(theId, aShape->Shape(), mStyles->colorOf(aShape), aShape);
+    holdBatched(mBatch->NbMembers() - 1);
+
+    mUnbatched.remove(theId);
+}
+
+void MainWindow::removeFromBatch(const unsigned int theId)
+{
+    const Standard_Integer anIndex = mBatch.IsNull() ? -1 : mBatch->Index(theId);
+
+    if (anIndex < 0)
+    {
+        return;
+    }
+
+    releaseBatched(anIndex);
+    mBatch->Remove(anIndex);
+
+    mUnbatched.insert(theId);
+}
+
+void MainWindow::updateBatch()
+{
+    // only the arrays of the colors that lost or gained members are built again,
+    // the sensitive entities of the members are kept and only collected again.
+    if (!mBatch.IsNull() && mBatch->Update())
+    {
+        mContext->RecomputeSelectionOnly(mBatch);
+    }
+}
+
+void MainWindow::setStaticBatching(bool theIsOn)
+{
+    if (theIsOn)
+    {
+        buildBatch();
+    }
+    else
+    {
+        dissolveBatch();
+    }
+}
+
+void MainWindow::rebuildBatch()
+{
+    if (!mBatchAction->isChecked())
+    {
+        return;
+    }
+
+    if (mBatch.IsNull())
+    {
+        buildBatch();
+        return;
+    }
+
+    // 1. members edited, restyled, erased or selected since they were batched leave it.
+    for (Standard_Integer i = mBatch->NbMembers() - 1; i >= 0; --i)
+    {
+        const Handle(AIS_Shape) aShape = mapIntShapes.value(mBatch->Id(i));
+
+        if (aShape.Access() != mBatch->Original(i).Access() || !mContext->IsDisplayed(aShape) || mContext->IsSelected(aShape)
+            || !aShape->Shape().IsEqual(mBatch->Shape(i)) || mStyles->colorOf(aShape).IsDifferent(mBatch->Color(i)))
+        {
+            removeFromBatch(mBatch->Id(i));
+        }
+    }
+
+    // 2. the other displayed shapes join it, the selected ones once they are deselected.
+    for (QMap<unsigned int, Handle(AIS_Shape)>::const_iterator anIter = mapIntShapes.constBegin(); anIter != mapIntShapes.constEnd(); ++anIter)
+    {
+        const Handle(AIS_Shape)& aShape = anIter.value();
+
+        if (aShape.IsNull() || !mContext->IsDisplayed(aShape) || mBatch->Index(anIter.key()) >= 0)
+        {
+            continue;
+        }
+
+        if (mContext->IsSelected(aShape))
+        {
+            mUnbatched.insert(anIter.key());
+        }
+        else
+        {
+            addToBatch(anIter.key());
+        }
+    }
+
+    updateBatch();
+    mContext->UpdateCurrentViewer();
+}
+
+void MainWindow::sceneChanged()
+{
+    // unchanged shapes take their sections and properties from the caches.
+    updateSections();
+    showProperties(mPropertiesId);
+
+    if (mBatch.IsNull())
+    {
+        return;
+    }
+
+    // edits apply to the members, the changed ones are merged again once idle.
+    QTimer::singleShot(0, this, SLOT(rebuildBatch()));
+}
+
+QList<TopoDS_Shape> MainWindow::shapesOf(const AIS_ListOfInteractive& theObjects) const
+{
+    QList<TopoDS_Shape> aShapes;
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(theObjects); anIter.More(); anIter.Next())
+    {
+        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
+
+        if (mSections->isSection(anIter.Value()) || mMarkers.contains(aShape))
+        {
+            continue;
+        }
+
+        // instances give the prototype at their placement, other objects have no shape.
+        const TopoDS_Shape aTopoShape = aShape.IsNull() ? mInstances->placedShape(anIter.Value()) : aShape->Shape();
+
+        if (!aTopoShape.IsNull())
+        {
+            aShapes.append(aTopoShape);
+        }
+    }
+
+    return aShapes;
+}
+
+Handle_AIS_InteractiveObject MainWindow::objectOf(const unsigned int theId) const
+{
+    if (mapIntShapes.contains(theId))
+    {
+        return mapIntShapes.value(theId);
+    }
+
+    return mapIntInstances.value(theId);
+}
+
+unsigned int MainWindow::idOf(const Handle_AIS_InteractiveObject& theObject) const
+{
+    // the maps may hold null handles, a null key must not match them.
+    Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (theObject);
+
+    if (!aShape.IsNull())
+    {
+        return mapIntShapes.key(aShape, UINT_MAX);
+    }
+
+    Handle(AIS_ConnectedInteractive) anInstance = Handle(AIS_ConnectedInteractive)::DownCast (theObject);
+
+    if (!anInstance.IsNull())
+    {
+        return mapIntInstances.key(anInstance, UINT_MAX);
+    }
+
+    return UINT_MAX;
+}
+
+QMap<unsigned int, TopoDS_Shape> MainWindow::displayedShapes() const
+{
+    QMap<unsigned int, TopoDS_Shape> aShapes;
+
+    for (QMap<unsigned int, Handle(AIS_Shape)>::const_iterator anIter = mapIntShapes.constBegin(); anIter != mapIntShapes.constEnd(); ++anIter)
+    {
+        if (!anIter.value().IsNull() && mContext->IsDisplayed(anIter.value()))
+        {
+            aShapes.insert(anIter.key(), anIter.value()->Shape());
+        }
+    }
+
+    for (QMap<unsigned int, Handle(AIS_ConnectedInteractive)>::const_iterator anIter = mapIntInstances.constBegin(); anIter != mapIntInstances.constEnd(); ++anIter)
+    {
+        if (anIter.value().IsNull() || !mContext->IsDisplayed(anIter.value()))
+        {
+            continue;
+        }
+
+        const TopoDS_Shape aShape = mInstances->placedShape(anIter.value());
+
+        if (!aShape.IsNull())
+        {
+            aShapes.insert(anIter.key(), aShape);
+        }
+    }
+
+    return aShapes;
+}
+
+void MainWindow::addSectionPlane()
+{
+    QStringList aNormals;
+    aNormals << "X" << "Y" << "Z";
+
+    bool isOk = false;
+    const QString aNormal = QInputDialog::getItem(this, tr("Add section plane"), tr("Normal:"), aNormals, 2, false, &isOk);
+
+    if (!isOk)
+    {
+        return;
+    }
+
+    AIS_ListOfInteractive aDisplayedList;
+    mContext->DisplayedObjects(aDisplayedList);
+
+    Bnd_Box aBox;
+
+    foreach (const TopoDS_Shape& aShape, shapesOf(aDisplayedList))
+    {
+        BRepBndLib::Add(aShape, aBox);
+    }
+
+    gp_Pnt aCenter = gp::Origin();
+
+    if (!aBox.IsVoid())
+    {
+        Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+        aBox.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+        aCenter = gp_Pnt((aXmin + aXmax) * 0.5, (aYmin + aYmax) * 0.5, (aZmin + aZmax) * 0.5);
+    }
+
+    const gp_Dir aDirection = aNormal == "X" ? gp::DX() : (aNormal == "Y" ? gp::DY() : gp::DZ());
+
+    mSections->add(gp_Pln(aCenter, aDirection));
+    updateSections();
+
+    // drag right away, the previous mode is one click away in the toolbar.
+    occView->moveSection();
+    occView->redraw();
+}
+
+void MainWindow::removeSectionPlanes()
+{
+    mSections->clear();
+    mContext->UpdateCurrentViewer();
+}
+
+void MainWindow::updateSections()
+{
+    if (mSections->count() == 0)
+    {
+        return;
+    }
+
+    AIS_ListOfInteractive aDisplayedList;
+    mContext->DisplayedObjects(aDisplayedList);
+
+    mSections->section(shapesOf(aDisplayedList));
+    mContext->UpdateCurrentViewer();
+
+    statusBar()->showMessage(tr("Computing %1 sections, %2 cached").arg(mSections->pendingCount()).arg(mSections->cacheSize()));
+}
+
+void MainWindow::removeMarkers()
+{
+    foreach (const Handle_AIS_Shape& aMarker, mMarkers)
+    {
+        mContext->Remove(aMarker, Standard_False);
+    }
+
+    mMarkers.clear();
+}
+
+void MainWindow::checkInterference()
+{
+    removeMarkers();
+
+    InterferenceCheck aCheck;
+
+    const QMap<unsigned int, TopoDS_Shape> aShapes = displayedShapes();
+
+    for (QMap<unsigned int, TopoDS_Shape>::const_iterator anIter = aShapes.constBegin(); anIter != aShapes.constEnd(); ++anIter)
+    {
+        aCheck.add(anIter.key(), anIter.value());
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QVector<InterferenceCheck::Clash> aClashes = aCheck.run();
+    QApplication::restoreOverrideCursor();
+
+    mContext->ClearSelected(Standard_False);
+
+    QSet<unsigned int> aSelected;
+    QStringList aPairs;
+
+    foreach (const InterferenceCheck::Clash& aClash, aClashes)
+    {
+        aPairs.append(tr("shape %1 - shape %2: volume %3").arg(aClash.first).arg(aClash.second).arg(aClash.volume));
+
+        foreach (unsigned int anId, QList<unsigned int>() << aClash.first << aClash.second)
+        {
+            if (!aSelected.contains(anId))
+            {
+                // batched shapes can not show a highlight, they get their own presentation back.
+                aSelected.insert(anId);
+                removeFromBatch(anId);
+                mContext->AddOrRemoveSelected(objectOf(anId), Standard_False);
+            }
+        }
+
+        if (aClash.volume > 0.0 && !aClash.common.IsNull())
+        {
+            Handle_AIS_Shape aMarker = new AIS_Shape(aClash.common);
+            aMarker->SetColor(Quantity_NOC_RED);
+
+            mContext->Display(aMarker, 1, -1, Standard_False);
+            mMarkers.append(aMarker);
+        }
+    }
+
+    updateBatch();
+    mContext->UpdateCurrentViewer();
+
+    const QString aSummary = tr("%1 clashes among %2 candidate pairs, broad phase %3 ms, exact tests %4 ms")
+                             .arg(aClashes.size()).arg(aCheck.candidateCount())
+                             .arg(aCheck.broadPhaseTime()).arg(aCheck.narrowPhaseTime());
+
+    statusBar()->showMessage(aSummary);
+
+    if (!aClashes.isEmpty())
+    {
+        QMessageBox aBox(QMessageBox::Warning, tr("Check interference"), aSummary, QMessageBox::Ok, this);
+        aBox.setDetailedText(aPairs.join("\n"));
+        aBox.exec();
+    }
+}
+
+void MainWindow::checkClearance()
+{
+    bool isOk = false;
+    const double aRadius = QInputDialog::getDouble(this, tr("Check clearance"), tr("Report distances up to:"),
+                                                   1.0, 0.0, 1.0e6, 3, &isOk);
+
+    if (!isOk)
+    {
+        return;
+    }
+
+    removeMarkers();
+
+    // the selection against everything, or everything against everything.
+    QSet<unsigned int> aSelected;
+
+    for (mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        const unsigned int anId = idOf(mContext->Current());
+
+        if (anId != UINT_MAX)
+        {
+            aSelected.insert(anId);
+        }
+    }
+
+    mClearance.clearShapes();
+
+    const QMap<unsigned int, TopoDS_Shape> aShapes = displayedShapes();
+
+    for (QMap<unsigned int, TopoDS_Shape>::const_iterator anIter = aShapes.constBegin(); anIter != aShapes.constEnd(); ++anIter)
+    {
+        if (aSelected.isEmpty() || aSelected.contains(anIter.key()))
+        {
+            mClearance.addSource(anIter.key(), anIter.value());
+        }
+
+        mClearance.addTarget(anIter.key(), anIter.value());
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QVector<ClearanceQuery::Result> aResults = mClearance.run(aRadius);
+    QApplication::restoreOverrideCursor();
+
+    // one object with a segment between the closest points of each pair.
+    TopoDS_Compound aCompound;
+    BRep_Builder aBuilder;
+    aBuilder.MakeCompound(aCompound);
+
+    QStringList aPairs;
+
+    foreach (const ClearanceQuery::Result& aResult, aResults)
+    {
+        aPairs.append(tr("shape %1 - shape %2: %3").arg(aResult.first).arg(aResult.second).arg(aResult.distance));
+
+        if (aResult.point1.Distance(aResult.point2) > Precision::Confusion())
+        {
+            aBuilder.Add(aCompound, BRepBuilderAPI_MakeEdge(aResult.point1, aResult.point2).Edge());
+        }
+
+        aBuilder.Add(aCompound, BRepBuilderAPI_MakeVertex(aResult.point1).Vertex());
+        aBuilder.Add(aCompound, BRepBuilderAPI_MakeVertex(aResult.point2).Vertex());
+    }
+
+    if (!aResults.isEmpty())
+    {
+        Handle_AIS_Shape aMarker = new AIS_Shape(aCompound);
+        aMarker->SetColor(Quantity_NOC_CYAN1);
+        aMarker->SetWidth(2.0);
+
+        mContext->Display(aMarker, 0, -1, Standard_False);
+        mMarkers.append(aMarker);
+    }
+
+    mContext->UpdateCurrentViewer();
+
+    const QString aSummary = tr("%1 pairs within %2, %3 measured, %4 ms")
+                             .arg(aResults.size()).arg(aRadius).arg(mClearance.candidateCount()).arg(mClearance.elapsed());
+
+    statusBar()->showMessage(aSummary);
+
+    if (!aResults.isEmpty())
+    {
+        QMessageBox aBox(QMessageBox::Information, tr("Check clearance"), aSummary, QMessageBox::Ok, this);
+        aBox.setDetailedText(aPairs.join("\n"));
+        aBox.exec();
+    }
+}
+
+void MainWindow::checkAndHeal()
+{
+    QSet<unsigned int> aSelected;
+
+    for (mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        const unsigned int anId = idOf(mContext->Current());
+
+        if (anId != UINT_MAX)
+        {
+            aSelected.insert(anId);
+        }
+    }
+
+    ShapeHealer aHealer;
+
+    for (QMap<unsigned int, Handle(AIS_Shape)>::const_iterator anIter = mapIntShapes.constBegin(); anIter != mapIntShapes.constEnd(); ++anIter)
+    {
+        if (!anIter.value().IsNull() && mContext->IsDisplayed(anIter.value())
+         && (aSelected.isEmpty() || aSelected.contains(anIter.key())))
+        {
+            aHealer.add(anIter.key(), anIter.value()->Shape());
+        }
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    const QVector<ShapeHealer::Report> aReports = aHealer.run();
+    QApplication::restoreOverrideCursor();
+
+    // only the fixed shapes get a new presentation, in one undo step.
+    int anInvalid = 0;
+    int aFixed = 0;
+    QStringList aLines;
+
+    foreach (const ShapeHealer::Report& aReport, aReports)
+    {
+        aLines.append(ShapeHealer::describe(aReport));
+
+        if (!aReport.wasValid)
+        {
+            ++anInvalid;
+        }
+
+        if (aReport.isChanged)
+        {
+            if (aFixed == 0)
+            {
+                mUndoStack->beginMacro(tr("Heal shapes"));
+            }
+
+            updateShape(aReport.id, aReport.shape);
+            ++aFixed;
+        }
+    }
+
+    if (aFixed > 0)
+    {
+        mUndoStack->endMacro();
+    }
+
+    const QString aSummary = tr("Checked %1 shapes in %2 ms: %3 invalid, %4 fixed")
+                             .arg(aReports.size()).arg(aTimer.elapsed()).arg(anInvalid).arg(aFixed);
+
+    statusBar()->showMessage(aSummary);
+
+    QMessageBox aBox(anInvalid > 0 ? QMessageBox::Warning : QMessageBox::Information, tr("Check & heal"), aSummary, QMessageBox::Ok, this);
+    aBox.setDetailedText(aLines.join("\n"));
+    aBox.exec();
+}
+
+void MainWindow::setViewCulling(bool theIsOn)
+{
+    occView->culler().setEnabled(theIsOn);
+
+    if (!theIsOn)
+    {
+        mCullingLabel->clear();
+    }
+
+    occView->redraw();
+}
+
+void MainWindow::reportCulling(int theDrawn, int theOutside, int theSmall)
+{
+    mCullingLabel->setText(tr("Drawn %1, culled %2 outside, %3 small").arg(theDrawn).arg(theOutside).arg(theSmall));
+}
+
+void MainWindow::recordInput(bool theIsOn)
+{
+    if (theIsOn)
+    {
+        // the trace starts from the current camera and mouse mode.
+        mInputTrace.start(occView);
+        occView->setInputRecording(&mInputTrace);
+
+        statusBar()->showMessage(tr("Recording the input of the view"));
+        return;
+    }
+
+    occView->setInputRecording(NULL);
+
+    QString aFileName = QFileDialog::getSaveFileName(this, tr("Save input trace"), QString(),
+                                                     tr("Input trace (*.trace)"));
+
+    if (aFileName.isEmpty())
+    {
+        statusBar()->showMessage(tr("Input trace discarded"));
+        return;
+    }
+
+    QString anError;
+
+    if (!mInputTrace.save(aFileName, anError))
+    {
+        QMessageBox::warning(this, tr("Record input"), anError);
+        return;
+    }
+
+    statusBar()->showMessage(tr("%1 events in %2 ms saved to %3")
+                             .arg(mInputTrace.events().size()).arg(mInputTrace.duration()).arg(aFileName));
+}
+
+void MainWindow::replayInput()
+{
+    QString aFileName = QFileDialog::getOpenFileName(this, tr("Replay input trace"), QString(),
+                                                     tr("Input trace (*.trace)"));
+
+    if (aFileName.isEmpty())
+    {
+        return;
+    }
+
+    const QStringList aSpeeds = QStringList() << tr("Maximum speed") << tr("Recorded pace");
+
+    bool isOk = false;
+    const QString aSpeed = QInputDialog::getItem(this, tr("Replay input"), tr("Speed:"), aSpeeds, 0, false, &isOk);
+
+    if (!isOk)
+    {
+        return;
+    }
+
+    QString anError;
+
+    if (!startReplay(aFileName, aSpeed == aSpeeds.last(), anError))
+    {
+        QMessageBox::warning(this, tr("Replay input"), anError);
+        return;
+    }
+
+    mShowReplayReport = true;
+}
+
+bool MainWindow::startReplay(const QString& theFileName, const bool isRealTime, QString& theError)
+{
+    if (mInputReplay->isRunning())
+    {
+        theError = tr("A replay is running");
+        return false;
+    }
+
+    InputTrace aTrace;
+
+    if (!aTrace.load(theFileName, theError))
+    {
+        return false;
+    }
+
+    // the replayed events must not go into a recording. The recording is
+    // dropped without the save dialog of recordInput(), which would block
+    // a replay run from the command line.
+    mRecordInputAction->blockSignals(true);
+    mRecordInputAction->setChecked(false);
+    mRecordInputAction->blockSignals(false);
+
+    occView->setInputRecording(NULL);
+
+    mShowReplayReport = false;
+    mInputReplay->start(aTrace, isRealTime);
+
+    statusBar()->showMessage(tr("Replaying %1 events").arg(aTrace.events().size()));
+
+    return true;
+}
+
+void MainWindow::reportReplay()
+{
+    const QString aReport = mInputReplay->report();
+
+    statusBar()->showMessage(tr("Replay done"));
+
+    if (mShowReplayReport)
+    {
+        QMessageBox::information(this, tr("Replay input"), "<pre>" + aReport + "</pre>");
+    }
+
+    emit replayFinished(aReport);
+}
+
+void MainWindow::reportSelection()
+{
+    const int aBatchedId = StaticBatch::DetectedId(mContext);
+
+    if (!mBatch.IsNull())
+    {
+        // the context selects the batch as one object. The picked member leaves
+        // the batch and is selected in its place, so delete, styles and checks
+        // find the shape and its id. Only the array of its color is built again.
+        if (mContext->IsSelected(mBatch))
+        {
+            mContext->AddOrRemoveCurrentObject(mBatch, Standard_False);
+
+            if (aBatchedId >= 0 && mBatch->Index(aBatchedId) >= 0)
+            {
+                removeFromBatch(aBatchedId);
+                mContext->AddOrRemoveCurrentObject(objectOf(aBatchedId), Standard_False);
+            }
+            else
+            {
+                statusBar()->showMessage(tr("Batched shapes are picked one by one, turn static batching off to select an area"));
+            }
+        }
+
+        // the shapes picked before join the batch again once they are deselected.
+        foreach (unsigned int anId, mUnbatched)
+        {
+            const Handle(AIS_Shape) aShape = mapIntShapes.value(anId);
+
+            if (aShape.IsNull() || !mContext->IsDisplayed(aShape))
+            {
+                mUnbatched.remove(anId);
+            }
+            else if (!mContext->IsSelected(aShape))
+            {
+                addToBatch(anId);
+            }
+        }
+
+        updateBatch();
+        mContext->UpdateCurrentViewer();
+    }
+
+    if (aBatchedId >= 0)
+    {
+        statusBar()->showMessage(tr("Picked shape %1").arg(aBatchedId));
+        showProperties(aBatchedId);
+        return;
+    }
+
+    for (mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast(mContext->Current());
+        const unsigned int anId = mapIntShapes.key(aShape, UINT_MAX);
+
+        if (anId != UINT_MAX)
+        {
+            statusBar()->showMessage(tr("Picked shape %1").arg(anId));
+            showProperties(anId);
+            return;
+        }
+    }
+
+    showProperties(UINT_MAX);
+}
+
+void MainWindow::showProperties(const unsigned int theId)
+{
+    mPropertiesId = theId;
+
+    const Handle(AIS_Shape) aShape = mapIntShapes.value(theId);
+
+    mPropertiesPanel->showShape(aShape.IsNull() ? TopoDS_Shape() : aShape->Shape(), tr("shape %1").arg(theId));
+}
+
+void MainWindow::stressBenchmark()
+{
+    bool isOk = false;
+    QString aCounts = QInputDialog::getText(this, tr("Stress benchmark"),
+                                            tr("Shapes of each kind (comma separated):"),
+                                            QLineEdit::Normal, "10,100,1000", &isOk);
+
+    if (!isOk)
+    {
+        return;
+    }
+
+    QList<int> aCountList;
+
+    foreach (const QString& aCount, aCounts.split(',', QString::SkipEmptyParts))
+    {
+        if (aCount.trimmed().toInt() > 0)
+        {
+            aCountList.append(aCount.trimmed().toInt());
+        }
+    }
+
+    const QString aReport = runStressBenchmark(aCountList, 42);
+
+    QMessageBox::information(this, tr("Stress benchmark"), "<pre>" + aReport + "</pre>");
+}
+
+void MainWindow::selectEdges()
+{
+    //    mContext->Select(this->x() - this->width(), this->y() - this->height(), this->width(), this->height(), occView->getMyView(), true);
+
+    mContext->CloseAllContexts();
+    mContext->OpenLocalContext();
+
+    // faces become pickable as the cursor reaches each shape.
+    mSelectionActivator->activateStandardMode(TopAbs_FACE);
+
+    //Roman Lygin - start of the test
+    //select all edges of all displayed objects
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    const int aCount = SubShapeSelection::selectAll(mContext, TopAbs_EDGE);
+
+    statusBar()->showMessage(tr("Selected %1 edges in %2 ms").arg(aCount).arg(aTimer.elapsed()));
+
+}
+
+void MainWindow::deleteSelections()
+{
+    AIS_ListOfInteractive aSelectedList;
+
+    for(mContext->InitCurrent(); mContext->MoreCurrent(); mContext->NextCurrent())
+    {
+        aSelectedList.Append(mContext->Current());
+    }
+
+    mContext->ClearSelected();
+
+    mUndoStack->beginMacro(tr("Delete selection"));
+
+    AIS_ListIteratorOfListOfInteractive anIter (aSelectedList);
+    for (; anIter.More(); anIter.Next())
+    {
+        mUndoStack->push(new EraseObjectCommand(mContext, anIter.Value(), mSelectionActivator));
+    }
+
+    mUndoStack->endMacro();
+
+    mContext->UpdateCurrentViewer();
+}
+
+void MainWindow::drawBoundingBox()
+{
+    mContext->CloseAllContexts();
+    mContext->OpenLocalContext();
+
+    //Roman Lygin - start of the test
+    //select all edges of all displayed objects
+    AIS_ListOfInteractive aDisplayedList;
+    Standard_Boolean aNeutralPointOnly = Standard_True;
+    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+
+    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
+    for (; anIter.More(); anIter.Next())
+    {
+//        http://www.opencascade.com/content/how-get-proper-bounding-box-any-shape
+        Handle(AIS_Shape) aShape = Handle(AIS_Shape)::DownCast (anIter.Value());
+        TopoDS_Shape aTopoShape = aShape.IsNull() ? mInstances->placedShape(anIter.Value()) : aShape->Shape();
+
+        if (aTopoShape.IsNull())
+        {
+            continue;
+        }
+
+        // the box is tight once the shape is triangulated.
+        mMeshCache.mesh(aTopoShape, MeshCache::deflection(aTopoShape));
+
+        TopoDS_Shape aTopoBox = ShapeFactory::makeBox(ShapeFactory::boundingBox(aTopoShape));
+        Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
+
+        anAisBox->SetColor(Quantity_NOC_AZURE);
+        anAisBox->SetTransparency(0.8);
+
+        mContext->Display(anAisBox,false);
+
+    }
+
+    mContext->UpdateCurrentViewer(); //now update the context
+}
+
+void MainWindow::unsetColorOfAllShapes()
+{
+
+    //    mContext->CloseAllContexts();
+    //    mContext->OpenLocalContext();
+    //    mContext->ActivateStandardMode(TopAbs_EDGE);
+
+    //Roman Lygin - start of the test
+    //select all edges of all displayed objects
+    AIS_ListOfInteractive aDisplayedList;
+    Standard_Boolean aNeutralPointOnly = Standard_True;
+    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+
+    AIS_ListOfInteractive aShapes;
+    QSet<const void*> aPrototypes;
+
+    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
+    for (; anIter.More(); anIter.Next())
+    {
+        if (anIter.Value()->IsKind(STANDARD_TYPE(AIS_Shape))) {
+            aShapes.Append(anIter.Value());
+            continue;
+        }
+
+        // instances are drawn with the aspects of their prototype, each one is styled once.
+        Handle(AIS_ConnectedInteractive) anInstance = Handle(AIS_ConnectedInteractive)::DownCast (anIter.Value());
+
+        if (!mInstances->placedShape(anInstance).IsNull() && !aPrototypes.contains(anInstance->ConnectedTo().Access()))
+        {
+            aPrototypes.insert(anInstance->ConnectedTo().Access());
+            aShapes.Append(anInstance->ConnectedTo());
+        }
+    }
+
+    // one shared default style instead of a private aspect per shape.
+    mUndoStack->push(new ApplyStyleCommand(*mStyles, aShapes, StylePalette::DEFAULT_STYLE));
+
+    mContext->UpdateCurrentViewer(); //now update the context
+
+}
+
+void MainWindow::deleteAllShapes()
+{
+#if 1
+    //    mContext->CloseAllContexts();
+    //    mContext->OpenLocalContext();
+    //    mContext->ActivateStandardMode(TopAbs_EDGE);
+
+    //Roman Lygin - start of the test
+    //select all edges of all displayed objects
+    AIS_ListOfInteractive aDisplayedList;
+    Standard_Boolean aNeutralPointOnly = Standard_True;
+    mContext->DisplayedObjects (aDisplayedList, aNeutralPointOnly);
+
+    // the batch goes with its members once the scene changed.
+    removeObject(aDisplayedList, mBatch);
+
+    mUndoStack->beginMacro(tr("Delete all"));
+
+    AIS_ListIteratorOfListOfInteractive anIter (aDisplayedList);
+    for (; anIter.More(); anIter.Next())
+    {
+        // erased shapes keep their style, there is nothing to reset before.
+        // instances are erased too, their prototype is never displayed.
+        mUndoStack->push(new EraseObjectCommand(mContext, anIter.Value(), mSelectionActivator));
+    }
+
+    mUndoStack->endMacro();
+
     mContext->UpdateCurrentViewer(); //now update the context
 #endif
 
@@ -905,7 +2228,7 @@ void MainWindow::deleteBox()
 {
     if(!mapIntShapes[0].IsNull())
     {
-        mContext->Erase(mapIntShapes[0]);
+        eraseObject(mapIntShapes[0]);
     }
 }
 
@@ -918,28 +2241,77 @@ void MainWindow::modifyBox()
 //        mContext->Erase(mapIntShapes[0]);
 //        Topo shape = mapIntShapes[0]->Shape();
 
-        TopoDS_Shape aTopoBox = BRepPrimAPI_MakeBox(5.0, 2.0, 2.0).Shape();
+        TopoDS_Shape aTopoBox = ShapeFactory::makeBox(gp_Ax2(), 5.0, 2.0, 2.0);
 //        Handle_AIS_Shape anAisBox = new AIS_Shape(aTopoBox);
-        BRepTools_ReShape reshape;
+        TopoDS_Shape result = ShapeFactory::replaced(mapIntShapes[0]->Shape(), mapIntShapes[0]->Shape(), aTopoBox);
+
+        updateShape(0, result);
+    }
+}
+
+void MainWindow::editFeatureBox()
+{
+    if (mapIntFeatures.isEmpty())
+    {
+        statusBar()->showMessage(tr("Make a fillet or a chamfer first"));
+        return;
+    }
+
+    const FeatureGraph::NodeId aFirst = mFeatures.inputs(mapIntFeatures.first()).first();
 
-        reshape.Replace(mapIntShapes[0]->Shape(), aTopoBox, true);
-        TopoDS_Shape result = reshape.Apply(mapIntShapes[0]->Shape());
+    bool isOk = false;
+    const double aHeight = QInputDialog::getDouble(this, tr("Feature box"), tr("Height:"),
+                                                   mFeatures.parameter(aFirst, 5), 0.5, 100.0, 2, &isOk);
 
-        Handle(AIS_Shape) aisShape = new AIS_Shape(result);
+    if (!isOk)
+    {
+        return;
+    }
+
+    // the parameters are part of the edit, undo gives the boxes their old height.
+    mUndoStack->beginMacro(tr("Edit feature box"));
+
+    foreach (FeatureGraph::NodeId aFeature, mapIntFeatures)
+    {
+        mUndoStack->push(new FeatureParameterCommand(mFeatures, mFeatures.inputs(aFeature).first(), 5, aHeight));
+    }
+
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    const QList<FeatureGraph::NodeId> aRecomputed = mFeatures.recompute();
 
-        mContext->Erase(mapIntShapes[0], true);
-        mapIntShapes.remove(0);
+    // only the displayed results of recomputed nodes change.
+    QStringList anErrors;
 
-        mapIntShapes.insert(0, aisShape);
-        mContext->Display(mapIntShapes[0], true);
+    foreach (FeatureGraph::NodeId aNode, aRecomputed)
+    {
+        foreach (unsigned int anId, mapIntFeatures.keys(aNode))
+        {
+            if (!updateShape(anId, mFeatures.shape(aNode)))
+            {
+                anErrors.append(tr("shape %1: %2").arg(anId).arg(mFeatures.error(aNode)));
+            }
+        }
+    }
+
+    mUndoStack->endMacro();
+
+    if (!anErrors.isEmpty())
+    {
+        statusBar()->showMessage(tr("Feature box not updated, %1").arg(anErrors.join("; ")));
+        return;
     }
+
+    statusBar()->showMessage(tr("Recomputed %1 of %2 features in %3 ms")
+                             .arg(aRecomputed.size()).arg(mFeatures.nodeCount()).arg(aTimer.elapsed()));
 }
 
 void MainWindow::deleteCone()
 {
     if(!mapIntShapes[2].IsNull())
     {
-        mContext->Erase(mapIntShapes[2]);
+        eraseObject(mapIntShapes[2]);
     }
 }
 
@@ -947,7 +2319,7 @@ void MainWindow::deleteConeReducer()
 {
     if(!mapIntShapes[1].IsNull())
     {
-        mContext->Erase(mapIntShapes[1]);
+        eraseObject(mapIntShapes[1]);
     }
 }
 
@@ -955,7 +2327,7 @@ void MainWindow::deleteSphere()
 {
     if(!mapIntShapes[3].IsNull())
     {
-        mContext->Erase(mapIntShapes[3]);
+        eraseObject(mapIntShapes[3]);
     }
 }
 
@@ -963,7 +2335,7 @@ void MainWindow::deleteCylinder()
 {
     if(!mapIntShapes[4].IsNull())
     {
-        mContext->Erase(mapIntShapes[4]);
+        eraseObject(mapIntShapes[4]);
     }
 }
 
@@ -971,7 +2343,7 @@ void MainWindow::deletePie()
 {
     if(!mapIntShapes[5].IsNull())
     {
-        mContext->Erase(mapIntShapes[5]);
+        eraseObject(mapIntShapes[5]);
     }
 }
 
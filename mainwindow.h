@@ -2,9 +2,26 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QSet>
 #include <QTimer>
+#include <QUndoStack>
+
+class QLabel;
+class PropertiesPanel;
+class InputReplay;
 
 #include "occview.h"
+#include "meshcache.h"
+#include "instancelibrary.h"
+#include "scenecommands.h"
+#include "featuregraph.h"
+#include "selectionactivator.h"
+#include "stylepalette.h"
+#include "staticbatch.h"
+#include "sectionplanes.h"
+#include "clearancequery.h"
+#include "massproperties.h"
+#include "inputtrace.h"
 
 #include <TopoDS.hxx>
 #include <TopoDS_Shape.hxx>
@@ -26,6 +43,22 @@ public:
     explicit MainWindow(QWidget *parent = 0);
     ~MainWindow();
 
+    //! swap the shape registered under theId in place, through the undo stack.
+    bool updateShape(const unsigned int theId, const TopoDS_Shape& theNewShape);
+
+    //! replace the scene by generated shapes for each count, returns one CSV row per count.
+    QString runStressBenchmark(const QList<int>& theCounts, const quint32 theSeed);
+
+    //! replay a recorded input trace on the view, replayFinished() gives the timings.
+    bool startReplay(const QString& theFileName, const bool isRealTime, QString& theError);
+
+signals:
+    //! the 3d view has been drawn for the first time.
+    void firstFrame(void);
+
+    //! the timings of the replay started last.
+    void replayFinished(const QString& theReport);
+
 protected:
     // initialize the OpenCASCADE modeler.
     void InitializeModeler(void);
@@ -39,11 +72,71 @@ protected:
 
     //! create the toolbar.
     void createToolBars(void);
+
+    //! mesh the shape through the mesh cache, display it and register it in the map.
+    void displayShape(const unsigned int theId, const Handle_AIS_Shape& theShape);
+
+    //! display a placement of a prototype and register it in the instance map.
+    void displayInstance(const unsigned int theId, const QString& thePrototype, const gp_Trsf& thePlacement);
+
+    //! register the box and sphere used as boolean operands.
+    void addOperandPrototypes(void);
+
+    //! remove every object from the context and forget the maps.
+    void clearScene(void);
+
+    //! erase an object through the undo stack.
+    void eraseObject(const Handle_AIS_InteractiveObject& theObject);
+
+    //! merge the displayed, unselected shapes into one static batch.
+    void buildBatch(void);
+
+    //! give the batched shapes back their own presentation and selection.
+    void dissolveBatch(void);
+
+    //! hide the presentation and the selection of a batch member, the batch draws and picks for it.
+    void holdBatched(const Standard_Integer theIndex);
+
+    //! give a batch member its own presentation and selection back.
+    void releaseBatched(const Standard_Integer theIndex);
+
+    //! merge a displayed shape of the map into the batch.
+    void addToBatch(const unsigned int theId);
+
+    //! take a shape out of the batch, it joins again once it is deselected.
+    void removeFromBatch(const unsigned int theId);
+
+    //! build again the colors of the batch whose members changed and refresh its selection.
+    void updateBatch(void);
+
+    //! show the mass properties of a shape of the map in the panel, UINT_MAX for none.
+    void showProperties(const unsigned int theId);
+
+    //! remove the results shown by the last interference or clearance check.
+    void removeMarkers(void);
+
+    //! the shapes of interactive shapes and instances, section results and markers are skipped.
+    QList<TopoDS_Shape> shapesOf(const AIS_ListOfInteractive& theObjects) const;
+
+    //! the shape or the instance registered under theId, null for none.
+    Handle_AIS_InteractiveObject objectOf(const unsigned int theId) const;
+
+    //! the id of a registered shape or instance, UINT_MAX for any other object.
+    unsigned int idOf(const Handle_AIS_InteractiveObject& theObject) const;
+
+    //! the displayed shapes and instances by id, instances at their placement.
+    QMap<unsigned int, TopoDS_Shape> displayedShapes() const;
 private slots:
 
     //! show about box.
     void about(void);
 
+    //! export the displayed shapes to a binary glTF file.
+    void exportGlb(void);
+
+    //! export hidden line drawings of the selected or displayed shapes.
+    void exportDrawing(void);
+
     //! make box test.
     void makeBox(void);
 
@@ -83,9 +176,6 @@ private slots:
     //! test boolean operation common.
     void testCommon(void);
 
-    //! timer Redraw
-    void timerRedraw(void);
-
     //! Find
     void selectEdges(void);
 
@@ -101,10 +191,70 @@ private slots:
     //! Delete all shapes in context
     void deleteAllShapes();
 
+    //! ask for the counts and run the stress benchmark
+    void stressBenchmark();
+
+    //! build selection data on first pick or right at display
+    void setLazySelection(bool theIsLazy);
+
+    //! apply a palette style to the selection, or to all shapes without selection
+    void applyStyle();
+
+    //! change the color of a palette style and of all its members
+    void editStyle();
+
+    //! draw the unchanged shapes from merged arrays
+    void setStaticBatching(bool theIsOn);
+
+    //! bring the batch up to date after the scene changed
+    void rebuildBatch();
+
+    //! the scene was edited, the batch is out of date
+    void sceneChanged();
+
+    //! show the id of the picked shape
+    void reportSelection();
+
+    //! skip the shapes off screen or below a pixel when drawing
+    void setViewCulling(bool theIsOn);
+
+    //! add a section plane through the middle of the scene
+    void addSectionPlane();
+
+    //! remove the section planes
+    void removeSectionPlanes();
+
+    //! compute the exact sections of the displayed shapes
+    void updateSections();
+
+    //! find the clashing shapes, select them and show the common volumes
+    void checkInterference();
+
+    //! measure the clearance of the selected shapes to their neighbours
+    void checkClearance();
+
+    //! check the selected or displayed shapes and fix the invalid ones
+    void checkAndHeal();
+
+    //! show the counters of the last culled redraw
+    void reportCulling(int theDrawn, int theOutside, int theSmall);
+
+    //! record the mouse and wheel events of the view, save them when stopped
+    void recordInput(bool theIsOn);
+
+    //! replay a recorded input trace and show its timings
+    void replayInput();
+
+    //! the replay is done
+    void reportReplay();
+
     //! Delete Box
     void deleteBox();
     void modifyBox();
 
+    //! change the height of the boxes under the fillet and the chamfer
+    void editFeatureBox();
+
     //! Delete Cone
     void deleteCone();
     void deleteConeReducer();
@@ -129,6 +279,10 @@ private:
     //! the exit action.
     QAction* mExitAction;
 
+    //! the export actions.
+    QAction* mExportGlbAction;
+    QAction* mExportDrawingAction;
+
     //! the actions for the view: pan, reset, fitall.
     QAction* mViewZoomAction;
     QAction* mViewPanAction;
@@ -167,6 +321,7 @@ private:
     QMenu* mExtrasMenu;
     QMenu* mDeleteMenu;
     QMenu* mModifyMenu;
+    QMenu* mEditMenu;
 
     //! find actions
     QAction* mSelectEdges;
@@ -179,6 +334,60 @@ private:
     QToolBar* mHelpToolBar;
 
     QMap<unsigned int, Handle(AIS_Shape)> mapIntShapes;
+
+    //! placements of shared prototypes.
+    QMap<unsigned int, Handle(AIS_ConnectedInteractive)> mapIntInstances;
+
+    //! triangulations persisted between runs.
+    MeshCache mMeshCache;
+
+    //! shared prototypes for repeated parts.
+    InstanceLibrary* mInstances;
+
+    //! builds the selection of displayed shapes when they are first picked.
+    SelectionActivator* mSelectionActivator;
+
+    //! named styles shared by the displayed objects.
+    StylePalette* mStyles;
+
+    //! the merged unchanged shapes, null when batching is off.
+    Handle_StaticBatch mBatch;
+    QAction* mBatchAction;
+
+    //! the displayed shapes kept out of the batch while they are selected.
+    QSet<unsigned int> mUnbatched;
+
+    //! the common volumes or closest points shown by the last check.
+    QList<Handle_AIS_Shape> mMarkers;
+
+    //! computes and caches the mass properties shown in the panel.
+    MassProperties mMassProperties;
+    PropertiesPanel* mPropertiesPanel;
+    unsigned int mPropertiesId;
+
+    //! keeps the boxes of the shapes between clearance reports.
+    ClearanceQuery mClearance;
+
+    //! movable section planes of the view.
+    SectionPlanes* mSections;
+
+    //! drawn and culled counts of the view.
+    QLabel* mCullingLabel;
+
+    //! input recording and replay of the view.
+    InputTrace mInputTrace;
+    InputReplay* mInputReplay;
+    QAction* mRecordInputAction;
+    bool mShowReplayReport;
+
+    //! how the modeled shapes were built.
+    FeatureGraph mFeatures;
+
+    //! the feature node producing the shape displayed under an id.
+    QMap<unsigned int, FeatureGraph::NodeId> mapIntFeatures;
+
+    //! history of the scene edits.
+    QUndoStack* mUndoStack;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,745 @@
+#include "analyticmesher.h"
+#include "topologyindex.h"
+
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+
+#include <TopoDS.hxx>
+#include <TopoDS_Edge.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopoDS_Wire.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopLoc_Location.hxx>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <BRepTools.hxx>
+#include <BRepTools_WireExplorer.hxx>
+#include <ElSLib.hxx>
+#include <Geom2d_Curve.hxx>
+#include <Geom2dAdaptor_Curve.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
+#include <TColStd_Array1OfInteger.hxx>
+#include <TColStd_Array1OfReal.hxx>
+#include <TShort_HArray1OfShortReal.hxx>
+#include <gp_Pln.hxx>
+
+namespace
+{
+    //! segments of a circular arc within the chordal and the angular deflection.
+    int arcSegments(const Standard_Real theRadius, const Standard_Real theSpan,
+                    const Standard_Real theDeflection, const Standard_Real theAngle)
+    {
+        Standard_Real aStep = theAngle;
+
+        if (theRadius > theDeflection)
+        {
+            aStep = Min(aStep, 2.0 * ACos(1.0 - theDeflection / theRadius));
+        }
+
+        // a closed ring needs at least a triangle.
+        return Max(int(std::ceil(theSpan / aStep - 1.0e-9)), theSpan > M_PI ? 3 : 1);
+    }
+
+    bool isNear(const Standard_Real theValue, const Standard_Real theTarget)
+    {
+        return Abs(theValue - theTarget) <= 1.0e-7 * (1.0 + Abs(theTarget));
+    }
+
+    //! a surface of revolution around the Z direction of its position:
+    //! P(u, v) = C + h(v) Z + rho(v) (cos u X + sin u Y), N = a(v) (cos u X + sin u Y) + b(v) Z.
+    struct Revolution
+    {
+        GeomAbs_SurfaceType type;
+        gp_Ax3 position;
+
+        //! the radius, the reference radius of a cone or the major radius of a torus.
+        Standard_Real radius;
+        Standard_Real minorRadius;
+        Standard_Real semiAngle;
+
+        void ring(const Standard_Real theV, Standard_Real& theRho, Standard_Real& theH,
+                  Standard_Real& theA, Standard_Real& theB) const
+        {
+            switch (type)
+            {
+            case GeomAbs_Sphere:
+                theRho = radius * Cos(theV);
+                theH = radius * Sin(theV);
+                theA = Cos(theV);
+                theB = Sin(theV);
+                break;
+            case GeomAbs_Cylinder:
+                theRho = radius;
+                theH = theV;
+                theA = 1.0;
+                theB = 0.0;
+                break;
+            case GeomAbs_Cone:
+                theRho = radius + theV * Sin(semiAngle);
+                theH = theV * Cos(semiAngle);
+                theA = Cos(semiAngle);
+                theB = -Sin(semiAngle);
+                break;
+            default:
+                theRho = radius + minorRadius * Cos(theV);
+                theH = minorRadius * Sin(theV);
+                theA = Cos(theV);
+                theB = Sin(theV);
+                break;
+            }
+        }
+
+        //! the radius of the v iso curves, 0 when they are straight.
+        Standard_Real meridianRadius() const
+        {
+            return type == GeomAbs_Sphere ? radius : (type == GeomAbs_Torus ? minorRadius : 0.0);
+        }
+    };
+
+    bool revolutionOf(const BRepAdaptor_Surface& theSurface, Revolution& theRevolution)
+    {
+        theRevolution.type = theSurface.GetType();
+        theRevolution.minorRadius = 0.0;
+        theRevolution.semiAngle = 0.0;
+
+        switch (theRevolution.type)
+        {
+        case GeomAbs_Sphere:
+            theRevolution.position = theSurface.Sphere().Position();
+            theRevolution.radius = theSurface.Sphere().Radius();
+            return true;
+        case GeomAbs_Cylinder:
+            theRevolution.position = theSurface.Cylinder().Position();
+            theRevolution.radius = theSurface.Cylinder().Radius();
+            return true;
+        case GeomAbs_Cone:
+            theRevolution.position = theSurface.Cone().Position();
+            theRevolution.radius = theSurface.Cone().RefRadius();
+            theRevolution.semiAngle = theSurface.Cone().SemiAngle();
+            return true;
+        case GeomAbs_Torus:
+            theRevolution.position = theSurface.Torus().Position();
+            theRevolution.radius = theSurface.Torus().MajorRadius();
+            theRevolution.minorRadius = theSurface.Torus().MinorRadius();
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    struct EdgePolygon
+    {
+        TopoDS_Edge edge;
+
+        //! the polygon of the forward edge and, on a seam, the one of the reversed edge.
+        Handle_Poly_PolygonOnTriangulation polygons[2];
+    };
+
+    struct FaceMesh
+    {
+        TopoDS_Face face;
+        Handle_Poly_Triangulation triangulation;
+        QList<EdgePolygon> polygons;
+    };
+
+    //! the polygon of the nodes sorted by their edge parameter.
+    Handle_Poly_PolygonOnTriangulation makePolygon(QVector<QPair<Standard_Real, int> > theNodes, const Standard_Real theDeflection)
+    {
+        std::sort(theNodes.begin(), theNodes.end());
+
+        TColStd_Array1OfInteger aNodes(1, theNodes.size());
+        TColStd_Array1OfReal aParameters(1, theNodes.size());
+
+        for (int i = 0; i < theNodes.size(); ++i)
+        {
+            aParameters(i + 1) = theNodes.at(i).first;
+            aNodes(i + 1) = theNodes.at(i).second;
+        }
+
+        Handle_Poly_PolygonOnTriangulation aPolygon = new Poly_PolygonOnTriangulation(aNodes, aParameters);
+        aPolygon->Deflection(theDeflection);
+
+        return aPolygon;
+    }
+
+    void addPolygon(QList<EdgePolygon>& thePolygons, const TopoDS_Edge& theEdge, const Handle_Poly_PolygonOnTriangulation& thePolygon)
+    {
+        const int aSlot = theEdge.Orientation() == TopAbs_REVERSED ? 1 : 0;
+
+        for (int i = 0; i < thePolygons.size(); ++i)
+        {
+            if (thePolygons.at(i).edge.IsSame(theEdge))
+            {
+                thePolygons[i].polygons[aSlot] = thePolygon;
+                return;
+            }
+        }
+
+        EdgePolygon aPolygon;
+        aPolygon.edge = TopoDS::Edge(theEdge.Oriented(TopAbs_FORWARD));
+        aPolygon.polygons[aSlot] = thePolygon;
+
+        thePolygons.append(aPolygon);
+    }
+
+    //! the first face of an edge fixes its parameters, the other faces must agree.
+    bool shareParameters(QVector<Standard_Real>& theShared, const QVector<Standard_Real>& theParameters)
+    {
+        if (theShared.isEmpty())
+        {
+            theShared = theParameters;
+            return true;
+        }
+
+        if (theShared.size() != theParameters.size())
+        {
+            return false;
+        }
+
+        for (int i = 0; i < theShared.size(); ++i)
+        {
+            if (!isNear(theParameters.at(i), theShared.at(i)))
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    //! mesh a face of a surface of revolution whose edges lie on its UV bounds.
+    bool meshGrid(const TopoDS_Face& theFace, Revolution theSurface, const TopTools_IndexedMapOfShape& theEdges,
+                  const Standard_Real theDeflection, const Standard_Real theAngle,
+                  QVector<QVector<Standard_Real> >& theEdgeParameters, FaceMesh& theMesh)
+    {
+        Standard_Real aUmin, aUmax, aVmin, aVmax;
+        BRepTools::UVBounds(theFace, aUmin, aUmax, aVmin, aVmax);
+
+        if (aUmax - aUmin < Precision::PConfusion() || aVmax - aVmin < Precision::PConfusion())
+        {
+            return false;
+        }
+
+        // the columns follow the widest ring.
+        Standard_Real aRho, aH, anA, aB;
+        Standard_Real aWidest = 0.0;
+        const Standard_Real aRingVs[3] = { aVmin, aVmax, Max(aVmin, Min(aVmax, 0.0)) };
+
+        for (int k = 0; k < 3; ++k)
+        {
+            theSurface.ring(aRingVs[k], aRho, aH, anA, aB);
+            aWidest = Max(aWidest, Abs(aRho));
+        }
+
+        const int aNu = arcSegments(aWidest, aUmax - aUmin, theDeflection, theAngle);
+        const int aNv = theSurface.meridianRadius() > 0.0
+                ? arcSegments(theSurface.meridianRadius(), aVmax - aVmin, theDeflection, theAngle) : 1;
+        const Standard_Real aDu = (aUmax - aUmin) / aNu;
+        const Standard_Real aDv = (aVmax - aVmin) / aNv;
+
+        QVector<bool> aCollapsedRows(aNv + 1, false);
+        QVector<bool> aCollapsedColumns(aNu + 1, false);
+
+        // every edge must be a whole side of the UV rectangle.
+        for (TopExp_Explorer anExp(theFace, TopAbs_EDGE); anExp.More(); anExp.Next())
+        {
+            const TopoDS_Edge& anEdge = TopoDS::Edge(anExp.Current());
+
+            Standard_Real aFirst, aLast;
+            Handle_Geom2d_Curve aPCurve = BRep_Tool::CurveOnSurface(anEdge, theFace, aFirst, aLast);
+
+            if (aPCurve.IsNull())
+            {
+                return false;
+            }
+
+            Geom2dAdaptor_Curve aCurve(aPCurve);
+
+            if (aCurve.GetType() != GeomAbs_Line)
+            {
+                return false;
+            }
+
+            const gp_Lin2d aLine = aCurve.Line();
+            const gp_Pnt2d anOrigin = aLine.Location();
+            const gp_Dir2d aDirection = aLine.Direction();
+
+            // a row runs along u at a fixed v, a column along v at a fixed u.
+            const bool isRow = Abs(aDirection.Y()) < Precision::Angular();
+
+            if (!isRow && Abs(aDirection.X()) >= Precision::Angular())
+            {
+                return false;
+            }
+
+            const gp_Pnt2d aStart = aCurve.Value(aFirst);
+            const Standard_Real aFixed = isRow ? aStart.Y() : aStart.X();
+            const Standard_Real aLow = isRow ? aVmin : aUmin;
+            const Standard_Real aHigh = isRow ? aVmax : aUmax;
+            const int aLineCount = isRow ? aNv : aNu;
+
+            int aLineIndex = -1;
+
+            if (isNear(aFixed, aLow))
+            {
+                aLineIndex = 0;
+            }
+            else if (isNear(aFixed, aHigh))
+            {
+                aLineIndex = aLineCount;
+            }
+            else
+            {
+                return false;
+            }
+
+            const int aCount = isRow ? aNu : aNv;
+            QVector<QPair<Standard_Real, int> > aNodes(aCount + 1);
+
+            for (int k = 0; k <= aCount; ++k)
+            {
+                const Standard_Real aT = isRow ? (aUmin + k * aDu - anOrigin.X()) / aDirection.X()
+                                               : (aVmin + k * aDv - anOrigin.Y()) / aDirection.Y();
+                const int aNode = isRow ? aLineIndex * (aNu + 1) + k + 1 : k * (aNu + 1) + aLineIndex + 1;
+
+                aNodes[k] = qMakePair(aT, aNode);
+            }
+
+            std::sort(aNodes.begin(), aNodes.end());
+
+            if (!isNear(aNodes.first().first, aFirst) || !isNear(aNodes.last().first, aLast))
+            {
+                return false;
+            }
+
+            if (BRep_Tool::Degenerated(anEdge))
+            {
+                (isRow ? aCollapsedRows : aCollapsedColumns)[aLineIndex] = true;
+            }
+            else
+            {
+                const int anIndex = theEdges.FindIndex(anEdge);
+                QVector<Standard_Real> aParameters(aNodes.size());
+
+                for (int k = 0; k < aNodes.size(); ++k)
+                {
+                    aParameters[k] = aNodes.at(k).first;
+                }
+
+                if (anIndex == 0 || !shareParameters(theEdgeParameters[anIndex], aParameters))
+                {
+                    return false;
+                }
+            }
+
+            addPolygon(theMesh.polygons, anEdge, makePolygon(aNodes, theDeflection));
+        }
+
+        // the triangles touching a pole or an apex would have no area.
+        int aTriangleCount = 0;
+
+        for (int j = 0; j < aNv; ++j)
+        {
+            for (int i = 0; i < aNu; ++i)
+            {
+                aTriangleCount += (!aCollapsedRows.at(j) && !aCollapsedColumns.at(i + 1)) ? 1 : 0;
+                aTriangleCount += (!aCollapsedRows.at(j + 1) && !aCollapsedColumns.at(i)) ? 1 : 0;
+            }
+        }
+
+        if (aTriangleCount == 0)
+        {
+            return false;
+        }
+
+        // the triangulation lives in the frame of the face location.
+        if (!theFace.Location().IsIdentity())
+        {
+            theSurface.position.Transform(theFace.Location().Transformation().Inverted());
+        }
+
+        const int aNodeCount = (aNu + 1) * (aNv + 1);
+
+        Handle_Poly_Triangulation aTriangulation = new Poly_Triangulation(aNodeCount, aTriangleCount, Standard_True);
+        aTriangulation->Deflection(theDeflection);
+
+        TColgp_Array1OfPnt& aNodes = aTriangulation->ChangeNodes();
+        TColgp_Array1OfPnt2d& anUVNodes = aTriangulation->ChangeUVNodes();
+        Poly_Array1OfTriangle& aTriangles = aTriangulation->ChangeTriangles();
+
+        Handle_TShort_HArray1OfShortReal aNormalArray = new TShort_HArray1OfShortReal(1, 3 * aNodeCount);
+        TShort_Array1OfShortReal& aNormals = aNormalArray->ChangeArray1();
+
+        const gp_XYZ aCenter = theSurface.position.Location().XYZ();
+        const gp_XYZ aX = theSurface.position.XDirection().XYZ();
+        const gp_XYZ aY = theSurface.position.YDirection().XYZ();
+        const gp_XYZ aZ = theSurface.position.Direction().XYZ();
+
+        // D1U ^ D1V turns with the handedness of the position.
+        const Standard_Real aSign = theSurface.position.Direct() ? 1.0 : -1.0;
+
+        // one sine and cosine per column, the rings only scale and lift them.
+        QVector<gp_XYZ> aRadials(aNu + 1);
+
+        for (int i = 0; i <= aNu; ++i)
+        {
+            const Standard_Real anU = aUmin + i * aDu;
+            aRadials[i] = aX * Cos(anU) + aY * Sin(anU);
+        }
+
+        const gp_XYZ* aRadial = aRadials.constData();
+
+        for (int j = 0; j <= aNv; ++j)
+        {
+            const Standard_Real aV = aVmin + j * aDv;
+            theSurface.ring(aV, aRho, aH, anA, aB);
+
+            const gp_XYZ aRingCenter = aCenter + aZ * aH;
+            const gp_XYZ aLift = aZ * (aSign * aB);
+            const Standard_Real aScale = aSign * anA;
+            const int aRow = j * (aNu + 1);
+
+            for (int i = 0; i <= aNu; ++i)
+            {
+                const int aNode = aRow + i + 1;
+                const gp_XYZ aNormal = aRadial[i] * aScale + aLift;
+
+                aNodes(aNode).SetXYZ(aRingCenter + aRadial[i] * aRho);
+                anUVNodes(aNode).SetCoord(aUmin + i * aDu, aV);
+
+                aNormals(3 * aNode - 2) = Standard_ShortReal(aNormal.X());
+                aNormals(3 * aNode - 1) = Standard_ShortReal(aNormal.Y());
+                aNormals(3 * aNode)     = Standard_ShortReal(aNormal.Z());
+            }
+        }
+
+        // counter-clockwise in UV, the face orientation is applied by the presentation.
+        int aTriangle = 0;
+
+        for (int j = 0; j < aNv; ++j)
+        {
+            for (int i = 0; i < aNu; ++i)
+            {
+                const int aN00 = j * (aNu + 1) + i + 1;
+                const int aN10 = aN00 + 1;
+                const int aN01 = aN00 + aNu + 1;
+                const int aN11 = aN01 + 1;
+
+                if (!aCollapsedRows.at(j) && !aCollapsedColumns.at(i + 1))
+                {
+                    aTriangles(++aTriangle).Set(aN00, aN10, aN11);
+                }
+
+                if (!aCollapsedRows.at(j + 1) && !aCollapsedColumns.at(i))
+                {
+                    aTriangles(++aTriangle).Set(aN00, aN11, aN01);
+                }
+            }
+        }
+
+        aTriangulation->SetNormals(aNormalArray);
+
+        theMesh.face = theFace;
+        theMesh.triangulation = aTriangulation;
+
+        return true;
+    }
+
+    //! mesh a planar face with one boundary as a fan from the mean of its boundary.
+    bool meshPlane(const TopoDS_Face& theFace, const gp_Pln& thePlane, const TopTools_IndexedMapOfShape& theEdges,
+                   const Standard_Real theDeflection, const Standard_Real theAngle,
+                   QVector<QVector<Standard_Real> >& theEdgeParameters, FaceMesh& theMesh)
+    {
+        TopExp_Explorer aWires(theFace, TopAbs_WIRE);
+
+        if (!aWires.More())
+        {
+            return false;
+        }
+
+        aWires.Next();
+
+        if (aWires.More())
+        {
+            return false;
+        }
+
+        const bool isLocated = !theFace.Location().IsIdentity();
+        const gp_Trsf aToFace = theFace.Location().Transformation().Inverted();
+        const gp_Pln aPlane = isLocated ? thePlane.Transformed(aToFace) : thePlane;
+
+        struct Run
+        {
+            TopoDS_Edge edge;
+            QVector<Standard_Real> parameters;
+            int start;
+            bool isReversed;
+        };
+
+        QVector<gp_Pnt> aPoints;
+        QVector<gp_Pnt2d> anUVs;
+        QList<Run> aRuns;
+
+        for (BRepTools_WireExplorer anExp(BRepTools::OuterWire(theFace), theFace); anExp.More(); anExp.Next())
+        {
+            const TopoDS_Edge& anEdge = anExp.Current();
+            const int anIndex = theEdges.FindIndex(anEdge);
+
+            if (anIndex == 0 || BRep_Tool::Degenerated(anEdge) || BRep_Tool::IsClosed(anEdge, theFace))
+            {
+                return false;
+            }
+
+            BRepAdaptor_Curve aCurve(anEdge);
+            QVector<Standard_Real>& aParameters = theEdgeParameters[anIndex];
+
+            // an edge between planes only: split it as a grid would.
+            if (aParameters.isEmpty())
+            {
+                const Standard_Real aFirst = aCurve.FirstParameter();
+                const Standard_Real aLast = aCurve.LastParameter();
+                int aCount = 1;
+
+                if (aCurve.GetType() == GeomAbs_Circle)
+                {
+                    aCount = arcSegments(aCurve.Circle().Radius(), aLast - aFirst, theDeflection, theAngle);
+                }
+                else if (aCurve.GetType() != GeomAbs_Line)
+                {
+                    return false;
+                }
+
+                for (int k = 0; k <= aCount; ++k)
+                {
+                    aParameters.append(aFirst + k * (aLast - aFirst) / aCount);
+                }
+            }
+
+            Run aRun;
+            aRun.edge = anEdge;
+            aRun.parameters = aParameters;
+            aRun.start = aPoints.size();
+            aRun.isReversed = anEdge.Orientation() == TopAbs_REVERSED;
+
+            // the last point of an edge is the first one of the next edge.
+            const int aCount = aParameters.size();
+
+            for (int k = 0; k < aCount - 1; ++k)
+            {
+                gp_Pnt aPoint = aCurve.Value(aParameters.at(aRun.isReversed ? aCount - 1 - k : k));
+
+                if (isLocated)
+                {
+                    aPoint.Transform(aToFace);
+                }
+
+                Standard_Real anU, aV;
+                ElSLib::Parameters(aPlane, aPoint, anU, aV);
+
+                aPoints.append(aPoint);
+                anUVs.append(gp_Pnt2d(anU, aV));
+            }
+
+            aRuns.append(aRun);
+        }
+
+        const int aCount = aPoints.size();
+
+        if (aCount < 3)
+        {
+            return false;
+        }
+
+        gp_XYZ aMean(0.0, 0.0, 0.0);
+        gp_XY anUVMean(0.0, 0.0);
+        Standard_Real anArea = 0.0;
+
+        for (int i = 0; i < aCount; ++i)
+        {
+            aMean += aPoints.at(i).XYZ();
+            anUVMean += anUVs.at(i).XY();
+            anArea += anUVs.at(i).XY() ^ anUVs.at((i + 1) % aCount).XY();
+        }
+
+        aMean /= aCount;
+        anUVMean /= aCount;
+
+        if (Abs(anArea) < Precision::SquareConfusion())
+        {
+            return false;
+        }
+
+        // the fan is only valid if every triangle turns like the boundary.
+        const Standard_Real aTurn = anArea > 0.0 ? 1.0 : -1.0;
+
+        for (int i = 0; i < aCount; ++i)
+        {
+            const Standard_Real aCross = (anUVs.at(i).XY() - anUVMean) ^ (anUVs.at((i + 1) % aCount).XY() - anUVMean);
+
+            if (aCross * aTurn <= 1.0e-9 * Abs(anArea))
+            {
+                return false;
+            }
+        }
+
+        Handle_Poly_Triangulation aTriangulation = new Poly_Triangulation(aCount + 1, aCount, Standard_True);
+        aTriangulation->Deflection(theDeflection);
+
+        TColgp_Array1OfPnt& aNodes = aTriangulation->ChangeNodes();
+        TColgp_Array1OfPnt2d& anUVNodes = aTriangulation->ChangeUVNodes();
+        Poly_Array1OfTriangle& aTriangles = aTriangulation->ChangeTriangles();
+
+        Handle_TShort_HArray1OfShortReal aNormalArray = new TShort_HArray1OfShortReal(1, 3 * (aCount + 1));
+        TShort_Array1OfShortReal& aNormals = aNormalArray->ChangeArray1();
+
+        const gp_Dir aNormal = aPlane.Position().XDirection().Crossed(aPlane.Position().YDirection());
+        const int aCenter = aCount + 1;
+
+        for (int i = 1; i <= aCount + 1; ++i)
+        {
+            aNodes(i) = i == aCenter ? gp_Pnt(aMean) : aPoints.at(i - 1);
+            anUVNodes(i) = i == aCenter ? gp_Pnt2d(anUVMean) : anUVs.at(i - 1);
+
+            aNormals(3 * i - 2) = Standard_ShortReal(aNormal.X());
+            aNormals(3 * i - 1) = Standard_ShortReal(aNormal.Y());
+            aNormals(3 * i)     = Standard_ShortReal(aNormal.Z());
+        }
+
+        for (int i = 1; i <= aCount; ++i)
+        {
+            const int aNext = i % aCount + 1;
+
+            if (aTurn > 0.0)
+            {
+                aTriangles(i).Set(aCenter, i, aNext);
+            }
+            else
+            {
+                aTriangles(i).Set(aCenter, aNext, i);
+            }
+        }
+
+        aTriangulation->SetNormals(aNormalArray);
+
+        foreach (const Run& aRun, aRuns)
+        {
+            const int aRunCount = aRun.parameters.size();
+            QVector<QPair<Standard_Real, int> > aRunNodes(aRunCount);
+
+            for (int k = 0; k < aRunCount; ++k)
+            {
+                const Standard_Real aT = aRun.parameters.at(aRun.isReversed ? aRunCount - 1 - k : k);
+                aRunNodes[k] = qMakePair(aT, (aRun.start + k) % aCount + 1);
+            }
+
+            addPolygon(theMesh.polygons, aRun.edge, makePolygon(aRunNodes, theDeflection));
+        }
+
+        theMesh.face = theFace;
+        theMesh.triangulation = aTriangulation;
+
+        return true;
+    }
+}
+
+bool AnalyticMesher::perform(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle,
+                             int* theFaceCount)
+{
+    if (theFaceCount)
+    {
+        *theFaceCount = 0;
+    }
+
+    if (theShape.IsNull() || theDeflection <= 0.0)
+    {
+        return false;
+    }
+
+    if (BRepTools::Triangulation(theShape, theDeflection))
+    {
+        return true;
+    }
+
+    QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(theShape);
+    const TopTools_IndexedMapOfShape& aFaces = anIndex->faces();
+    const TopTools_IndexedMapOfShape& anEdges = anIndex->edges();
+
+    if (aFaces.IsEmpty())
+    {
+        return false;
+    }
+
+    // the grids fix the discretization of their edges, the planes follow it.
+    QVector<QVector<Standard_Real> > anEdgeParameters(anEdges.Extent() + 1);
+    QVector<FaceMesh> aMeshes(aFaces.Extent());
+    QList<int> aPlanes;
+
+    for (Standard_Integer i = 1; i <= aFaces.Extent(); ++i)
+    {
+        const TopoDS_Face& aFace = TopoDS::Face(aFaces(i));
+        BRepAdaptor_Surface aSurface(aFace, Standard_False);
+
+        if (aSurface.GetType() == GeomAbs_Plane)
+        {
+            aPlanes.append(i);
+            continue;
+        }
+
+        Revolution aRevolution;
+
+        if (!revolutionOf(aSurface, aRevolution)
+         || !meshGrid(aFace, aRevolution, anEdges, theDeflection, theAngle, anEdgeParameters, aMeshes[i - 1]))
+        {
+            return false;
+        }
+    }
+
+    foreach (int i, aPlanes)
+    {
+        const TopoDS_Face& aFace = TopoDS::Face(aFaces(i));
+        BRepAdaptor_Surface aSurface(aFace, Standard_False);
+
+        if (!meshPlane(aFace, aSurface.Plane(), anEdges, theDeflection, theAngle, anEdgeParameters, aMeshes[i - 1]))
+        {
+            return false;
+        }
+    }
+
+    // attached once every face is done, a failure leaves the shape as it was.
+    BRep_Builder aBuilder;
+
+    foreach (const FaceMesh& aMesh, aMeshes)
+    {
+        const TopLoc_Location& aLocation = aMesh.face.Location();
+
+        aBuilder.UpdateFace(aMesh.face, aMesh.triangulation);
+
+        foreach (const EdgePolygon& aPolygon, aMesh.polygons)
+        {
+            if (!aPolygon.polygons[0].IsNull() && !aPolygon.polygons[1].IsNull())
+            {
+                aBuilder.UpdateEdge(aPolygon.edge, aPolygon.polygons[0], aPolygon.polygons[1], aMesh.triangulation, aLocation);
+            }
+            else
+            {
+                aBuilder.UpdateEdge(aPolygon.edge, aPolygon.polygons[aPolygon.polygons[0].IsNull() ? 1 : 0], aMesh.triangulation, aLocation);
+            }
+        }
+    }
+
+    if (theFaceCount)
+    {
+        *theFaceCount = aMeshes.size();
+    }
+
+    return true;
+}
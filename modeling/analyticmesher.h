@@ -0,0 +1,25 @@
+#ifndef ANALYTICMESHER_H
+#define ANALYTICMESHER_H
+
+#include <TopoDS_Shape.hxx>
+
+//! Closed-form triangulation of the faces made by the primitives.
+//! Spheres, cylinders, cones and tori are surfaces of revolution, so a face
+//! bounded by iso-parametric edges is meshed as a regular UV grid: one sine
+//! and cosine per column, then each node and normal is a ring center plus a
+//! radius times the column direction. Planar faces are fanned from a point
+//! that sees their whole boundary. Shared edges get one discretization and
+//! their polygons on the triangulations, as BRepMesh would leave them.
+//!
+//! A shape with any other face is left alone for BRepMesh.
+class AnalyticMesher
+{
+public:
+    //! triangulate theShape, false with the shape unchanged when a face is not supported.
+    //! theFaceCount receives the number of faces meshed here, 0 when the shape already had a mesh.
+    //! The triangulations are written into the faces, every shape on the same TShapes sees them.
+    static bool perform(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle = 0.5,
+                        int* theFaceCount = 0);
+};
+
+#endif // ANALYTICMESHER_H
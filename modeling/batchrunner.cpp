@@ -0,0 +1,644 @@
+#include "batchrunner.h"
+#include "shapefactory.h"
+#include "gltfexporter.h"
+#include "drawingexporter.h"
+#include "shapehealer.h"
+#include "shapeexchange.h"
+#include "toolkitplugins.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegExp>
+#include <QTextStream>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+#include <gp_Ax2.hxx>
+#include <gp.hxx>
+
+#include <BRep_Builder.hxx>
+#include <BRepTools.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace
+{
+    //! the data exchange writers share global parameters, one export at a time.
+    QMutex THE_EXPORT_MUTEX;
+
+    //! inputs and numeric arguments of each modeling command.
+    struct Syntax
+    {
+        const char* command;
+        int inputs;
+        int numbers;
+        int optionalNumbers;
+        bool hasPlacement;
+    };
+
+    const Syntax THE_SYNTAX[] = {
+        { "box",       0, 3, 0, true  },
+        { "cone",      0, 3, 0, true  },
+        { "sphere",    0, 1, 0, true  },
+        { "cylinder",  0, 2, 1, true  },
+        { "torus",     0, 2, 1, true  },
+        { "fillet",    1, 1, 0, false },
+        { "chamfer",   1, 1, 0, false },
+        { "cut",       2, 0, 0, false },
+        { "fuse",      2, 0, 0, false },
+        { "common",    2, 0, 0, false },
+        { "translate", 1, 3, 0, false },
+        { "heal",      1, 0, 1, false }
+    };
+
+    const Syntax* findSyntax(const QString& theCommand)
+    {
+        for (size_t i = 0; i < sizeof(THE_SYNTAX) / sizeof(THE_SYNTAX[0]); ++i)
+        {
+            if (theCommand == THE_SYNTAX[i].command)
+            {
+                return &THE_SYNTAX[i];
+            }
+        }
+
+        return 0;
+    }
+
+    Standard_Real number(const QStringList& theArguments, const int theIndex)
+    {
+        return theArguments.at(theIndex).toDouble();
+    }
+}
+
+BatchRunner::BatchRunner()
+    : mWaveCount(0),
+      mWallTime(0)
+{
+}
+
+bool BatchRunner::load(const QString& theFileName)
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        mError = QString("%1: %2").arg(theFileName, aFile.errorString());
+        return false;
+    }
+
+    QStringList aLines;
+    QTextStream aStream(&aFile);
+
+    while (!aStream.atEnd())
+    {
+        aLines.append(aStream.readLine());
+    }
+
+    return parse(aLines);
+}
+
+bool BatchRunner::parse(const QStringList& theLines)
+{
+    mJobs.clear();
+    mJobByName.clear();
+
+    for (int i = 0; i < theLines.size(); ++i)
+    {
+        QString aText = theLines.at(i);
+        aText = aText.left(aText.indexOf('#')).trimmed();
+
+        if (aText.isEmpty())
+        {
+            continue;
+        }
+
+        if (!parseLine(i + 1, aText))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BatchRunner::parseLine(const int theLine, const QString& theText)
+{
+    QStringList aTokens = theText.split(QRegExp("\\s+"), QString::SkipEmptyParts);
+
+    Job aJob;
+    aJob.line = theLine;
+    aJob.command = aTokens.takeFirst().toLower();
+    aJob.wave = 0;
+    aJob.time = 0;
+
+    const QString aPrefix = QString("line %1: ").arg(theLine);
+
+    if (aJob.command == "export" || aJob.command == "drawing")
+    {
+        if (aJob.command == "export" ? aTokens.size() != 2 : aTokens.size() < 2)
+        {
+            mError = aPrefix + QString("%1 needs an input and a file name").arg(aJob.command);
+            return false;
+        }
+
+        for (int i = 2; i < aTokens.size(); ++i)
+        {
+            DrawingExporter::View aView;
+
+            if (!DrawingExporter::viewFromName(aTokens.at(i), aView))
+            {
+                mError = aPrefix + QString("unknown view '%1'").arg(aTokens.at(i));
+                return false;
+            }
+        }
+
+        if (aTokens.at(0) == "*" && aTokens.at(1).contains("%1"))
+        {
+            // one job per shape defined so far, named after it.
+            const int aDefined = mJobs.size();
+
+            for (int i = 0; i < aDefined; ++i)
+            {
+                if (!mJobs.at(i).name.isEmpty())
+                {
+                    Job aShapeJob = aJob;
+                    aShapeJob.inputs.append(i);
+                    aShapeJob.arguments = aTokens.mid(1);
+                    aShapeJob.arguments[0] = aTokens.at(1).arg(mJobs.at(i).name);
+                    aShapeJob.wave = mJobs.at(i).wave + 1;
+
+                    mJobs.append(aShapeJob);
+                }
+            }
+
+            return true;
+        }
+
+        if (aTokens.at(0) == "*")
+        {
+            // everything defined so far.
+            for (int i = 0; i < mJobs.size(); ++i)
+            {
+                if (!mJobs.at(i).name.isEmpty())
+                {
+                    aJob.inputs.append(i);
+                }
+            }
+        }
+        else if (mJobByName.contains(aTokens.at(0)))
+        {
+            aJob.inputs.append(mJobByName.value(aTokens.at(0)));
+        }
+        else
+        {
+            mError = aPrefix + QString("unknown shape '%1'").arg(aTokens.at(0));
+            return false;
+        }
+
+        aJob.arguments = aTokens.mid(1);
+    }
+    else
+    {
+        const Syntax* aSyntax = findSyntax(aJob.command);
+
+        if (aSyntax == 0)
+        {
+            mError = aPrefix + QString("unknown command '%1'").arg(aJob.command);
+            return false;
+        }
+
+        if (aTokens.isEmpty())
+        {
+            mError = aPrefix + "missing result name";
+            return false;
+        }
+
+        aJob.name = aTokens.takeFirst();
+
+        if (mJobByName.contains(aJob.name))
+        {
+            mError = aPrefix + QString("'%1' is already defined").arg(aJob.name);
+            return false;
+        }
+
+        for (int i = 0; i < aSyntax->inputs; ++i)
+        {
+            if (aTokens.isEmpty() || !mJobByName.contains(aTokens.first()))
+            {
+                mError = aPrefix + QString("%1 needs %2 defined input(s)").arg(aJob.command).arg(aSyntax->inputs);
+                return false;
+            }
+
+            aJob.inputs.append(mJobByName.value(aTokens.takeFirst()));
+        }
+
+        // the optional placement is always "at x y z" at the end of the line.
+        const int anAt = aTokens.indexOf("at");
+        QStringList aPlacement;
+
+        if (anAt >= 0)
+        {
+            aPlacement = aTokens.mid(anAt + 1);
+            aTokens = aTokens.mid(0, anAt);
+
+            if (!aSyntax->hasPlacement || aPlacement.size() != 3)
+            {
+                mError = aPrefix + "bad placement, expected 'at x y z'";
+                return false;
+            }
+        }
+
+        if (aTokens.size() < aSyntax->numbers || aTokens.size() > aSyntax->numbers + aSyntax->optionalNumbers)
+        {
+            mError = aPrefix + QString("%1 needs %2 number(s)").arg(aJob.command).arg(aSyntax->numbers);
+            return false;
+        }
+
+        // missing angles default to a full turn, the placement always comes last.
+        aJob.arguments = aTokens;
+
+        while (aSyntax->hasPlacement && aJob.arguments.size() < aSyntax->numbers + aSyntax->optionalNumbers)
+        {
+            aJob.arguments.append("360");
+        }
+
+        if (aSyntax->hasPlacement)
+        {
+            aJob.arguments += aPlacement.isEmpty() ? (QStringList() << "0" << "0" << "0") : aPlacement;
+        }
+
+        foreach (const QString& anArgument, aJob.arguments)
+        {
+            bool isNumber = false;
+            anArgument.toDouble(&isNumber);
+
+            if (!isNumber)
+            {
+                mError = aPrefix + QString("'%1' is not a number").arg(anArgument);
+                return false;
+            }
+        }
+
+        mJobByName.insert(aJob.name, mJobs.size());
+    }
+
+    // a job runs in the wave after the last of its inputs.
+    foreach (int anInput, aJob.inputs)
+    {
+        aJob.wave = qMax(aJob.wave, mJobs.at(anInput).wave + 1);
+    }
+
+    mJobs.append(aJob);
+
+    return true;
+}
+
+int BatchRunner::run()
+{
+    QElapsedTimer aWallTimer;
+    aWallTimer.start();
+
+    QMap<int, QList<int> > aWaves;
+
+    for (int i = 0; i < mJobs.size(); ++i)
+    {
+        aWaves[mJobs.at(i).wave].append(i);
+    }
+
+    mWaveCount = aWaves.size();
+
+    // the lambda only touches its own job, the vector must not detach meanwhile.
+    Job* aJobs = mJobs.data();
+
+    foreach (QList<int> aWave, aWaves)
+    {
+        QtConcurrent::blockingMap(aWave, [this, aJobs](const int theIndex)
+        {
+            execute(aJobs[theIndex]);
+        });
+    }
+
+    mWallTime = aWallTimer.elapsed();
+
+    int aFailures = 0;
+
+    for (int i = 0; i < mJobs.size(); ++i)
+    {
+        if (!mJobs.at(i).error.isEmpty())
+        {
+            ++aFailures;
+        }
+    }
+
+    return aFailures;
+}
+
+void BatchRunner::execute(Job& theJob) const
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    foreach (int anInput, theJob.inputs)
+    {
+        if (!mJobs.at(anInput).error.isEmpty())
+        {
+            theJob.error = QString("input '%1' failed").arg(mJobs.at(anInput).name);
+            return;
+        }
+    }
+
+    const QStringList& anArgs = theJob.arguments;
+    const QString& aCommand = theJob.command;
+
+    try
+    {
+        if (aCommand == "export")
+        {
+            exportShape(inputShape(theJob), anArgs.first(), theJob.error);
+        }
+        else if (aCommand == "drawing")
+        {
+            QList<DrawingExporter::View> aViews;
+
+            for (int i = 1; i < anArgs.size(); ++i)
+            {
+                DrawingExporter::View aView;
+                DrawingExporter::viewFromName(anArgs.at(i), aView);
+                aViews.append(aView);
+            }
+
+            // the views of the sheet are projected in parallel as well.
+            DrawingExporter anExporter;
+
+            if (!aViews.isEmpty())
+            {
+                anExporter.setViews(aViews);
+            }
+
+            anExporter.add(inputShape(theJob));
+
+            if (!anExporter.compute() || !anExporter.write(anArgs.first()))
+            {
+                theJob.error = anExporter.errorString();
+            }
+        }
+        else if (findSyntax(aCommand)->hasPlacement)
+        {
+            const int aLast = anArgs.size() - 3;
+            const gp_Ax2 anAxis(gp_Pnt(number(anArgs, aLast), number(anArgs, aLast + 1), number(anArgs, aLast + 2)), gp::DZ());
+
+            if (aCommand == "box")
+            {
+                theJob.result = ShapeFactory::makeBox(anAxis, number(anArgs, 0), number(anArgs, 1), number(anArgs, 2));
+            }
+            else if (aCommand == "cone")
+            {
+                theJob.result = ShapeFactory::makeCone(anAxis, number(anArgs, 0), number(anArgs, 1), number(anArgs, 2));
+            }
+            else if (aCommand == "sphere")
+            {
+                theJob.result = ShapeFactory::makeSphere(anAxis, number(anArgs, 0));
+            }
+            else if (aCommand == "cylinder")
+            {
+                theJob.result = ShapeFactory::makeCylinder(anAxis, number(anArgs, 0), number(anArgs, 1), number(anArgs, 2) * M_PI / 180.0);
+            }
+            else if (aCommand == "torus")
+            {
+                theJob.result = ShapeFactory::makeTorus(anAxis, number(anArgs, 0), number(anArgs, 1), number(anArgs, 2) * M_PI / 180.0);
+            }
+        }
+        else
+        {
+            const TopoDS_Shape anInput = input(theJob, 0);
+
+            if (aCommand == "fillet")
+            {
+                theJob.result = ShapeFactory::fillet(anInput, number(anArgs, 0));
+            }
+            else if (aCommand == "chamfer")
+            {
+                theJob.result = ShapeFactory::chamfer(anInput, number(anArgs, 0));
+            }
+            else if (aCommand == "translate")
+            {
+                theJob.result = ShapeFactory::translated(anInput, gp_Vec(number(anArgs, 0), number(anArgs, 1), number(anArgs, 2)));
+            }
+            else if (aCommand == "heal")
+            {
+                const ShapeHealer::Report aReport = ShapeHealer::heal(anInput, anArgs.isEmpty() ? 0.0 : number(anArgs, 0));
+
+                theJob.result = aReport.shape;
+
+                if (!aReport.error.isEmpty())
+                {
+                    theJob.error = aReport.error;
+                }
+                else if (!aReport.isValid)
+                {
+                    theJob.error = "still invalid after healing";
+                }
+            }
+            else
+            {
+                const TopoDS_Shape aTool = input(theJob, 1);
+
+                if (aCommand == "cut")
+                {
+                    theJob.result = ShapeFactory::cut(anInput, aTool);
+                }
+                else if (aCommand == "fuse")
+                {
+                    theJob.result = ShapeFactory::fuse(anInput, aTool);
+                }
+                else
+                {
+                    theJob.result = ShapeFactory::common(anInput, aTool);
+                }
+            }
+        }
+
+        if (!theJob.name.isEmpty() && theJob.result.IsNull())
+        {
+            theJob.error = "empty result";
+        }
+    }
+    catch (Standard_Failure)
+    {
+        Handle_Standard_Failure aFailure = Standard_Failure::Caught();
+        theJob.error = QString("OCC failure: %1").arg(aFailure->GetMessageString());
+    }
+
+    theJob.time = aTimer.elapsed();
+}
+
+TopoDS_Shape BatchRunner::input(const Job& theJob, const int theIndex) const
+{
+    return mJobs.at(theJob.inputs.at(theIndex)).result;
+}
+
+TopoDS_Shape BatchRunner::inputShape(const Job& theJob) const
+{
+    if (theJob.inputs.size() == 1)
+    {
+        return input(theJob, 0);
+    }
+
+    TopoDS_Compound aCompound;
+    BRep_Builder aBuilder;
+    aBuilder.MakeCompound(aCompound);
+
+    for (int i = 0; i < theJob.inputs.size(); ++i)
+    {
+        aBuilder.Add(aCompound, input(theJob, i));
+    }
+
+    return aCompound;
+}
+
+bool BatchRunner::exportShape(const TopoDS_Shape& theShape, const QString& theFileName, QString& theError) const
+{
+    QMutexLocker aLocker(&THE_EXPORT_MUTEX);
+
+    const QString aSuffix = QFileInfo(theFileName).suffix().toLower();
+    const QByteArray aFileName = theFileName.toLocal8Bit();
+
+    // the glTF and STL writers mesh the faces, the other jobs of the wave may be reading them.
+    const TopoDS_Shape aShape = (aSuffix == "glb" || aSuffix == "stl") ? ShapeFactory::copied(theShape) : theShape;
+
+    bool isDone = false;
+
+    if (aSuffix == "brep")
+    {
+        isDone = BRepTools::Write(aShape, aFileName.constData());
+    }
+    else if (aSuffix == "glb")
+    {
+        GltfExporter anExporter;
+        anExporter.add(aShape, Quantity_Color(Quantity_NOC_GOLDENROD));
+        isDone = anExporter.write(theFileName);
+    }
+    else
+    {
+        // the data exchange toolkits are only loaded when a job writes such a file.
+        ShapeExchange* anExchange = ToolkitPlugins::exchange(&theError);
+
+        if (anExchange == 0)
+        {
+            return false;
+        }
+
+        if (!anExchange->formats().contains(aSuffix))
+        {
+            theError = QString("unknown export format '%1'").arg(aSuffix);
+            return false;
+        }
+
+        return anExchange->write(aShape, theFileName, theError);
+    }
+
+    if (!isDone)
+    {
+        theError = QString("cannot write %1").arg(theFileName);
+    }
+
+    return isDone;
+}
+
+QString BatchRunner::summary() const
+{
+    struct Timing
+    {
+        Timing() : count(0), total(0), max(0) {}
+        int count;
+        qint64 total;
+        qint64 max;
+    };
+
+    QMap<QString, Timing> aTimings;
+    qint64 aCpuTime = 0;
+    QStringList anErrors;
+
+    for (int i = 0; i < mJobs.size(); ++i)
+    {
+        const Job& aJob = mJobs.at(i);
+        Timing& aTiming = aTimings[aJob.command];
+
+        aTiming.count += 1;
+        aTiming.total += aJob.time;
+        aTiming.max = qMax(aTiming.max, aJob.time);
+        aCpuTime += aJob.time;
+
+        if (!aJob.error.isEmpty())
+        {
+            anErrors.append(QString("line %1 (%2): %3").arg(aJob.line).arg(aJob.command, aJob.error));
+        }
+    }
+
+    QString aSummary;
+    QTextStream aStream(&aSummary);
+
+    aStream << qSetFieldWidth(12) << left << "command" << "count" << "total ms" << "max ms"
+            << qSetFieldWidth(0) << "\n";
+
+    for (QMap<QString, Timing>::const_iterator anIt = aTimings.constBegin(); anIt != aTimings.constEnd(); ++anIt)
+    {
+        aStream << qSetFieldWidth(12) << left << anIt.key() << anIt.value().count
+                << anIt.value().total << anIt.value().max << qSetFieldWidth(0) << "\n";
+    }
+
+    aStream << "\njobs: " << mJobs.size()
+            << ", failed: " << anErrors.size()
+            << ", waves: " << mWaveCount
+            << ", threads: " << QThreadPool::globalInstance()->maxThreadCount()
+            << ", wall: " << mWallTime << " ms"
+            << ", job sum: " << aCpuTime << " ms\n";
+
+    foreach (const QString& anError, anErrors)
+    {
+        aStream << anError << "\n";
+    }
+
+    aStream.flush();
+
+    return aSummary;
+}
+
+QString BatchRunner::errorString() const
+{
+    return mError;
+}
+
+int BatchRunner::jobCount() const
+{
+    return mJobs.size();
+}
+
+TopoDS_Shape BatchRunner::shape(const QString& theName) const
+{
+    if (!mJobByName.contains(theName))
+    {
+        return TopoDS_Shape();
+    }
+
+    return mJobs.at(mJobByName.value(theName)).result;
+}
+
+QStringList BatchRunner::names() const
+{
+    QStringList aNames;
+
+    for (int i = 0; i < mJobs.size(); ++i)
+    {
+        if (!mJobs.at(i).name.isEmpty())
+        {
+            aNames.append(mJobs.at(i).name);
+        }
+    }
+
+    return aNames;
+}
@@ -0,0 +1,97 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <TopoDS_Shape.hxx>
+
+//! Runs a job file of shape constructions, modeling operations and exports
+//! without any viewer. One job per line, '#' starts a comment:
+//!
+//!   box      <name> <dx> <dy> <dz>        [at <x> <y> <z>]
+//!   cone     <name> <r1> <r2> <height>    [at <x> <y> <z>]
+//!   sphere   <name> <radius>              [at <x> <y> <z>]
+//!   cylinder <name> <radius> <height> [<angle deg>] [at <x> <y> <z>]
+//!   torus    <name> <r1> <r2> [<angle deg>]         [at <x> <y> <z>]
+//!   fillet   <name> <input> <radius>
+//!   chamfer  <name> <input> <distance>
+//!   cut|fuse|common <name> <input1> <input2>
+//!   translate <name> <input> <dx> <dy> <dz>
+//!   heal     <name> <input> [<tolerance>]   check, and fix when invalid
+//!   export   <input|*> <file.brep|.step|.iges|.stl|.glb>
+//!   drawing  <input|*> <file.svg|.dxf> [front] [top] [side] [iso]
+//!
+//! A drawing sheet has all four views unless some are listed. With '*' and
+//! a "%1" in the file name every shape gets its own sheet, e.g.
+//! "drawing * sheets/%1.svg", and the sheets are made in parallel.
+//!
+//! STEP, IGES and STL are written by the exchange plugin, which is loaded
+//! by the first job that needs it.
+//!
+//! Jobs only depend on names defined above them. Jobs whose inputs are ready
+//! run together on the global thread pool, wave after wave.
+class BatchRunner
+{
+public:
+    BatchRunner();
+
+    //! read and parse a job file, false on the first syntax error.
+    bool load(const QString& theFileName);
+    bool parse(const QStringList& theLines);
+
+    //! run all the jobs, returns the number of failed jobs.
+    int run();
+
+    //! per command timings, wall time and errors of the last run.
+    QString summary() const;
+
+    QString errorString() const;
+
+    int jobCount() const;
+
+    //! the result of a named job after run().
+    TopoDS_Shape shape(const QString& theName) const;
+
+    //! the result names in the order of the job file.
+    QStringList names() const;
+
+private:
+    struct Job
+    {
+        int line;
+        QString command;
+        QString name;
+        QStringList arguments;
+        QList<int> inputs;
+        int wave;
+        TopoDS_Shape result;
+        qint64 time;
+        QString error;
+    };
+
+    bool parseLine(const int theLine, const QString& theText);
+
+    //! execute a single job, the jobs it depends on are finished.
+    void execute(Job& theJob) const;
+
+    //! the result of the input at theIndex.
+    TopoDS_Shape input(const Job& theJob, const int theIndex) const;
+
+    //! the input of an export, several inputs go into one compound.
+    TopoDS_Shape inputShape(const Job& theJob) const;
+
+    bool exportShape(const TopoDS_Shape& theShape, const QString& theFileName, QString& theError) const;
+
+    QVector<Job> mJobs;
+    QHash<QString, int> mJobByName;
+
+    int mWaveCount;
+    qint64 mWallTime;
+
+    QString mError;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,189 @@
+#include "broadphase.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+
+#include <BRepBndLib.hxx>
+
+namespace
+{
+    //! boxes kept before the oldest are dropped.
+    const int THE_BOX_CACHE_LIMIT = 65536;
+}
+
+BroadPhase::BroadPhase()
+    : mBoxes(THE_BOX_CACHE_LIMIT)
+{
+}
+
+QVector<Bnd_Box> BroadPhase::boxes(const QVector<TopoDS_Shape>& theShapes)
+{
+    QVector<Bnd_Box> aBoxes(theShapes.size());
+    QVector<int> aMissing;
+
+    for (int i = 0; i < theShapes.size(); ++i)
+    {
+        if (!theShapes.at(i).IsNull() && !mBoxes.find(theShapes.at(i), aBoxes[i]))
+        {
+            aMissing.append(i);
+        }
+    }
+
+    // each missing box writes its own slot, the shapes are only read.
+    Bnd_Box* aBoxData = aBoxes.data();
+    const TopoDS_Shape* aShapes = theShapes.constData();
+
+    forEach(aMissing.size(), [&aMissing, aBoxData, aShapes](const int theIndex)
+    {
+        const int aShape = aMissing.at(theIndex);
+        BRepBndLib::Add(aShapes[aShape], aBoxData[aShape]);
+    });
+
+    foreach (int anIndex, aMissing)
+    {
+        mBoxes.insert(theShapes.at(anIndex), aBoxes.at(anIndex));
+    }
+
+    return aBoxes;
+}
+
+QVector<QPair<int, int> > BroadPhase::pairs(const QVector<Bnd_Box>& theBoxes, const Standard_Real theGap)
+{
+    QVector<int> anOrder;
+    QVector<Standard_Real> aXmin;
+    Standard_Real aMaxWidth = 0.0;
+
+    sort(theBoxes, anOrder, aXmin, aMaxWidth);
+
+    QVector<QPair<int, int> > aPairs;
+
+    for (int i = 0; i < anOrder.size(); ++i)
+    {
+        const int aFirst = anOrder.at(i);
+
+        Standard_Real aXmin1, aYmin, aZmin, aXmax, aYmax, aZmax;
+        theBoxes.at(aFirst).Get(aXmin1, aYmin, aZmin, aXmax, aYmax, aZmax);
+
+        // the later boxes start further along x, the sweep stops at the first one out of reach.
+        for (int j = i + 1; j < anOrder.size() && aXmin.at(anOrder.at(j)) <= aXmax + theGap; ++j)
+        {
+            const int aSecond = anOrder.at(j);
+
+            if (gap(theBoxes.at(aFirst), theBoxes.at(aSecond)) <= theGap)
+            {
+                aPairs.append(qMakePair(qMin(aFirst, aSecond), qMax(aFirst, aSecond)));
+            }
+        }
+    }
+
+    return aPairs;
+}
+
+QVector<QPair<int, int> > BroadPhase::pairs(const QVector<Bnd_Box>& theFirst, const QVector<Bnd_Box>& theSecond,
+                                            const Standard_Real theGap)
+{
+    QVector<int> anOrder;
+    QVector<Standard_Real> aXmin;
+    Standard_Real aMaxWidth = 0.0;
+
+    sort(theSecond, anOrder, aXmin, aMaxWidth);
+
+    QVector<Standard_Real> aSortedXmin;
+
+    foreach (int anIndex, anOrder)
+    {
+        aSortedXmin.append(aXmin.at(anIndex));
+    }
+
+    QVector<QPair<int, int> > aPairs;
+
+    for (int i = 0; i < theFirst.size(); ++i)
+    {
+        const Bnd_Box& aBox = theFirst.at(i);
+
+        if (aBox.IsVoid())
+        {
+            continue;
+        }
+
+        Standard_Real aXmin1, aYmin, aZmin, aXmax, aYmax, aZmax;
+        aBox.Get(aXmin1, aYmin, aZmin, aXmax, aYmax, aZmax);
+
+        // a box of the second set only reaches this one from the slice its lower x falls in.
+        QVector<Standard_Real>::const_iterator aBegin = std::lower_bound(aSortedXmin.constBegin(), aSortedXmin.constEnd(),
+                                                                         aXmin1 - theGap - aMaxWidth);
+        QVector<Standard_Real>::const_iterator anEnd = std::upper_bound(aBegin, aSortedXmin.constEnd(), aXmax + theGap);
+
+        for (QVector<Standard_Real>::const_iterator anIter = aBegin; anIter != anEnd; ++anIter)
+        {
+            const int aSecond = anOrder.at(anIter - aSortedXmin.constBegin());
+
+            if (gap(aBox, theSecond.at(aSecond)) <= theGap)
+            {
+                aPairs.append(qMakePair(i, aSecond));
+            }
+        }
+    }
+
+    return aPairs;
+}
+
+Standard_Real BroadPhase::gap(const Bnd_Box& theFirst, const Bnd_Box& theSecond)
+{
+    Standard_Real aFirst[6], aSecond[6];
+    theFirst.Get(aFirst[0], aFirst[1], aFirst[2], aFirst[3], aFirst[4], aFirst[5]);
+    theSecond.Get(aSecond[0], aSecond[1], aSecond[2], aSecond[3], aSecond[4], aSecond[5]);
+
+    Standard_Real aSquare = 0.0;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const Standard_Real aGap = qMax(0.0, qMax(aFirst[i] - aSecond[i + 3], aSecond[i] - aFirst[i + 3]));
+        aSquare += aGap * aGap;
+    }
+
+    return Sqrt(aSquare);
+}
+
+void BroadPhase::forEach(const int theCount, const std::function<void (int)>& theFunction)
+{
+    QVector<int> anIndices(theCount);
+
+    for (int i = 0; i < anIndices.size(); ++i)
+    {
+        anIndices[i] = i;
+    }
+
+    QtConcurrent::blockingMap(anIndices, [&theFunction](const int theIndex)
+    {
+        theFunction(theIndex);
+    });
+}
+
+void BroadPhase::sort(const QVector<Bnd_Box>& theBoxes, QVector<int>& theOrder,
+                      QVector<Standard_Real>& theXmin, Standard_Real& theMaxWidth)
+{
+    theOrder.clear();
+    theXmin.fill(0.0, theBoxes.size());
+    theMaxWidth = 0.0;
+
+    for (int i = 0; i < theBoxes.size(); ++i)
+    {
+        if (theBoxes.at(i).IsVoid())
+        {
+            continue;
+        }
+
+        Standard_Real aYmin, aZmin, aXmax, aYmax, aZmax;
+        theBoxes.at(i).Get(theXmin[i], aYmin, aZmin, aXmax, aYmax, aZmax);
+
+        theMaxWidth = qMax(theMaxWidth, aXmax - theXmin.at(i));
+        theOrder.append(i);
+    }
+
+    std::sort(theOrder.begin(), theOrder.end(), [&theXmin](const int theFirst, const int theSecond)
+    {
+        return theXmin.at(theFirst) < theXmin.at(theSecond);
+    });
+}
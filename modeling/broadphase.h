@@ -0,0 +1,47 @@
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "shapecache.h"
+
+#include <QPair>
+#include <QVector>
+
+#include <functional>
+
+#include <Bnd_Box.hxx>
+#include <TopoDS_Shape.hxx>
+
+//! The broad phase of the interference and clearance checks.
+//! The bounding boxes are cached by shape identity, the missing ones are
+//! computed on the thread pool. A sweep and prune along x gives the pairs of
+//! boxes closer than a gap in about n log n, only those need an exact test.
+class BroadPhase
+{
+public:
+    BroadPhase();
+
+    //! the boxes of theShapes, void for null shapes.
+    QVector<Bnd_Box> boxes(const QVector<TopoDS_Shape>& theShapes);
+
+    //! the pairs (i, j), i < j, of theBoxes closer than theGap.
+    static QVector<QPair<int, int> > pairs(const QVector<Bnd_Box>& theBoxes, const Standard_Real theGap);
+
+    //! the pairs (i, j) of a box of theFirst and a box of theSecond closer than theGap.
+    static QVector<QPair<int, int> > pairs(const QVector<Bnd_Box>& theFirst, const QVector<Bnd_Box>& theSecond,
+                                           const Standard_Real theGap);
+
+    //! a lower bound of the distance between anything inside the two boxes.
+    static Standard_Real gap(const Bnd_Box& theFirst, const Bnd_Box& theSecond);
+
+    //! call theFunction for each index below theCount on the thread pool and wait.
+    static void forEach(const int theCount, const std::function<void (int)>& theFunction);
+
+private:
+    //! the indices of the non void boxes by their lower x, with that x and the widest x range.
+    static void sort(const QVector<Bnd_Box>& theBoxes, QVector<int>& theOrder,
+                     QVector<Standard_Real>& theXmin, Standard_Real& theMaxWidth);
+
+    ShapeCache<Bnd_Box> mBoxes;
+};
+
+#endif // BROADPHASE_H
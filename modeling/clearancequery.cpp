@@ -0,0 +1,161 @@
+#include "clearancequery.h"
+
+#include <QElapsedTimer>
+#include <QSet>
+
+#include <algorithm>
+
+#include <Standard_Failure.hxx>
+
+#include <BRepExtrema_DistShapeShape.hxx>
+
+ClearanceQuery::ClearanceQuery()
+    : mCandidateCount(0),
+      mElapsed(0)
+{
+}
+
+void ClearanceQuery::addSource(const unsigned int theId, const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    Item anItem;
+    anItem.id = theId;
+    anItem.shape = theShape;
+
+    mSources.append(anItem);
+}
+
+void ClearanceQuery::addTarget(const unsigned int theId, const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    Item anItem;
+    anItem.id = theId;
+    anItem.shape = theShape;
+
+    mTargets.append(anItem);
+}
+
+void ClearanceQuery::clearShapes()
+{
+    mSources.clear();
+    mTargets.clear();
+}
+
+QVector<ClearanceQuery::Result> ClearanceQuery::run(const Standard_Real theRadius)
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    QSet<unsigned int> aSourceIds;
+
+    foreach (const Item& aSource, mSources)
+    {
+        aSourceIds.insert(aSource.id);
+    }
+
+    QVector<QPair<int, int> > aCandidates;
+
+    foreach (const QPair<int, int>& aPair, BroadPhase::pairs(boxes(mSources), boxes(mTargets), theRadius))
+    {
+        const unsigned int aSourceId = mSources.at(aPair.first).id;
+        const unsigned int aTargetId = mTargets.at(aPair.second).id;
+
+        // a pair of two sources is measured once.
+        if (aTargetId != aSourceId && !(aSourceIds.contains(aTargetId) && aTargetId < aSourceId))
+        {
+            aCandidates.append(aPair);
+        }
+    }
+
+    mCandidateCount = aCandidates.size();
+
+    QVector<Result> aResults(aCandidates.size());
+    QVector<char> aMeasured(aCandidates.size(), 0);
+
+    Result* aResultData = aResults.data();
+    char* aMeasuredData = aMeasured.data();
+    const Item* aSources = mSources.constData();
+    const Item* aTargets = mTargets.constData();
+
+    BroadPhase::forEach(aCandidates.size(), [&aCandidates, aSources, aTargets, aResultData, aMeasuredData](const int theIndex)
+    {
+        const Item& aSource = aSources[aCandidates.at(theIndex).first];
+        const Item& aTarget = aTargets[aCandidates.at(theIndex).second];
+
+        aResultData[theIndex].first = aSource.id;
+        aResultData[theIndex].second = aTarget.id;
+        aMeasuredData[theIndex] = measure(aSource.shape, aTarget.shape, aResultData[theIndex]);
+    });
+
+    QVector<Result> aClearances;
+
+    for (int i = 0; i < aResults.size(); ++i)
+    {
+        if (aMeasured.at(i) && aResults.at(i).distance <= theRadius)
+        {
+            aClearances.append(aResults.at(i));
+        }
+    }
+
+    std::sort(aClearances.begin(), aClearances.end(), [](const Result& theFirst, const Result& theSecond)
+    {
+        return theFirst.distance < theSecond.distance;
+    });
+
+    mElapsed = aTimer.elapsed();
+
+    return aClearances;
+}
+
+int ClearanceQuery::candidateCount() const
+{
+    return mCandidateCount;
+}
+
+qint64 ClearanceQuery::elapsed() const
+{
+    return mElapsed;
+}
+
+QVector<Bnd_Box> ClearanceQuery::boxes(const QVector<Item>& theItems)
+{
+    QVector<TopoDS_Shape> aShapes;
+
+    foreach (const Item& anItem, theItems)
+    {
+        aShapes.append(anItem.shape);
+    }
+
+    return mBroadPhase.boxes(aShapes);
+}
+
+bool ClearanceQuery::measure(const TopoDS_Shape& theFirst, const TopoDS_Shape& theSecond, Result& theResult)
+{
+    try
+    {
+        BRepExtrema_DistShapeShape aDistance(theFirst, theSecond);
+
+        if (!aDistance.IsDone() || aDistance.NbSolution() < 1)
+        {
+            return false;
+        }
+
+        theResult.distance = aDistance.Value();
+        theResult.point1 = aDistance.PointOnShape1(1);
+        theResult.point2 = aDistance.PointOnShape2(1);
+    }
+    catch (Standard_Failure)
+    {
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,69 @@
+#ifndef CLEARANCEQUERY_H
+#define CLEARANCEQUERY_H
+
+#include "broadphase.h"
+
+#include <QVector>
+
+#include <gp_Pnt.hxx>
+#include <TopoDS_Shape.hxx>
+
+//! Minimum distance queries between sets of shapes.
+//! The broad phase keeps the bounding boxes between runs, so repeated
+//! reports on a scene only box new or modified shapes. A pair is only
+//! measured when its boxes are closer than the search radius, the
+//! measurements with BRepExtrema_DistShapeShape run on the thread pool.
+class ClearanceQuery
+{
+public:
+    struct Result
+    {
+        unsigned int first;
+        unsigned int second;
+        Standard_Real distance;
+
+        //! the closest points, on the first and on the second shape.
+        gp_Pnt point1;
+        gp_Pnt point2;
+    };
+
+    ClearanceQuery();
+
+    //! the shapes measured, e.g. the selection.
+    void addSource(const unsigned int theId, const TopoDS_Shape& theShape);
+
+    //! the shapes they are measured against, sources are skipped as their own neighbour.
+    void addTarget(const unsigned int theId, const TopoDS_Shape& theShape);
+
+    //! forget the sources and targets, the cached boxes are kept.
+    void clearShapes();
+
+    //! distances of all the pairs closer than theRadius, nearest first.
+    QVector<Result> run(const Standard_Real theRadius);
+
+    //! statistics of the last run.
+    int candidateCount() const;
+    qint64 elapsed() const;
+
+private:
+    struct Item
+    {
+        unsigned int id;
+        TopoDS_Shape shape;
+    };
+
+    //! the boxes of theItems.
+    QVector<Bnd_Box> boxes(const QVector<Item>& theItems);
+
+    static bool measure(const TopoDS_Shape& theFirst, const TopoDS_Shape& theSecond, Result& theResult);
+
+    QVector<Item> mSources;
+    QVector<Item> mTargets;
+
+    BroadPhase mBroadPhase;
+
+    int mCandidateCount;
+    qint64 mElapsed;
+};
+
+#endif // CLEARANCEQUERY_H
@@ -0,0 +1,441 @@
+#include "drawingexporter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QPolygonF>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+#include <Precision.hxx>
+#include <gp.hxx>
+#include <gp_Ax2.hxx>
+
+#include <BRep_Builder.hxx>
+#include <BRepAdaptor_Curve.hxx>
+#include <BRepBndLib.hxx>
+#include <Bnd_Box.hxx>
+#include <GCPnts_TangentialDeflection.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+#include <HLRAlgo_Projector.hxx>
+#include <HLRBRep_Algo.hxx>
+#include <HLRBRep_HLRToShape.hxx>
+
+namespace
+{
+    //! the sheet cell of each view, column and row from the top left.
+    void cellOf(const DrawingExporter::View theView, int& theColumn, int& theRow)
+    {
+        theColumn = (theView == DrawingExporter::Side || theView == DrawingExporter::Iso) ? 1 : 0;
+        theRow = (theView == DrawingExporter::Front || theView == DrawingExporter::Side) ? 1 : 0;
+    }
+
+    //! the projection frame, its main direction points to the viewer.
+    gp_Ax2 axisOf(const DrawingExporter::View theView)
+    {
+        switch (theView)
+        {
+        case DrawingExporter::Top:
+            return gp_Ax2(gp::Origin(), gp_Dir(0.0, 0.0, 1.0), gp_Dir(1.0, 0.0, 0.0));
+        case DrawingExporter::Side:
+            return gp_Ax2(gp::Origin(), gp_Dir(1.0, 0.0, 0.0), gp_Dir(0.0, 1.0, 0.0));
+        case DrawingExporter::Iso:
+            return gp_Ax2(gp::Origin(), gp_Dir(1.0, -1.0, 1.0), gp_Dir(1.0, 1.0, 0.0));
+        default:
+            return gp_Ax2(gp::Origin(), gp_Dir(0.0, -1.0, 0.0), gp_Dir(1.0, 0.0, 0.0));
+        }
+    }
+
+    QString coordinate(const qreal theValue)
+    {
+        return QString::number(theValue, 'g', 10);
+    }
+}
+
+DrawingExporter::DrawingExporter()
+    : mDeflection(0.001),
+      mIsEmpty(true)
+{
+    mViews << Front << Top << Side << Iso;
+
+    BRep_Builder aBuilder;
+    aBuilder.MakeCompound(mShapes);
+}
+
+bool DrawingExporter::viewFromName(const QString& theName, View& theView)
+{
+    for (int i = Front; i <= Iso; ++i)
+    {
+        if (theName.compare(viewName(View(i)), Qt::CaseInsensitive) == 0)
+        {
+            theView = View(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+QString DrawingExporter::viewName(const View theView)
+{
+    switch (theView)
+    {
+    case Top:
+        return "top";
+    case Side:
+        return "side";
+    case Iso:
+        return "iso";
+    default:
+        return "front";
+    }
+}
+
+void DrawingExporter::setViews(const QList<View>& theViews)
+{
+    mViews = theViews;
+}
+
+void DrawingExporter::setDeflection(const Standard_Real theDeflection)
+{
+    mDeflection = theDeflection;
+}
+
+void DrawingExporter::add(const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    BRep_Builder aBuilder;
+    aBuilder.Add(mShapes, theShape);
+
+    mIsEmpty = false;
+}
+
+bool DrawingExporter::compute()
+{
+    mProjections.clear();
+    mError.clear();
+
+    if (mIsEmpty)
+    {
+        mError = "nothing to draw";
+        return false;
+    }
+
+    Bnd_Box aBox;
+    BRepBndLib::Add(mShapes, aBox);
+
+    const Standard_Real aDeflection = mDeflection * qMax(Sqrt(aBox.SquareExtent()), Precision::Confusion());
+
+    foreach (View aView, mViews)
+    {
+        Projection aProjection;
+        aProjection.view = aView;
+
+        mProjections.append(aProjection);
+    }
+
+    // the views only share the shapes, which the hidden line removal reads.
+    const TopoDS_Shape aShapes = mShapes;
+
+    QtConcurrent::blockingMap(mProjections, [aShapes, aDeflection](Projection& theProjection)
+    {
+        project(aShapes, aDeflection, theProjection);
+    });
+
+    foreach (const Projection& aProjection, mProjections)
+    {
+        if (!aProjection.error.isEmpty())
+        {
+            mError = QString("%1 view: %2").arg(viewName(aProjection.view), aProjection.error);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void DrawingExporter::project(const TopoDS_Shape& theShape, const Standard_Real theDeflection, Projection& theProjection)
+{
+    try
+    {
+        Handle(HLRBRep_Algo) anAlgo = new HLRBRep_Algo();
+        anAlgo->Add(theShape);
+        anAlgo->Projector(HLRAlgo_Projector(axisOf(theProjection.view)));
+        anAlgo->Update();
+        anAlgo->Hide();
+
+        // sharp edges and silhouettes, the smooth edges between tangent faces are left out.
+        HLRBRep_HLRToShape aToShape(anAlgo);
+
+        addEdges(aToShape.VCompound(), false, theDeflection, theProjection);
+        addEdges(aToShape.OutLineVCompound(), false, theDeflection, theProjection);
+        addEdges(aToShape.HCompound(), true, theDeflection, theProjection);
+        addEdges(aToShape.OutLineHCompound(), true, theDeflection, theProjection);
+    }
+    catch (Standard_Failure)
+    {
+        theProjection.lines.clear();
+        theProjection.error = QString("OCC failure: %1").arg(Standard_Failure::Caught()->GetMessageString());
+    }
+}
+
+void DrawingExporter::addEdges(const TopoDS_Shape& theEdges, const bool theIsHidden,
+                               const Standard_Real theDeflection, Projection& theProjection)
+{
+    if (theEdges.IsNull())
+    {
+        return;
+    }
+
+    // the result edges lie in the XY plane of the projection frame.
+    for (TopExp_Explorer anExp(theEdges, TopAbs_EDGE); anExp.More(); anExp.Next())
+    {
+        BRepAdaptor_Curve aCurve(TopoDS::Edge(anExp.Current()));
+        GCPnts_TangentialDeflection aPoints(aCurve, 0.2, theDeflection);
+
+        if (aPoints.NbPoints() < 2)
+        {
+            continue;
+        }
+
+        Polyline aLine;
+        aLine.isHidden = theIsHidden;
+
+        for (Standard_Integer i = 1; i <= aPoints.NbPoints(); ++i)
+        {
+            const gp_Pnt aPoint = aPoints.Value(i);
+            aLine.points.append(QPointF(aPoint.X(), aPoint.Y()));
+        }
+
+        theProjection.bounds |= QPolygonF(aLine.points).boundingRect();
+        theProjection.lines.append(aLine);
+    }
+}
+
+QVector<QPointF> DrawingExporter::layout(QSizeF& theSheet) const
+{
+    // the used columns and rows, empty ones are dropped.
+    QMap<int, qreal> aWidths;
+    QMap<int, qreal> aHeights;
+
+    foreach (const Projection& aProjection, mProjections)
+    {
+        int aColumn = 0, aRow = 0;
+        cellOf(aProjection.view, aColumn, aRow);
+
+        aWidths[aColumn] = qMax(aWidths.value(aColumn), aProjection.bounds.width());
+        aHeights[aRow] = qMax(aHeights.value(aRow), aProjection.bounds.height());
+    }
+
+    qreal aSize = 0.0;
+
+    foreach (qreal aWidth, aWidths)
+    {
+        aSize = qMax(aSize, aWidth);
+    }
+
+    foreach (qreal aHeight, aHeights)
+    {
+        aSize = qMax(aSize, aHeight);
+    }
+
+    const qreal aMargin = qMax(aSize * 0.1, 1.0);
+
+    // cell centers, the rows go down the sheet.
+    QMap<int, qreal> aColumnCenters;
+    QMap<int, qreal> aRowCenters;
+
+    qreal anX = aMargin;
+
+    for (QMap<int, qreal>::const_iterator anIter = aWidths.constBegin(); anIter != aWidths.constEnd(); ++anIter)
+    {
+        aColumnCenters[anIter.key()] = anX + anIter.value() * 0.5;
+        anX += anIter.value() + aMargin;
+    }
+
+    qreal aY = aMargin;
+
+    for (QMap<int, qreal>::const_iterator anIter = aHeights.constBegin(); anIter != aHeights.constEnd(); ++anIter)
+    {
+        aRowCenters[anIter.key()] = aY + anIter.value() * 0.5;
+        aY += anIter.value() + aMargin;
+    }
+
+    theSheet = QSizeF(anX, aY);
+
+    QVector<QPointF> anOffsets;
+
+    foreach (const Projection& aProjection, mProjections)
+    {
+        int aColumn = 0, aRow = 0;
+        cellOf(aProjection.view, aColumn, aRow);
+
+        // sheet coordinates have y up like the views.
+        const QPointF aCenter(aColumnCenters.value(aColumn), theSheet.height() - aRowCenters.value(aRow));
+        anOffsets.append(aCenter - aProjection.bounds.center());
+    }
+
+    return anOffsets;
+}
+
+bool DrawingExporter::write(const QString& theFileName) const
+{
+    if (mProjections.isEmpty())
+    {
+        mError = "no computed views";
+        return false;
+    }
+
+    const QString aSuffix = QFileInfo(theFileName).suffix().toLower();
+
+    if (aSuffix == "svg")
+    {
+        return writeSvg(theFileName);
+    }
+    else if (aSuffix == "dxf")
+    {
+        return writeDxf(theFileName);
+    }
+
+    mError = QString("unknown drawing format '%1'").arg(aSuffix);
+
+    return false;
+}
+
+bool DrawingExporter::writeSvg(const QString& theFileName) const
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        mError = QString("%1: %2").arg(theFileName, aFile.errorString());
+        return false;
+    }
+
+    QSizeF aSheet;
+    const QVector<QPointF> anOffsets = layout(aSheet);
+
+    const qreal aStroke = qMax(aSheet.width(), aSheet.height()) * 0.001;
+
+    QTextStream aStream(&aFile);
+
+    aStream << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+            << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << coordinate(aSheet.width())
+            << "mm\" height=\"" << coordinate(aSheet.height()) << "mm\" viewBox=\"0 0 "
+            << coordinate(aSheet.width()) << " " << coordinate(aSheet.height()) << "\">\n"
+            << "<g fill=\"none\" stroke=\"black\" stroke-width=\"" << coordinate(aStroke) << "\">\n";
+
+    for (int i = 0; i < mProjections.size(); ++i)
+    {
+        const Projection& aProjection = mProjections.at(i);
+
+        aStream << "<g id=\"" << viewName(aProjection.view) << "\">\n";
+
+        foreach (const Polyline& aLine, aProjection.lines)
+        {
+            aStream << "<polyline";
+
+            if (aLine.isHidden)
+            {
+                aStream << " stroke=\"gray\" stroke-dasharray=\"" << coordinate(aStroke * 6) << "," << coordinate(aStroke * 3) << "\"";
+            }
+
+            aStream << " points=\"";
+
+            foreach (const QPointF& aPoint, aLine.points)
+            {
+                // svg has y down.
+                const QPointF aSheetPoint = aPoint + anOffsets.at(i);
+                aStream << coordinate(aSheetPoint.x()) << "," << coordinate(aSheet.height() - aSheetPoint.y()) << " ";
+            }
+
+            aStream << "\"/>\n";
+        }
+
+        aStream << "</g>\n";
+    }
+
+    aStream << "</g>\n</svg>\n";
+    aStream.flush();
+
+    if (aFile.error() != QFile::NoError)
+    {
+        mError = QString("%1: %2").arg(theFileName, aFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+bool DrawingExporter::writeDxf(const QString& theFileName) const
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        mError = QString("%1: %2").arg(theFileName, aFile.errorString());
+        return false;
+    }
+
+    QSizeF aSheet;
+    const QVector<QPointF> anOffsets = layout(aSheet);
+
+    // an entities-only R12 file, the layers are created by the reader.
+    QTextStream aStream(&aFile);
+
+    aStream << "0\nSECTION\n2\nENTITIES\n";
+
+    for (int i = 0; i < mProjections.size(); ++i)
+    {
+        foreach (const Polyline& aLine, mProjections.at(i).lines)
+        {
+            const QString aLayer = aLine.isHidden ? "HIDDEN" : "VISIBLE";
+
+            for (int j = 1; j < aLine.points.size(); ++j)
+            {
+                const QPointF aStart = aLine.points.at(j - 1) + anOffsets.at(i);
+                const QPointF anEnd = aLine.points.at(j) + anOffsets.at(i);
+
+                aStream << "0\nLINE\n8\n" << aLayer << "\n"
+                        << "62\n" << (aLine.isHidden ? 8 : 7) << "\n"
+                        << "10\n" << coordinate(aStart.x()) << "\n20\n" << coordinate(aStart.y()) << "\n30\n0\n"
+                        << "11\n" << coordinate(anEnd.x()) << "\n21\n" << coordinate(anEnd.y()) << "\n31\n0\n";
+            }
+        }
+    }
+
+    aStream << "0\nENDSEC\n0\nEOF\n";
+    aStream.flush();
+
+    if (aFile.error() != QFile::NoError)
+    {
+        mError = QString("%1: %2").arg(theFileName, aFile.errorString());
+        return false;
+    }
+
+    return true;
+}
+
+int DrawingExporter::polylineCount() const
+{
+    int aCount = 0;
+
+    foreach (const Projection& aProjection, mProjections)
+    {
+        aCount += aProjection.lines.size();
+    }
+
+    return aCount;
+}
+
+QString DrawingExporter::errorString() const
+{
+    return mError;
+}
@@ -0,0 +1,92 @@
+#ifndef DRAWINGEXPORTER_H
+#define DRAWINGEXPORTER_H
+
+#include <QList>
+#include <QPointF>
+#include <QRectF>
+#include <QSizeF>
+#include <QString>
+#include <QVector>
+
+#include <TopoDS_Compound.hxx>
+#include <TopoDS_Shape.hxx>
+
+//! Writes 2D drawings of shapes: exact hidden line removal for a set of
+//! standard views, laid out on one sheet as SVG or DXF. Visible and hidden
+//! edges are kept apart (solid and dashed, or the VISIBLE and HIDDEN layers).
+//! The views of a sheet are projected in parallel, one per worker thread.
+class DrawingExporter
+{
+public:
+    //! orthographic views, the sheet follows third angle projection.
+    enum View
+    {
+        Front,  //!< looking along +Y
+        Top,    //!< looking along -Z
+        Side,   //!< right side, looking along -X
+        Iso     //!< isometric from front right top
+    };
+
+    DrawingExporter();
+
+    //! "front", "top", "side" or "iso", false for anything else.
+    static bool viewFromName(const QString& theName, View& theView);
+    static QString viewName(const View theView);
+
+    //! the views of the sheet, all four by default.
+    void setViews(const QList<View>& theViews);
+
+    //! relative deflection of curved edges (fraction of the bounding box size).
+    void setDeflection(const Standard_Real theDeflection);
+
+    //! the added shapes are projected together and hide each other.
+    void add(const TopoDS_Shape& theShape);
+
+    //! project all the views, false if one of them failed.
+    bool compute();
+
+    //! write the computed views to an .svg or .dxf file.
+    bool write(const QString& theFileName) const;
+
+    //! number of drawn polylines of the last compute().
+    int polylineCount() const;
+
+    QString errorString() const;
+
+private:
+    struct Polyline
+    {
+        QVector<QPointF> points;
+        bool isHidden;
+    };
+
+    struct Projection
+    {
+        View view;
+        QVector<Polyline> lines;
+        QRectF bounds;
+        QString error;
+    };
+
+    static void project(const TopoDS_Shape& theShape, const Standard_Real theDeflection, Projection& theProjection);
+    static void addEdges(const TopoDS_Shape& theEdges, const bool theIsHidden,
+                         const Standard_Real theDeflection, Projection& theProjection);
+
+    //! offsets of the projections on the sheet and the sheet size.
+    QVector<QPointF> layout(QSizeF& theSheet) const;
+
+    bool writeSvg(const QString& theFileName) const;
+    bool writeDxf(const QString& theFileName) const;
+
+    QList<View> mViews;
+    Standard_Real mDeflection;
+
+    TopoDS_Compound mShapes;
+    bool mIsEmpty;
+
+    QVector<Projection> mProjections;
+
+    mutable QString mError;
+};
+
+#endif // DRAWINGEXPORTER_H
@@ -0,0 +1,255 @@
+#include "featuregraph.h"
+#include "shapefactory.h"
+
+#include <QMap>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+#include <gp.hxx>
+#include <gp_Ax2.hxx>
+
+int FeatureGraph::inputCount(const Type theType)
+{
+    switch (theType)
+    {
+    case Fillet:
+    case Chamfer:
+    case Translate:
+        return 1;
+    case Cut:
+    case Fuse:
+    case Common:
+        return 2;
+    default:
+        return 0;
+    }
+}
+
+int FeatureGraph::parameterCount(const Type theType)
+{
+    switch (theType)
+    {
+    case Box:
+        return 6;
+    case Sphere:
+        return 4;
+    case Cylinder:
+    case Cone:
+    case Torus:
+        return 6;
+    case Fillet:
+    case Chamfer:
+        return 1;
+    case Translate:
+        return 3;
+    default:
+        return 0;
+    }
+}
+
+FeatureGraph::NodeId FeatureGraph::addNode(const Type theType, const QVector<double>& theParameters, const QList<NodeId>& theInputs)
+{
+    if (theParameters.size() != parameterCount(theType) || theInputs.size() != inputCount(theType))
+    {
+        return -1;
+    }
+
+    const NodeId anId = mNodes.size();
+
+    Node aNode;
+    aNode.type = theType;
+    aNode.parameters = theParameters;
+    aNode.inputs = theInputs;
+    aNode.level = 0;
+    aNode.dirty = true;
+
+    // inputs exist already, so the graph can not get a cycle.
+    foreach (NodeId anInput, theInputs)
+    {
+        if (anInput < 0 || anInput >= anId)
+        {
+            return -1;
+        }
+
+        aNode.level = qMax(aNode.level, mNodes.at(anInput).level + 1);
+    }
+
+    foreach (NodeId anInput, theInputs)
+    {
+        mNodes[anInput].outputs.append(anId);
+    }
+
+    mNodes.append(aNode);
+
+    return anId;
+}
+
+void FeatureGraph::setParameter(const NodeId theNode, const int theIndex, const double theValue)
+{
+    if (theNode < 0 || theNode >= mNodes.size() || theIndex < 0 || theIndex >= mNodes.at(theNode).parameters.size())
+    {
+        return;
+    }
+
+    if (mNodes.at(theNode).parameters.at(theIndex) == theValue)
+    {
+        return;
+    }
+
+    mNodes[theNode].parameters[theIndex] = theValue;
+
+    markDirty(theNode);
+}
+
+double FeatureGraph::parameter(const NodeId theNode, const int theIndex) const
+{
+    return mNodes.at(theNode).parameters.value(theIndex);
+}
+
+void FeatureGraph::markDirty(const NodeId theNode)
+{
+    if (mNodes.at(theNode).dirty)
+    {
+        // its dependents were marked with it.
+        return;
+    }
+
+    mNodes[theNode].dirty = true;
+
+    foreach (NodeId anOutput, mNodes.at(theNode).outputs)
+    {
+        markDirty(anOutput);
+    }
+}
+
+QList<FeatureGraph::NodeId> FeatureGraph::recompute()
+{
+    QMap<int, QList<NodeId> > aLevels;
+    QList<NodeId> aRecomputed;
+
+    for (NodeId i = 0; i < mNodes.size(); ++i)
+    {
+        if (mNodes.at(i).dirty)
+        {
+            aLevels[mNodes.at(i).level].append(i);
+            aRecomputed.append(i);
+        }
+    }
+
+    // a node only reads the nodes of lower levels, which are finished.
+    Node* aNodes = mNodes.data();
+
+    foreach (QList<NodeId> aLevel, aLevels)
+    {
+        QtConcurrent::blockingMap(aLevel, [this, aNodes](const NodeId theNode)
+        {
+            evaluate(aNodes[theNode]);
+        });
+    }
+
+    return aRecomputed;
+}
+
+void FeatureGraph::evaluate(Node& theNode) const
+{
+    theNode.dirty = false;
+    theNode.error.clear();
+    theNode.shape.Nullify();
+
+    QList<TopoDS_Shape> anInputs;
+
+    foreach (NodeId anInput, theNode.inputs)
+    {
+        if (mNodes.at(anInput).shape.IsNull())
+        {
+            theNode.error = QString("input %1 has no shape").arg(anInput);
+            return;
+        }
+
+        anInputs.append(mNodes.at(anInput).shape);
+    }
+
+    const QVector<double>& aP = theNode.parameters;
+
+    try
+    {
+        gp_Ax2 anAxis;
+
+        if (inputCount(theNode.type) == 0)
+        {
+            anAxis = gp_Ax2(gp_Pnt(aP.at(0), aP.at(1), aP.at(2)), gp::DZ());
+        }
+
+        switch (theNode.type)
+        {
+        case Box:
+            theNode.shape = ShapeFactory::makeBox(anAxis, aP.at(3), aP.at(4), aP.at(5));
+            break;
+        case Sphere:
+            theNode.shape = ShapeFactory::makeSphere(anAxis, aP.at(3));
+            break;
+        case Cylinder:
+            theNode.shape = ShapeFactory::makeCylinder(anAxis, aP.at(3), aP.at(4), aP.at(5));
+            break;
+        case Cone:
+            theNode.shape = ShapeFactory::makeCone(anAxis, aP.at(3), aP.at(4), aP.at(5));
+            break;
+        case Torus:
+            theNode.shape = ShapeFactory::makeTorus(anAxis, aP.at(3), aP.at(4), aP.at(5));
+            break;
+        case Fillet:
+            theNode.shape = ShapeFactory::fillet(anInputs.at(0), aP.at(0));
+            break;
+        case Chamfer:
+            theNode.shape = ShapeFactory::chamfer(anInputs.at(0), aP.at(0));
+            break;
+        case Cut:
+            theNode.shape = ShapeFactory::cut(anInputs.at(0), anInputs.at(1));
+            break;
+        case Fuse:
+            theNode.shape = ShapeFactory::fuse(anInputs.at(0), anInputs.at(1));
+            break;
+        case Common:
+            theNode.shape = ShapeFactory::common(anInputs.at(0), anInputs.at(1));
+            break;
+        case Translate:
+            theNode.shape = ShapeFactory::translated(anInputs.at(0), gp_Vec(aP.at(0), aP.at(1), aP.at(2)));
+            break;
+        }
+    }
+    catch (Standard_Failure)
+    {
+        theNode.shape.Nullify();
+        theNode.error = QString("OCC failure: %1").arg(Standard_Failure::Caught()->GetMessageString());
+    }
+}
+
+QList<FeatureGraph::NodeId> FeatureGraph::inputs(const NodeId theNode) const
+{
+    return mNodes.at(theNode).inputs;
+}
+
+TopoDS_Shape FeatureGraph::shape(const NodeId theNode) const
+{
+    return mNodes.at(theNode).shape;
+}
+
+bool FeatureGraph::isDirty(const NodeId theNode) const
+{
+    return mNodes.at(theNode).dirty;
+}
+
+QString FeatureGraph::error(const NodeId theNode) const
+{
+    return mNodes.at(theNode).error;
+}
+
+int FeatureGraph::nodeCount() const
+{
+    return mNodes.size();
+}
+
+void FeatureGraph::clear()
+{
+    mNodes.clear();
+}
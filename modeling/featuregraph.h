@@ -0,0 +1,83 @@
+#ifndef FEATUREGRAPH_H
+#define FEATUREGRAPH_H
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+#include <TopoDS_Shape.hxx>
+
+//! Dependency graph of modeling features, e.g. box -> fillet or box + sphere -> cut.
+//! Each node remembers its parameters, its inputs and its last result. Changing a
+//! parameter marks the node and everything downstream dirty, recompute() then
+//! evaluates only the dirty nodes, level by level, with the independent nodes of
+//! a level running in parallel. Nodes of a level may share an input, the
+//! ShapeFactory operations leave their arguments untouched.
+class FeatureGraph
+{
+public:
+    //! node types and their parameters.
+    enum Type
+    {
+        Box,        //!< x y z dx dy dz
+        Sphere,     //!< x y z radius
+        Cylinder,   //!< x y z radius height angle
+        Cone,       //!< x y z r1 r2 height
+        Torus,      //!< x y z r1 r2 angle
+        Fillet,     //!< radius, one input
+        Chamfer,    //!< distance, one input
+        Cut,        //!< two inputs
+        Fuse,       //!< two inputs
+        Common,     //!< two inputs
+        Translate   //!< dx dy dz, one input
+    };
+
+    typedef int NodeId;
+
+    //! add a node, the inputs must already be in the graph. Returns -1 on bad arguments.
+    NodeId addNode(const Type theType, const QVector<double>& theParameters, const QList<NodeId>& theInputs = QList<NodeId>());
+
+    //! change one parameter and mark the node and its dependents dirty.
+    void setParameter(const NodeId theNode, const int theIndex, const double theValue);
+    double parameter(const NodeId theNode, const int theIndex) const;
+
+    //! evaluate the dirty nodes, returns the nodes that were recomputed.
+    QList<NodeId> recompute();
+
+    //! the nodes theNode is built from.
+    QList<NodeId> inputs(const NodeId theNode) const;
+
+    TopoDS_Shape shape(const NodeId theNode) const;
+    bool isDirty(const NodeId theNode) const;
+    QString error(const NodeId theNode) const;
+
+    int nodeCount() const;
+
+    //! remove all the nodes.
+    void clear();
+
+private:
+    struct Node
+    {
+        Type type;
+        QVector<double> parameters;
+        QList<NodeId> inputs;
+        QList<NodeId> outputs;
+        int level;
+        bool dirty;
+        TopoDS_Shape shape;
+        QString error;
+    };
+
+    void markDirty(const NodeId theNode);
+
+    //! evaluate one node, its inputs are up to date.
+    void evaluate(Node& theNode) const;
+
+    static int inputCount(const Type theType);
+    static int parameterCount(const Type theType);
+
+    QVector<Node> mNodes;
+};
+
+#endif // FEATUREGRAPH_H
@@ -0,0 +1,510 @@
+#include "gltfexporter.h"
+#include "topologyindex.h"
+#include "analyticmesher.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <qmath.h>
+
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopLoc_Location.hxx>
+
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <Bnd_Box.hxx>
+#include <Poly_Triangulation.hxx>
+
+namespace
+{
+    // glTF constants.
+    const quint32 THE_GLB_MAGIC      = 0x46546C67; // "glTF"
+    const quint32 THE_GLB_VERSION    = 2;
+    const quint32 THE_CHUNK_JSON     = 0x4E4F534A; // "JSON"
+    const quint32 THE_CHUNK_BIN      = 0x004E4942; // "BIN\0"
+    const int     THE_FLOAT          = 5126;
+    const int     THE_UNSIGNED_INT   = 5125;
+    const int     THE_ARRAY_BUFFER   = 34962;
+    const int     THE_ELEMENT_BUFFER = 34963;
+
+    //! glTF colors are linear, OCC colors are used as sRGB by the viewer.
+    double toLinear(const double theValue)
+    {
+        return theValue <= 0.04045 ? theValue / 12.92 : qPow((theValue + 0.055) / 1.055, 2.4);
+    }
+
+    void padTo4(QByteArray& theData, const char theFill)
+    {
+        while (theData.size() % 4 != 0)
+        {
+            theData.append(theFill);
+        }
+    }
+
+    QJsonArray toJsonArray(const float theValues[3])
+    {
+        QJsonArray anArray;
+        anArray.append(theValues[0]);
+        anArray.append(theValues[1]);
+        anArray.append(theValues[2]);
+        return anArray;
+    }
+}
+
+GltfExporter::GltfExporter()
+    : mDeflection(0.001)
+{
+}
+
+void GltfExporter::setDeflection(const Standard_Real theDeflection)
+{
+    mDeflection = theDeflection;
+}
+
+void GltfExporter::add(const TopoDS_Shape& theShape, const Quantity_Color& theColor, const QString& theName)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    gp_Trsf anOffset;
+    const int aGeometry = addGeometry(theShape, anOffset);
+
+    if (aGeometry < 0)
+    {
+        // vertices, edges and wires have nothing to shade.
+        return;
+    }
+
+    Node aNode;
+    aNode.geometry = aGeometry;
+    aNode.material = addMaterial(theColor);
+    aNode.trsf = theShape.Location().Transformation() * anOffset;
+    aNode.name = theName;
+
+    mNodes.append(aNode);
+}
+
+int GltfExporter::addGeometry(const TopoDS_Shape& theShape, gp_Trsf& theOffset)
+{
+    // the same TShape placed somewhere else is the cheapest kind of instance.
+    const QPair<const void*, int> aKey(theShape.TShape().Access(), int(theShape.Orientation()));
+
+    if (mInstanceByTShape.contains(aKey))
+    {
+        const Instance& anInstance = mInstanceByTShape[aKey];
+        theOffset = anInstance.offset;
+        return anInstance.geometry;
+    }
+
+    // mesh the shape in its own frame, the location goes into the node.
+    TopoDS_Shape aLocalShape = theShape.Located(TopLoc_Location());
+
+    Bnd_Box aBox;
+    BRepBndLib::Add(aLocalShape, aBox);
+
+    if (aBox.IsVoid())
+    {
+        return -1;
+    }
+
+    Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+    aBox.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+
+    const Standard_Real aSize = Max(aXmax - aXmin, Max(aYmax - aYmin, aZmax - aZmin));
+    if (!AnalyticMesher::perform(aLocalShape, aSize * mDeflection))
+    {
+        BRepMesh_IncrementalMesh(aLocalShape, aSize * mDeflection);
+    }
+
+    // vertices are stored relative to the min corner, so translated copies
+    // of the same geometry produce the same data and the same digest.
+    const gp_XYZ anOrigin(aXmin, aYmin, aZmin);
+    const Standard_Real aQuantum = Max(aSize, 1.0) * 1.0e-6;
+
+    Geometry aGeometry;
+    QVector<qint64> aQuantized;
+
+    QSharedPointer<const TopologyIndex> aTopology = TopologyIndex::of(aLocalShape);
+    const TopTools_IndexedMapOfShape& aFaces = aTopology->faces();
+
+    for (Standard_Integer aFaceIndex = 1; aFaceIndex <= aFaces.Extent(); ++aFaceIndex)
+    {
+        const TopoDS_Face& aFace = TopoDS::Face(aFaces(aFaceIndex));
+
+        TopLoc_Location aLocation;
+        Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(aFace, aLocation);
+
+        if (aTriangulation.IsNull())
+        {
+            continue;
+        }
+
+        const gp_Trsf aTrsf = aLocation.Transformation();
+        const TColgp_Array1OfPnt& aNodes = aTriangulation->Nodes();
+        const Poly_Array1OfTriangle& aTriangles = aTriangulation->Triangles();
+        const quint32 aFirst = aGeometry.positions.size() / 3;
+        const int aNormalStart = aGeometry.normals.size();
+
+        for (Standard_Integer i = aNodes.Lower(); i <= aNodes.Upper(); ++i)
+        {
+            const gp_XYZ aPoint = aNodes(i).Transformed(aTrsf).XYZ() - anOrigin;
+
+            for (int j = 1; j <= 3; ++j)
+            {
+                const qint64 aValue = qRound64(aPoint.Coord(j) / aQuantum);
+                aQuantized.append(aValue);
+                aGeometry.positions.append(float(aValue * aQuantum));
+                aGeometry.normals.append(0.0f);
+            }
+        }
+
+        const Standard_Boolean isReversed = (aFace.Orientation() == TopAbs_REVERSED);
+
+        for (Standard_Integer i = aTriangles.Lower(); i <= aTriangles.Upper(); ++i)
+        {
+            Standard_Integer aN1, aN2, aN3;
+            aTriangles(i).Get(aN1, aN2, aN3);
+
+            if (isReversed)
+            {
+                qSwap(aN2, aN3);
+            }
+
+            const quint32 anIndices[3] = { aFirst + aN1 - aNodes.Lower(),
+                                           aFirst + aN2 - aNodes.Lower(),
+                                           aFirst + aN3 - aNodes.Lower() };
+
+            // area weighted normals, smooth inside a face and sharp between faces.
+            const float* aP1 = aGeometry.positions.constData() + anIndices[0] * 3;
+            const float* aP2 = aGeometry.positions.constData() + anIndices[1] * 3;
+            const float* aP3 = aGeometry.positions.constData() + anIndices[2] * 3;
+
+            const gp_XYZ aV1(aP2[0] - aP1[0], aP2[1] - aP1[1], aP2[2] - aP1[2]);
+            const gp_XYZ aV2(aP3[0] - aP1[0], aP3[1] - aP1[1], aP3[2] - aP1[2]);
+            const gp_XYZ aNormal = aV1 ^ aV2;
+
+            for (int j = 0; j < 3; ++j)
+            {
+                aGeometry.indices.append(anIndices[j]);
+
+                float* aN = aGeometry.normals.data() + anIndices[j] * 3;
+                aN[0] += float(aNormal.X());
+                aN[1] += float(aNormal.Y());
+                aN[2] += float(aNormal.Z());
+            }
+        }
+
+        for (int i = aNormalStart; i < aGeometry.normals.size(); i += 3)
+        {
+            float* aN = aGeometry.normals.data() + i;
+            const float aLength = qSqrt(aN[0] * aN[0] + aN[1] * aN[1] + aN[2] * aN[2]);
+
+            if (aLength > 0.0f)
+            {
+                aN[0] /= aLength;
+                aN[1] /= aLength;
+                aN[2] /= aLength;
+            }
+        }
+    }
+
+    if (aGeometry.indices.isEmpty())
+    {
+        return -1;
+    }
+
+    theOffset.SetTranslation(gp_Vec(anOrigin));
+
+    QCryptographicHash aHash(QCryptographicHash::Md5);
+    aHash.addData(reinterpret_cast<const char*>(aQuantized.constData()), aQuantized.size() * int(sizeof(qint64)));
+    aHash.addData(reinterpret_cast<const char*>(aGeometry.indices.constData()), aGeometry.indices.size() * int(sizeof(quint32)));
+    const QByteArray aDigest = aHash.result();
+
+    int anIndex = mGeometryByDigest.value(aDigest, -1);
+
+    if (anIndex < 0)
+    {
+        for (int j = 0; j < 3; ++j)
+        {
+            aGeometry.min[j] = aGeometry.positions.at(j);
+            aGeometry.max[j] = aGeometry.positions.at(j);
+        }
+
+        for (int i = 0; i < aGeometry.positions.size(); i += 3)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                aGeometry.min[j] = qMin(aGeometry.min[j], aGeometry.positions.at(i + j));
+                aGeometry.max[j] = qMax(aGeometry.max[j], aGeometry.positions.at(i + j));
+            }
+        }
+
+        anIndex = mGeometries.size();
+        mGeometries.append(aGeometry);
+        mGeometryByDigest.insert(aDigest, anIndex);
+    }
+
+    Instance anInstance;
+    anInstance.geometry = anIndex;
+    anInstance.offset = theOffset;
+    mInstanceByTShape.insert(aKey, anInstance);
+
+    return anIndex;
+}
+
+int GltfExporter::addMaterial(const Quantity_Color& theColor)
+{
+    for (int i = 0; i < mMaterials.size(); ++i)
+    {
+        if (mMaterials.at(i).IsEqual(theColor))
+        {
+            return i;
+        }
+    }
+
+    mMaterials.append(theColor);
+
+    return mMaterials.size() - 1;
+}
+
+bool GltfExporter::write(const QString& theFileName)
+{
+    if (mNodes.isEmpty())
+    {
+        mError = QString("Nothing to export");
+        return false;
+    }
+
+    QByteArray aBinary;
+    QJsonArray aBufferViews;
+    QJsonArray anAccessors;
+
+    // one position, normal and index accessor per unique geometry.
+    for (int i = 0; i < mGeometries.size(); ++i)
+    {
+        const Geometry& aGeometry = mGeometries.at(i);
+
+        const QByteArray aChunks[3] = {
+            QByteArray(reinterpret_cast<const char*>(aGeometry.positions.constData()), aGeometry.positions.size() * int(sizeof(float))),
+            QByteArray(reinterpret_cast<const char*>(aGeometry.normals.constData()), aGeometry.normals.size() * int(sizeof(float))),
+            QByteArray(reinterpret_cast<const char*>(aGeometry.indices.constData()), aGeometry.indices.size() * int(sizeof(quint32)))
+        };
+
+        for (int j = 0; j < 3; ++j)
+        {
+            padTo4(aBinary, '\0');
+
+            QJsonObject aView;
+            aView.insert("buffer", 0);
+            aView.insert("byteOffset", aBinary.size());
+            aView.insert("byteLength", aChunks[j].size());
+            aView.insert("target", j < 2 ? THE_ARRAY_BUFFER : THE_ELEMENT_BUFFER);
+            aBufferViews.append(aView);
+
+            aBinary.append(aChunks[j]);
+
+            QJsonObject anAccessor;
+            anAccessor.insert("bufferView", aBufferViews.size() - 1);
+
+            if (j < 2)
+            {
+                anAccessor.insert("componentType", THE_FLOAT);
+                anAccessor.insert("count", aGeometry.positions.size() / 3);
+                anAccessor.insert("type", QString("VEC3"));
+            }
+            else
+            {
+                anAccessor.insert("componentType", THE_UNSIGNED_INT);
+                anAccessor.insert("count", aGeometry.indices.size());
+                anAccessor.insert("type", QString("SCALAR"));
+            }
+
+            if (j == 0)
+            {
+                anAccessor.insert("min", toJsonArray(aGeometry.min));
+                anAccessor.insert("max", toJsonArray(aGeometry.max));
+            }
+
+            anAccessors.append(anAccessor);
+        }
+    }
+
+    padTo4(aBinary, '\0');
+
+    QJsonArray aMaterials;
+
+    for (int i = 0; i < mMaterials.size(); ++i)
+    {
+        const Quantity_Color& aColor = mMaterials.at(i);
+
+        QJsonArray aFactor;
+        aFactor.append(toLinear(aColor.Red()));
+        aFactor.append(toLinear(aColor.Green()));
+        aFactor.append(toLinear(aColor.Blue()));
+        aFactor.append(1.0);
+
+        QJsonObject aPbr;
+        aPbr.insert("baseColorFactor", aFactor);
+        aPbr.insert("metallicFactor", 0.0);
+        aPbr.insert("roughnessFactor", 0.5);
+
+        QJsonObject aMaterial;
+        aMaterial.insert("pbrMetallicRoughness", aPbr);
+        aMaterials.append(aMaterial);
+    }
+
+    // a glTF material belongs to the mesh, so each geometry/material pair is a
+    // mesh, but all of them point to the same accessors of the geometry.
+    QJsonArray aMeshes;
+    QHash<QPair<int, int>, int> aMeshByPair;
+    QJsonArray aNodes;
+    QJsonArray aChildren;
+
+    for (int i = 0; i < mNodes.size(); ++i)
+    {
+        const Node& aNode = mNodes.at(i);
+        const QPair<int, int> aPair(aNode.geometry, aNode.material);
+
+        if (!aMeshByPair.contains(aPair))
+        {
+            QJsonObject anAttributes;
+            anAttributes.insert("POSITION", aNode.geometry * 3);
+            anAttributes.insert("NORMAL", aNode.geometry * 3 + 1);
+
+            QJsonObject aPrimitive;
+            aPrimitive.insert("attributes", anAttributes);
+            aPrimitive.insert("indices", aNode.geometry * 3 + 2);
+            aPrimitive.insert("material", aNode.material);
+
+            QJsonArray aPrimitives;
+            aPrimitives.append(aPrimitive);
+
+            QJsonObject aMesh;
+            aMesh.insert("primitives", aPrimitives);
+
+            aMeshByPair.insert(aPair, aMeshes.size());
+            aMeshes.append(aMesh);
+        }
+
+        QJsonArray aMatrix;
+
+        for (int aCol = 1; aCol <= 4; ++aCol)
+        {
+            for (int aRow = 1; aRow <= 3; ++aRow)
+            {
+                aMatrix.append(aNode.trsf.Value(aRow, aCol));
+            }
+
+            aMatrix.append(aCol == 4 ? 1.0 : 0.0);
+        }
+
+        QJsonObject aJsonNode;
+        aJsonNode.insert("mesh", aMeshByPair.value(aPair));
+        aJsonNode.insert("matrix", aMatrix);
+
+        if (!aNode.name.isEmpty())
+        {
+            aJsonNode.insert("name", aNode.name);
+        }
+
+        aChildren.append(aNodes.size());
+        aNodes.append(aJsonNode);
+    }
+
+    // glTF is Y up, OCC is Z up: the root node rotates -90 degrees around X.
+    QJsonArray aRotation;
+    aRotation.append(-M_SQRT1_2);
+    aRotation.append(0.0);
+    aRotation.append(0.0);
+    aRotation.append(M_SQRT1_2);
+
+    QJsonObject aRoot;
+    aRoot.insert("name", QString("OccWidget"));
+    aRoot.insert("rotation", aRotation);
+    aRoot.insert("children", aChildren);
+
+    QJsonArray aSceneNodes;
+    aSceneNodes.append(aNodes.size());
+    aNodes.append(aRoot);
+
+    QJsonObject aScene;
+    aScene.insert("nodes", aSceneNodes);
+
+    QJsonArray aScenes;
+    aScenes.append(aScene);
+
+    QJsonObject anAsset;
+    anAsset.insert("version", QString("2.0"));
+    anAsset.insert("generator", QString("OccWidget"));
+
+    QJsonObject aBuffer;
+    aBuffer.insert("byteLength", aBinary.size());
+
+    QJsonArray aBuffers;
+    aBuffers.append(aBuffer);
+
+    QJsonObject aDocument;
+    aDocument.insert("asset", anAsset);
+    aDocument.insert("scene", 0);
+    aDocument.insert("scenes", aScenes);
+    aDocument.insert("nodes", aNodes);
+    aDocument.insert("meshes", aMeshes);
+    aDocument.insert("materials", aMaterials);
+    aDocument.insert("accessors", anAccessors);
+    aDocument.insert("bufferViews", aBufferViews);
+    aDocument.insert("buffers", aBuffers);
+
+    QByteArray aJson = QJsonDocument(aDocument).toJson(QJsonDocument::Compact);
+    padTo4(aJson, ' ');
+
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::WriteOnly))
+    {
+        mError = aFile.errorString();
+        return false;
+    }
+
+    QDataStream aStream(&aFile);
+    aStream.setByteOrder(QDataStream::LittleEndian);
+
+    aStream << THE_GLB_MAGIC << THE_GLB_VERSION
+            << quint32(12 + 8 + aJson.size() + 8 + aBinary.size());
+
+    aStream << quint32(aJson.size()) << THE_CHUNK_JSON;
+    aStream.writeRawData(aJson.constData(), aJson.size());
+
+    aStream << quint32(aBinary.size()) << THE_CHUNK_BIN;
+    aStream.writeRawData(aBinary.constData(), aBinary.size());
+
+    if (aStream.status() != QDataStream::Ok)
+    {
+        mError = QString("Write error");
+        return false;
+    }
+
+    return true;
+}
+
+int GltfExporter::geometryCount() const
+{
+    return mGeometries.size();
+}
+
+int GltfExporter::nodeCount() const
+{
+    return mNodes.size();
+}
+
+QString GltfExporter::errorString() const
+{
+    return mError;
+}
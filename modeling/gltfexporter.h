@@ -0,0 +1,80 @@
+#ifndef GLTFEXPORTER_H
+#define GLTFEXPORTER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+#include <TopoDS_Shape.hxx>
+#include <Quantity_Color.hxx>
+#include <gp_Trsf.hxx>
+
+//! Writes shapes to a binary glTF 2.0 (GLB) file.
+//! Shapes with identical geometry share one set of vertex/index accessors,
+//! only the node transforms differ, so the file grows with unique geometry.
+class GltfExporter
+{
+public:
+    GltfExporter();
+
+    //! relative deflection used when a shape must be meshed (fraction of the bounding box size).
+    void setDeflection(const Standard_Real theDeflection);
+
+    //! add a shape with its color, the location of the shape goes into the node transform.
+    void add(const TopoDS_Shape& theShape, const Quantity_Color& theColor, const QString& theName = QString());
+
+    //! write the collected scene to a GLB file.
+    bool write(const QString& theFileName);
+
+    //! number of unique geometries and of nodes referencing them.
+    int geometryCount() const;
+    int nodeCount() const;
+
+    QString errorString() const;
+
+private:
+    struct Geometry
+    {
+        QVector<float> positions;
+        QVector<float> normals;
+        QVector<quint32> indices;
+        float min[3];
+        float max[3];
+    };
+
+    struct Node
+    {
+        int geometry;
+        int material;
+        gp_Trsf trsf;
+        QString name;
+    };
+
+    //! mesh the shape in its own frame, returns the geometry index or -1 if it has no triangles.
+    int addGeometry(const TopoDS_Shape& theShape, gp_Trsf& theOffset);
+
+    int addMaterial(const Quantity_Color& theColor);
+
+    Standard_Real mDeflection;
+
+    QVector<Geometry> mGeometries;
+    QVector<Node> mNodes;
+    QVector<Quantity_Color> mMaterials;
+
+    //! a geometry plus the translation that moves it back to where it was meshed.
+    struct Instance
+    {
+        int geometry;
+        gp_Trsf offset;
+    };
+
+    //! geometry lookup by TShape and orientation, and by content digest.
+    QHash<QPair<const void*, int>, Instance> mInstanceByTShape;
+    QHash<QByteArray, int> mGeometryByDigest;
+
+    QString mError;
+};
+
+#endif // GLTFEXPORTER_H
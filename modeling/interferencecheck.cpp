@@ -0,0 +1,186 @@
+#include "interferencecheck.h"
+#include "shapefactory.h"
+
+#include <QElapsedTimer>
+
+#include <Precision.hxx>
+#include <Standard_Failure.hxx>
+
+#include <BRep_Tool.hxx>
+#include <BRepClass3d_SolidClassifier.hxx>
+#include <BRepExtrema_DistShapeShape.hxx>
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+InterferenceCheck::InterferenceCheck()
+    : mTolerance(Precision::Confusion()),
+      mToReportTouching(false),
+      mCandidateCount(0),
+      mBroadPhaseTime(0),
+      mNarrowPhaseTime(0)
+{
+}
+
+void InterferenceCheck::setTolerance(const Standard_Real theTolerance)
+{
+    mTolerance = qMax(theTolerance, Precision::Confusion());
+}
+
+void InterferenceCheck::setReportTouching(const bool theToReport)
+{
+    mToReportTouching = theToReport;
+}
+
+void InterferenceCheck::add(const unsigned int theId, const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    Part aPart;
+    aPart.id = theId;
+    aPart.shape = theShape;
+
+    mParts.append(aPart);
+}
+
+QVector<InterferenceCheck::Clash> InterferenceCheck::run()
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    QVector<TopoDS_Shape> aShapes;
+
+    foreach (const Part& aPart, mParts)
+    {
+        aShapes.append(aPart.shape);
+    }
+
+    // the box gap is a lower bound of the distance, no clash is missed.
+    const QVector<QPair<int, int> > aCandidates = BroadPhase::pairs(mBroadPhase.boxes(aShapes), mTolerance);
+
+    mCandidateCount = aCandidates.size();
+    mBroadPhaseTime = aTimer.restart();
+
+    // each candidate writes its own slot, the parts are only read and the
+    // common volume is computed on copies.
+    QVector<Clash> aResults(aCandidates.size());
+    QVector<char> aHits(aCandidates.size(), 0);
+
+    Clash* aResultData = aResults.data();
+    char* aHitData = aHits.data();
+    const Part* aParts = mParts.constData();
+
+    BroadPhase::forEach(aCandidates.size(), [this, &aCandidates, aParts, aResultData, aHitData](const int theIndex)
+    {
+        const QPair<int, int>& aPair = aCandidates.at(theIndex);
+        aHitData[theIndex] = narrowPhase(aParts[aPair.first], aParts[aPair.second], aResultData[theIndex]);
+    });
+
+    QVector<Clash> aClashes;
+
+    for (int i = 0; i < aResults.size(); ++i)
+    {
+        if (aHits.at(i))
+        {
+            aClashes.append(aResults.at(i));
+        }
+    }
+
+    mNarrowPhaseTime = aTimer.elapsed();
+
+    return aClashes;
+}
+
+bool InterferenceCheck::narrowPhase(const Part& theFirst, const Part& theSecond, Clash& theClash) const
+{
+    theClash.first = theFirst.id;
+    theClash.second = theSecond.id;
+    theClash.volume = 0.0;
+
+    try
+    {
+        BRepExtrema_DistShapeShape aDistance(theFirst.shape, theSecond.shape);
+
+        if (!aDistance.IsDone())
+        {
+            return false;
+        }
+
+        theClash.distance = aDistance.Value();
+
+        if (theClash.distance > mTolerance)
+        {
+            // the boundaries are apart, but one part may lie inside the other.
+            if (!contains(theFirst.shape, theSecond.shape, mTolerance) && !contains(theSecond.shape, theFirst.shape, mTolerance))
+            {
+                return false;
+            }
+
+            theClash.distance = 0.0;
+        }
+
+        // a failed common keeps the clash, without its volume.
+        try
+        {
+            theClash.common = ShapeFactory::common(theFirst.shape, theSecond.shape);
+
+            GProp_GProps aProperties;
+            BRepGProp::VolumeProperties(theClash.common, aProperties);
+
+            theClash.volume = aProperties.Mass();
+        }
+        catch (Standard_Failure)
+        {
+            theClash.common.Nullify();
+        }
+    }
+    catch (Standard_Failure)
+    {
+        return false;
+    }
+
+    return theClash.volume > Precision::Confusion() || mToReportTouching;
+}
+
+bool InterferenceCheck::contains(const TopoDS_Shape& theSolid, const TopoDS_Shape& theShape, const Standard_Real theTolerance)
+{
+    TopExp_Explorer aVertexExp(theShape, TopAbs_VERTEX);
+
+    if (!aVertexExp.More())
+    {
+        return false;
+    }
+
+    const gp_Pnt aPoint = BRep_Tool::Pnt(TopoDS::Vertex(aVertexExp.Current()));
+
+    for (TopExp_Explorer aSolidExp(theSolid, TopAbs_SOLID); aSolidExp.More(); aSolidExp.Next())
+    {
+        BRepClass3d_SolidClassifier aClassifier(aSolidExp.Current(), aPoint, theTolerance);
+
+        if (aClassifier.State() == TopAbs_IN)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int InterferenceCheck::candidateCount() const
+{
+    return mCandidateCount;
+}
+
+qint64 InterferenceCheck::broadPhaseTime() const
+{
+    return mBroadPhaseTime;
+}
+
+qint64 InterferenceCheck::narrowPhaseTime() const
+{
+    return mNarrowPhaseTime;
+}
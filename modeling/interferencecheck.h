@@ -0,0 +1,74 @@
+#ifndef INTERFERENCECHECK_H
+#define INTERFERENCECHECK_H
+
+#include "broadphase.h"
+
+#include <QPair>
+#include <QVector>
+
+#include <TopoDS_Shape.hxx>
+
+//! Finds the clashing pairs of a set of parts.
+//! The broad phase gives the pairs of parts whose bounding boxes are closer
+//! than the tolerance, only those get the exact test on the thread pool: the
+//! minimum distance, a containment test when the boundaries do not meet,
+//! and the common volume of the pairs that interfere.
+class InterferenceCheck
+{
+public:
+    struct Clash
+    {
+        unsigned int first;
+        unsigned int second;
+
+        //! zero when the boundaries meet or one part contains the other.
+        Standard_Real distance;
+
+        //! volume of the common part, zero for parts that only touch.
+        Standard_Real volume;
+        TopoDS_Shape common;
+    };
+
+    InterferenceCheck();
+
+    //! parts closer than this interfere.
+    void setTolerance(const Standard_Real theTolerance);
+
+    //! also report the parts that touch without a common volume.
+    void setReportTouching(const bool theToReport);
+
+    void add(const unsigned int theId, const TopoDS_Shape& theShape);
+
+    //! check all the added parts.
+    QVector<Clash> run();
+
+    //! statistics of the last run.
+    int candidateCount() const;
+    qint64 broadPhaseTime() const;
+    qint64 narrowPhaseTime() const;
+
+private:
+    struct Part
+    {
+        unsigned int id;
+        TopoDS_Shape shape;
+    };
+
+    //! the exact test of one candidate, true if the pair clashes.
+    bool narrowPhase(const Part& theFirst, const Part& theSecond, Clash& theClash) const;
+
+    static bool contains(const TopoDS_Shape& theSolid, const TopoDS_Shape& theShape, const Standard_Real theTolerance);
+
+    Standard_Real mTolerance;
+    bool mToReportTouching;
+
+    QVector<Part> mParts;
+
+    BroadPhase mBroadPhase;
+
+    int mCandidateCount;
+    qint64 mBroadPhaseTime;
+    qint64 mNarrowPhaseTime;
+};
+
+#endif // INTERFERENCECHECK_H
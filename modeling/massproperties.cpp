@@ -0,0 +1,194 @@
+#include "massproperties.h"
+
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <GProp_PrincipalProps.hxx>
+
+namespace
+{
+    //! results kept before the oldest are dropped.
+    const int THE_CACHE_LIMIT = 4096;
+}
+
+MassProperties::MassProperties()
+    : mPrecision(0.0),
+      mCache(THE_CACHE_LIMIT)
+{
+}
+
+MassProperties::~MassProperties()
+{
+    cancel();
+}
+
+void MassProperties::setPrecision(const Standard_Real thePrecision)
+{
+    mPrecision = qMax(thePrecision, 0.0);
+}
+
+Standard_Real MassProperties::precision() const
+{
+    return mPrecision;
+}
+
+bool MassProperties::cached(const TopoDS_Shape& theShape, Values& theValues) const
+{
+    return mCache.find(theShape, theValues, mPrecision);
+}
+
+void MassProperties::request(const TopoDS_Shape& theShape, const Callback& theCallback)
+{
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    Values aValues;
+
+    if (cached(theShape, aValues))
+    {
+        theCallback(theShape, aValues);
+        return;
+    }
+
+    // the shape is being computed already, wait for the same result.
+    for (QHash<Watcher*, Job>::iterator anIter = mJobs.begin(); anIter != mJobs.end(); ++anIter)
+    {
+        if (anIter.value().precision == mPrecision && anIter.value().shape.IsSame(theShape))
+        {
+            anIter.value().callbacks.append(theCallback);
+            return;
+        }
+    }
+
+    Job aJob;
+    aJob.shape = theShape;
+    aJob.precision = mPrecision;
+    aJob.callbacks.append(theCallback);
+
+    Watcher* aWatcher = new Watcher();
+    QObject::connect(aWatcher, &Watcher::finished, [this, aWatcher]()
+    {
+        finished(aWatcher);
+    });
+
+    mJobs.insert(aWatcher, aJob);
+
+    aWatcher->setFuture(QtConcurrent::run(compute, theShape, mPrecision));
+}
+
+void MassProperties::invalidate(const TopoDS_Shape& theShape)
+{
+    // all the precisions.
+    mCache.remove(theShape);
+}
+
+void MassProperties::clear()
+{
+    // the computations only read their shape, they are left to finish and
+    // their watchers delete themselves, the caller is not blocked.
+    foreach (Watcher* aWatcher, mJobs.keys())
+    {
+        aWatcher->disconnect();
+        QObject::connect(aWatcher, &Watcher::finished, aWatcher, &QObject::deleteLater);
+    }
+
+    mJobs.clear();
+    mCache.clear();
+}
+
+int MassProperties::pendingCount() const
+{
+    return mJobs.size();
+}
+
+MassProperties::Values MassProperties::compute(const TopoDS_Shape& theShape, const Standard_Real thePrecision)
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    Values aValues;
+    aValues.volume = 0.0;
+    aValues.area = 0.0;
+    aValues.principal[0] = aValues.principal[1] = aValues.principal[2] = 0.0;
+    aValues.error = 0.0;
+    aValues.isValid = false;
+
+    try
+    {
+        GProp_GProps aVolume;
+        GProp_GProps aSurface;
+
+        if (thePrecision > 0.0)
+        {
+            aValues.error = BRepGProp::VolumeProperties(theShape, aVolume, thePrecision);
+            BRepGProp::SurfaceProperties(theShape, aSurface, thePrecision);
+        }
+        else
+        {
+            BRepGProp::VolumeProperties(theShape, aVolume);
+            BRepGProp::SurfaceProperties(theShape, aSurface);
+        }
+
+        aValues.volume = aVolume.Mass();
+        aValues.area = aSurface.Mass();
+
+        // shells and faces have no volume, their surface gives the center and inertia.
+        const GProp_GProps& aMain = aValues.volume > 0.0 ? aVolume : aSurface;
+
+        aValues.center = aMain.CentreOfMass();
+        aValues.inertia = aMain.MatrixOfInertia();
+        aMain.PrincipalProperties().Moments(aValues.principal[0], aValues.principal[1], aValues.principal[2]);
+
+        aValues.isValid = true;
+    }
+    catch (Standard_Failure)
+    {
+    }
+
+    aValues.time = aTimer.elapsed();
+
+    return aValues;
+}
+
+void MassProperties::finished(Watcher* theWatcher)
+{
+    if (!mJobs.contains(theWatcher))
+    {
+        return;
+    }
+
+    const Job aJob = mJobs.take(theWatcher);
+    const Values aValues = theWatcher->result();
+
+    theWatcher->disconnect();
+    theWatcher->deleteLater();
+
+    if (aValues.isValid)
+    {
+        mCache.insert(aJob.shape, aValues, aJob.precision);
+    }
+
+    foreach (const Callback& aCallback, aJob.callbacks)
+    {
+        aCallback(aJob.shape, aValues);
+    }
+}
+
+void MassProperties::cancel()
+{
+    foreach (Watcher* aWatcher, mJobs.keys())
+    {
+        aWatcher->disconnect();
+        aWatcher->waitForFinished();
+        delete aWatcher;
+    }
+
+    mJobs.clear();
+}
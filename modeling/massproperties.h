@@ -0,0 +1,90 @@
+#ifndef MASSPROPERTIES_H
+#define MASSPROPERTIES_H
+
+#include "shapecache.h"
+
+#include <QHash>
+#include <QList>
+
+#include <functional>
+
+#include <gp_Mat.hxx>
+#include <gp_Pnt.hxx>
+#include <TopoDS_Shape.hxx>
+
+template <typename T> class QFutureWatcher;
+
+//! Volume, area, center of mass and inertia of shapes, computed on the
+//! thread pool. Results are cached by shape identity (TShape and location)
+//! and precision: a modified shape has a new identity and is computed again,
+//! while undo gives back a shape whose values are still cached. Failed
+//! computations are reported but not cached, the next request tries again.
+class MassProperties
+{
+public:
+    struct Values
+    {
+        Standard_Real volume;
+        Standard_Real area;
+        gp_Pnt center;
+
+        //! inertia at the center of mass, for a unit density.
+        gp_Mat inertia;
+        Standard_Real principal[3];
+
+        //! the estimated relative error of the volume, 0 for the plain integration.
+        Standard_Real error;
+        qint64 time;
+
+        //! false when the integration failed, the values are then meaningless.
+        bool isValid;
+    };
+
+    //! called on the thread that made the request.
+    typedef std::function<void (const TopoDS_Shape&, const Values&)> Callback;
+
+    MassProperties();
+    ~MassProperties();
+
+    //! relative precision of the adaptive integration, 0 or less for the faster plain integration.
+    void setPrecision(const Standard_Real thePrecision);
+    Standard_Real precision() const;
+
+    //! the cached values of theShape at the current precision.
+    bool cached(const TopoDS_Shape& theShape, Values& theValues) const;
+
+    //! compute the values in the background, theCallback runs right away when cached.
+    void request(const TopoDS_Shape& theShape, const Callback& theCallback);
+
+    //! drop the cached values of theShape, e.g. after its geometry was changed in place.
+    void invalidate(const TopoDS_Shape& theShape);
+
+    //! drop everything, running computations finish without calling back.
+    void clear();
+
+    int pendingCount() const;
+
+private:
+    typedef QFutureWatcher<Values> Watcher;
+
+    struct Job
+    {
+        TopoDS_Shape shape;
+        Standard_Real precision;
+        QList<Callback> callbacks;
+    };
+
+    static Values compute(const TopoDS_Shape& theShape, const Standard_Real thePrecision);
+
+    void finished(Watcher* theWatcher);
+    void cancel();
+
+    Standard_Real mPrecision;
+
+    //! the values by shape and precision.
+    ShapeCache<Values, Standard_Real> mCache;
+
+    QHash<Watcher*, Job> mJobs;
+};
+
+#endif // MASSPROPERTIES_H
@@ -0,0 +1,336 @@
+#include "meshcache.h"
+#include "analyticmesher.h"
+#include "topologyindex.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+#include <QVector>
+
+#include <sstream>
+
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+#include <Bnd_Box.hxx>
+#include <Poly_Triangulation.hxx>
+
+namespace
+{
+    const quint32 THE_MAGIC   = 0x314D434F; // "OCM1"
+    const quint32 THE_VERSION = 1;
+
+    //! bytes per node, per node with its UV and per triangle in a mesh file.
+    const qint64 THE_NODE_SIZE = 3 * sizeof(double);
+    const qint64 THE_UV_NODE_SIZE = 5 * sizeof(double);
+    const qint64 THE_TRIANGLE_SIZE = 3 * sizeof(quint32);
+}
+
+MeshCache::MeshCache(const QString& theDirectory)
+    : mDirectory(theDirectory),
+      mThread(QThread::currentThread()),
+      mHits(0),
+      mMisses(0),
+      mAnalytic(0)
+{
+    if (mDirectory.isEmpty())
+    {
+        mDirectory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/meshes";
+    }
+
+    QDir().mkpath(mDirectory);
+}
+
+Standard_Real MeshCache::deflection(const TopoDS_Shape& theShape, const Standard_Real theCoefficient)
+{
+    Bnd_Box aBox;
+    BRepBndLib::Add(theShape, aBox);
+
+    if (aBox.IsVoid())
+    {
+        return theCoefficient;
+    }
+
+    Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+    aBox.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+
+    return Max(aXmax - aXmin, Max(aYmax - aYmin, aZmax - aZmin)) * theCoefficient;
+}
+
+bool MeshCache::mesh(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle)
+{
+    Q_ASSERT_X(QThread::currentThread() == mThread, "MeshCache::mesh", "the faces are shared, mesh on the owner thread");
+
+    if (theShape.IsNull() || BRepTools::Triangulation(theShape, theDeflection))
+    {
+        return false;
+    }
+
+    // the mesh lives in the frame of the shape, its own placement is not part of the key.
+    TopoDS_Shape aLocalShape = theShape.Located(TopLoc_Location());
+
+    // primitives are meshed in closed form faster than the key is computed.
+    int aFaceCount = 0;
+
+    if (AnalyticMesher::perform(aLocalShape, theDeflection, theAngle, &aFaceCount))
+    {
+        mAnalytic += aFaceCount;
+        return false;
+    }
+
+    const QString aFileName = mDirectory + "/" + QString::fromLatin1(key(aLocalShape, theDeflection, theAngle).toHex()) + ".mesh";
+
+    if (load(aFileName, aLocalShape))
+    {
+        ++mHits;
+        return true;
+    }
+
+    ++mMisses;
+
+    BRepMesh_IncrementalMesh(aLocalShape, theDeflection, Standard_False, theAngle);
+
+    save(aFileName, aLocalShape);
+
+    return false;
+}
+
+QByteArray MeshCache::key(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle) const
+{
+    std::ostringstream aStream;
+    BRepTools::Write(theShape, aStream);
+
+    const std::string aBRep = aStream.str();
+
+    QByteArray aParameters;
+    QDataStream aParameterStream(&aParameters, QIODevice::WriteOnly);
+    aParameterStream << THE_VERSION << double(theDeflection) << double(theAngle);
+
+    QCryptographicHash aHash(QCryptographicHash::Sha1);
+    aHash.addData(aBRep.data(), int(aBRep.size()));
+    aHash.addData(aParameters);
+
+    return aHash.result();
+}
+
+bool MeshCache::load(const QString& theFileName, const TopoDS_Shape& theShape) const
+{
+    QFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    // a corrupt, truncated or stale file is meshed again and replaced.
+    if (!read(aFile, theShape))
+    {
+        aFile.remove();
+        return false;
+    }
+
+    return true;
+}
+
+bool MeshCache::read(QFile& theFile, const TopoDS_Shape& theShape) const
+{
+    QDataStream aStream(&theFile);
+    aStream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 aMagic = 0;
+    quint32 aVersion = 0;
+    quint32 aFaceCount = 0;
+    aStream >> aMagic >> aVersion >> aFaceCount;
+
+    QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(theShape);
+    const TopTools_IndexedMapOfShape& aFaces = anIndex->faces();
+
+    if (aMagic != THE_MAGIC || aVersion != THE_VERSION || int(aFaceCount) != aFaces.Extent())
+    {
+        return false;
+    }
+
+    // read everything first, a truncated file must not leave half a mesh behind.
+    QVector<Handle_Poly_Triangulation> aTriangulations(aFaces.Extent());
+
+    for (int i = 0; i < aFaces.Extent(); ++i)
+    {
+        quint32 aNodeCount = 0;
+        quint32 aTriangleCount = 0;
+        quint8 hasUV = 0;
+        double aDeflection = 0.0;
+        aStream >> aNodeCount >> aTriangleCount >> hasUV >> aDeflection;
+
+        if (aStream.status() != QDataStream::Ok || hasUV > 1)
+        {
+            return false;
+        }
+
+        if (aNodeCount == 0)
+        {
+            continue;
+        }
+
+        // the counts must fit in the rest of the file before anything is allocated.
+        const qint64 aSize = qint64(aNodeCount) * (hasUV ? THE_UV_NODE_SIZE : THE_NODE_SIZE)
+                           + qint64(aTriangleCount) * THE_TRIANGLE_SIZE;
+
+        if (aTriangleCount == 0 || aSize > theFile.size() - theFile.pos())
+        {
+            return false;
+        }
+
+        Handle_Poly_Triangulation aTriangulation = new Poly_Triangulation(aNodeCount, aTriangleCount, hasUV != 0);
+        aTriangulation->Deflection(aDeflection);
+
+        TColgp_Array1OfPnt& aNodes = aTriangulation->ChangeNodes();
+
+        for (Standard_Integer j = 1; j <= Standard_Integer(aNodeCount); ++j)
+        {
+            double aX, aY, aZ;
+            aStream >> aX >> aY >> aZ;
+            aNodes(j).SetCoord(aX, aY, aZ);
+        }
+
+        if (hasUV)
+        {
+            TColgp_Array1OfPnt2d& anUVNodes = aTriangulation->ChangeUVNodes();
+
+            for (Standard_Integer j = 1; j <= Standard_Integer(aNodeCount); ++j)
+            {
+                double anU, aV;
+                aStream >> anU >> aV;
+                anUVNodes(j).SetCoord(anU, aV);
+            }
+        }
+
+        Poly_Array1OfTriangle& aTriangles = aTriangulation->ChangeTriangles();
+
+        for (Standard_Integer j = 1; j <= Standard_Integer(aTriangleCount); ++j)
+        {
+            quint32 aN1 = 0, aN2 = 0, aN3 = 0;
+            aStream >> aN1 >> aN2 >> aN3;
+
+            // the viewer, the exporters and the selection index the nodes without checks.
+            if (aN1 < 1 || aN1 > aNodeCount || aN2 < 1 || aN2 > aNodeCount || aN3 < 1 || aN3 > aNodeCount)
+            {
+                return false;
+            }
+
+            aTriangles(j).Set(aN1, aN2, aN3);
+        }
+
+        aTriangulations[i] = aTriangulation;
+    }
+
+    if (aStream.status() != QDataStream::Ok || !aStream.atEnd())
+    {
+        return false;
+    }
+
+    BRep_Builder aBuilder;
+
+    for (int i = 0; i < aFaces.Extent(); ++i)
+    {
+        if (!aTriangulations.at(i).IsNull())
+        {
+            aBuilder.UpdateFace(TopoDS::Face(aFaces(i + 1)), aTriangulations.at(i));
+        }
+    }
+
+    return true;
+}
+
+bool MeshCache::save(const QString& theFileName, const TopoDS_Shape& theShape) const
+{
+    QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(theShape);
+    const TopTools_IndexedMapOfShape& aFaces = anIndex->faces();
+
+    QSaveFile aFile(theFileName);
+
+    if (!aFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    QDataStream aStream(&aFile);
+    aStream.setByteOrder(QDataStream::LittleEndian);
+
+    aStream << THE_MAGIC << THE_VERSION << quint32(aFaces.Extent());
+
+    for (Standard_Integer i = 1; i <= aFaces.Extent(); ++i)
+    {
+        // the location of the face is implied by its index in the map.
+        TopLoc_Location aLocation;
+        Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(aFaces(i)), aLocation);
+
+        if (aTriangulation.IsNull())
+        {
+            aStream << quint32(0) << quint32(0) << quint8(0) << 0.0;
+            continue;
+        }
+
+        const TColgp_Array1OfPnt& aNodes = aTriangulation->Nodes();
+        const Poly_Array1OfTriangle& aTriangles = aTriangulation->Triangles();
+        const bool hasUV = aTriangulation->HasUVNodes();
+
+        aStream << quint32(aNodes.Length()) << quint32(aTriangles.Length())
+                << quint8(hasUV ? 1 : 0) << double(aTriangulation->Deflection());
+
+        for (Standard_Integer j = aNodes.Lower(); j <= aNodes.Upper(); ++j)
+        {
+            aStream << aNodes(j).X() << aNodes(j).Y() << aNodes(j).Z();
+        }
+
+        if (hasUV)
+        {
+            const TColgp_Array1OfPnt2d& anUVNodes = aTriangulation->UVNodes();
+
+            for (Standard_Integer j = anUVNodes.Lower(); j <= anUVNodes.Upper(); ++j)
+            {
+                aStream << anUVNodes(j).X() << anUVNodes(j).Y();
+            }
+        }
+
+        for (Standard_Integer j = aTriangles.Lower(); j <= aTriangles.Upper(); ++j)
+        {
+            Standard_Integer aN1, aN2, aN3;
+            aTriangles(j).Get(aN1, aN2, aN3);
+
+            aStream << quint32(aN1) << quint32(aN2) << quint32(aN3);
+        }
+    }
+
+    return aStream.status() == QDataStream::Ok && aFile.commit();
+}
+
+QString MeshCache::directory() const
+{
+    return mDirectory;
+}
+
+int MeshCache::hits() const
+{
+    return mHits;
+}
+
+int MeshCache::misses() const
+{
+    return mMisses;
+}
+
+int MeshCache::analytic() const
+{
+    return mAnalytic;
+}
@@ -0,0 +1,59 @@
+#ifndef MESHCACHE_H
+#define MESHCACHE_H
+
+#include <QByteArray>
+#include <QString>
+
+class QFile;
+class QThread;
+
+#include <TopoDS_Shape.hxx>
+
+//! Persistent triangulation cache.
+//! The key is a digest of the serialized B-Rep plus the mesh parameters, the
+//! value a compact binary file with one triangulation per face. On a hit the
+//! triangulations are attached to the faces and BRepMesh is not called.
+//!
+//! The triangulations are written into the faces of the given shape, which
+//! its copies and the displayed objects share, so mesh() is only called on
+//! the thread that created the cache, the GUI thread of the application.
+class MeshCache
+{
+public:
+    //! use theDirectory, or <cache location>/meshes when it is empty.
+    explicit MeshCache(const QString& theDirectory = QString());
+
+    //! make sure the shape is triangulated, returns true if the mesh came from the cache.
+    bool mesh(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle = 0.5);
+
+    //! the deflection used by the viewer: theCoefficient times the largest bounding box side.
+    static Standard_Real deflection(const TopoDS_Shape& theShape, const Standard_Real theCoefficient = 0.001);
+
+    QString directory() const;
+
+    //! cache statistics since construction.
+    int hits() const;
+    int misses() const;
+
+    //! faces meshed by the AnalyticMesher, they bypass the cache.
+    int analytic() const;
+
+private:
+    QByteArray key(const TopoDS_Shape& theShape, const Standard_Real theDeflection, const Standard_Real theAngle) const;
+
+    //! attach the triangulations of the file, a file that does not match the shape is deleted.
+    bool load(const QString& theFileName, const TopoDS_Shape& theShape) const;
+    bool read(QFile& theFile, const TopoDS_Shape& theShape) const;
+    bool save(const QString& theFileName, const TopoDS_Shape& theShape) const;
+
+    QString mDirectory;
+
+    //! the thread allowed to mesh.
+    QThread* mThread;
+
+    int mHits;
+    int mMisses;
+    int mAnalytic;
+};
+
+#endif // MESHCACHE_H
@@ -0,0 +1,16 @@
+# Link the modeling library and the OCC toolkits it needs, for projects
+# built from the top level occqt.pro.
+
+MODELING_OUT = $$shadowed($$PWD)
+
+INCLUDEPATH += $$PWD /usr/include/oce
+DEPENDPATH += $$PWD
+
+LIBS += -L$$MODELING_OUT -loccqtmodeling
+PRE_TARGETDEPS += $$MODELING_OUT/liboccqtmodeling.a
+
+# after the library, the static link resolves it from left to right.
+LIBS += -L/usr/lib64/oce -lTKernel -lTKMath -lTKService \
+        -lTKBRep -lTKGeomBase -lTKGeomAlgo -lTKG3d -lTKG2d \
+        -lTKShHealing -lTKHLR -lTKTopAlgo -lTKMesh -lTKPrim \
+        -lTKBool -lTKBO -lTKFillet -lTKOffset
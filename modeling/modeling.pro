@@ -0,0 +1,51 @@
+#-------------------------------------------------
+#
+# Headless modeling library: shape construction, booleans, analyses,
+# meshing and the batch runner. It uses no widgets and no viewer, the
+# application and the batch tool link it.
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent
+QT       -= widgets
+
+TARGET = occqtmodeling
+TEMPLATE = lib
+
+CONFIG += staticlib c++11
+
+SOURCES += shapefactory.cpp \
+    topologyindex.cpp \
+    featuregraph.cpp \
+    meshcache.cpp \
+    analyticmesher.cpp \
+    scenegenerator.cpp \
+    shapehealer.cpp \
+    massproperties.cpp \
+    broadphase.cpp \
+    interferencecheck.cpp \
+    clearancequery.cpp \
+    gltfexporter.cpp \
+    drawingexporter.cpp \
+    toolkitplugins.cpp \
+    batchrunner.cpp
+
+HEADERS  += shapefactory.h \
+    topologyindex.h \
+    featuregraph.h \
+    meshcache.h \
+    analyticmesher.h \
+    scenegenerator.h \
+    shapehealer.h \
+    massproperties.h \
+    broadphase.h \
+    interferencecheck.h \
+    clearancequery.h \
+    gltfexporter.h \
+    drawingexporter.h \
+    shapeexchange.h \
+    shapecache.h \
+    toolkitplugins.h \
+    batchrunner.h
+
+INCLUDEPATH += /usr/include/oce
@@ -0,0 +1,170 @@
+#include "scenegenerator.h"
+#include "shapefactory.h"
+
+#include <qmath.h>
+
+#include <Standard_Failure.hxx>
+#include <gp.hxx>
+#include <gp_Ax2.hxx>
+
+namespace
+{
+    //! size of one grid cell, every item fits in a cell.
+    const Standard_Real THE_CELL = 10.0;
+
+    //! gap between the blocks of two kinds.
+    const Standard_Real THE_GAP = 20.0;
+}
+
+SceneGenerator::SceneGenerator(const quint32 theSeed)
+    : mEngine(theSeed),
+      mFailures(0)
+{
+}
+
+QStringList SceneGenerator::kinds()
+{
+    return QStringList() << "box" << "cone" << "sphere" << "cylinder" << "torus"
+                         << "fillet" << "chamfer" << "cut" << "fuse" << "common";
+}
+
+int SceneGenerator::failures() const
+{
+    return mFailures;
+}
+
+Standard_Real SceneGenerator::uniform(const Standard_Real theMin, const Standard_Real theMax)
+{
+    // std::uniform_real_distribution is not specified bit for bit, scale the raw engine instead.
+    const Standard_Real aUnit = Standard_Real(mEngine() - mEngine.min()) / Standard_Real(mEngine.max() - mEngine.min());
+
+    return theMin + (theMax - theMin) * aUnit;
+}
+
+QVector<SceneGenerator::Item> SceneGenerator::generate(const int theCount)
+{
+    QVector<Item> anItems;
+    mFailures = 0;
+
+    if (theCount <= 0)
+    {
+        return anItems;
+    }
+
+    const QStringList aKinds = kinds();
+    const int aSide = qCeil(qSqrt(Standard_Real(theCount)));
+    const Standard_Real aBlock = aSide * THE_CELL + THE_GAP;
+
+    anItems.reserve(theCount * aKinds.size());
+
+    for (int k = 0; k < aKinds.size(); ++k)
+    {
+        for (int i = 0; i < theCount; ++i)
+        {
+            const gp_Pnt aCorner(k * aBlock + (i % aSide) * THE_CELL, (i / aSide) * THE_CELL, 0.0);
+
+            Item anItem;
+            anItem.kind = aKinds.at(k);
+
+            // draws are sequenced explicitly, argument evaluation order is unspecified.
+            const Standard_Real aRed = uniform(0.2, 1.0);
+            const Standard_Real aGreen = uniform(0.2, 1.0);
+            const Standard_Real aBlue = uniform(0.2, 1.0);
+            anItem.color = Quantity_Color(aRed, aGreen, aBlue, Quantity_TOC_RGB);
+
+            try
+            {
+                anItem.shape = makeItem(anItem.kind, aCorner);
+            }
+            catch (Standard_Failure)
+            {
+                ++mFailures;
+                continue;
+            }
+
+            if (anItem.shape.IsNull())
+            {
+                ++mFailures;
+                continue;
+            }
+
+            anItems.append(anItem);
+        }
+    }
+
+    return anItems;
+}
+
+TopoDS_Shape SceneGenerator::makeItem(const QString& theKind, const gp_Pnt& theCorner)
+{
+    // primitives are centred in the cell, their size is at most 8 x 8.
+    const gp_Ax2 aCentre(theCorner.Translated(gp_Vec(THE_CELL / 2.0, THE_CELL / 2.0, 0.0)), gp::DZ());
+    const gp_Ax2 aCorner(theCorner.Translated(gp_Vec(1.0, 1.0, 0.0)), gp::DZ());
+
+    if (theKind == "box")
+    {
+        const Standard_Real aDx = uniform(1.0, 8.0);
+        const Standard_Real aDy = uniform(1.0, 8.0);
+        const Standard_Real aDz = uniform(1.0, 8.0);
+        return ShapeFactory::makeBox(aCorner, aDx, aDy, aDz);
+    }
+    else if (theKind == "cone")
+    {
+        const Standard_Real aR1 = uniform(1.0, 4.0);
+        const Standard_Real aR2 = uniform(0.0, aR1);
+        const Standard_Real aHeight = uniform(1.0, 8.0);
+        return ShapeFactory::makeCone(aCentre, aR1, aR2, aHeight);
+    }
+    else if (theKind == "sphere")
+    {
+        return ShapeFactory::makeSphere(aCentre, uniform(1.0, 4.0));
+    }
+    else if (theKind == "cylinder")
+    {
+        const Standard_Real aRadius = uniform(1.0, 4.0);
+        const Standard_Real aHeight = uniform(1.0, 8.0);
+        const Standard_Real anAngle = uniform(M_PI_2, 2.0 * M_PI);
+        return ShapeFactory::makeCylinder(aCentre, aRadius, aHeight, anAngle);
+    }
+    else if (theKind == "torus")
+    {
+        const Standard_Real aR1 = uniform(2.0, 3.0);
+        const Standard_Real aR2 = uniform(0.3, aR1 - 1.0);
+        const Standard_Real anAngle = uniform(M_PI_2, 2.0 * M_PI);
+        return ShapeFactory::makeTorus(aCentre, aR1, aR2, anAngle);
+    }
+    else if (theKind == "fillet" || theKind == "chamfer")
+    {
+        const Standard_Real aDx = uniform(2.0, 8.0);
+        const Standard_Real aDy = uniform(2.0, 8.0);
+        const Standard_Real aDz = uniform(2.0, 8.0);
+        const Standard_Real aMax = 0.45 * Min(aDx, Min(aDy, aDz));
+        const TopoDS_Shape aBox = ShapeFactory::makeBox(aCorner, aDx, aDy, aDz);
+
+        return theKind == "fillet" ? ShapeFactory::fillet(aBox, uniform(0.1, aMax))
+                                   : ShapeFactory::chamfer(aBox, uniform(0.1, aMax));
+    }
+
+    // boolean results: a box and a sphere centred on one of its corners, as in testCut.
+    const gp_Ax2 anOperand(theCorner.Translated(gp_Vec(2.0, 2.0, 0.0)), gp::DZ());
+    const Standard_Real aDx = uniform(2.0, 6.0);
+    const Standard_Real aDy = uniform(2.0, 6.0);
+    const Standard_Real aDz = uniform(2.0, 6.0);
+    const TopoDS_Shape aBox = ShapeFactory::makeBox(anOperand, aDx, aDy, aDz);
+    const TopoDS_Shape aSphere = ShapeFactory::makeSphere(anOperand, uniform(1.0, 2.0));
+
+    if (theKind == "cut")
+    {
+        return ShapeFactory::cut(aBox, aSphere);
+    }
+    else if (theKind == "fuse")
+    {
+        return ShapeFactory::fuse(aBox, aSphere);
+    }
+    else if (theKind == "common")
+    {
+        return ShapeFactory::common(aBox, aSphere);
+    }
+
+    return TopoDS_Shape();
+}
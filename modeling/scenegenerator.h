@@ -0,0 +1,47 @@
+#ifndef SCENEGENERATOR_H
+#define SCENEGENERATOR_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <random>
+
+#include <TopoDS_Shape.hxx>
+#include <Quantity_Color.hxx>
+#include <gp_Pnt.hxx>
+
+//! Fills a scene with random primitives and modeling results for scaling tests.
+//! Each kind gets its own square block of cells, parameters are drawn from a
+//! seeded engine so the same seed and count always give the same scene.
+class SceneGenerator
+{
+public:
+    struct Item
+    {
+        TopoDS_Shape shape;
+        Quantity_Color color;
+        QString kind;
+    };
+
+    explicit SceneGenerator(const quint32 theSeed = 42);
+
+    //! theCount shapes of every kind; kinds whose algorithm fails for a draw are skipped.
+    QVector<Item> generate(const int theCount);
+
+    //! the generated kinds: primitives first, then modeling results.
+    static QStringList kinds();
+
+    //! number of draws that failed in the last generate().
+    int failures() const;
+
+private:
+    TopoDS_Shape makeItem(const QString& theKind, const gp_Pnt& theCorner);
+
+    Standard_Real uniform(const Standard_Real theMin, const Standard_Real theMax);
+
+    std::mt19937 mEngine;
+    int mFailures;
+};
+
+#endif // SCENEGENERATOR_H
@@ -0,0 +1,116 @@
+#ifndef SHAPECACHE_H
+#define SHAPECACHE_H
+
+#include <QHash>
+#include <QMutableHashIterator>
+#include <QPair>
+#include <QQueue>
+
+#include <climits>
+
+#include <TopoDS_Shape.hxx>
+
+//! A bounded cache of values computed for shapes, e.g. boxes, sections or
+//! mass properties. Values are keyed by the identity of the shape, its TShape
+//! and location, and by an optional extra key such as a plane or a precision.
+//! A modified shape has a new identity and misses, while undo gives back a
+//! shape whose values are still cached. A hit also checks IsSame(), so a hash
+//! collision never returns the value of another shape. Beyond the limit the
+//! oldest values are dropped.
+template <typename T, typename Extra = int>
+class ShapeCache
+{
+public:
+    explicit ShapeCache(const int theLimit)
+        : mLimit(theLimit)
+    {
+    }
+
+    //! the value cached for theShape and theExtra, false when there is none.
+    bool find(const TopoDS_Shape& theShape, T& theValue, const Extra& theExtra = Extra()) const
+    {
+        typename QHash<Key, Entry>::const_iterator anIter = mEntries.constFind(keyOf(theShape, theExtra));
+
+        if (anIter == mEntries.constEnd() || !anIter.value().shape.IsSame(theShape))
+        {
+            return false;
+        }
+
+        theValue = anIter.value().value;
+
+        return true;
+    }
+
+    void insert(const TopoDS_Shape& theShape, const T& theValue, const Extra& theExtra = Extra())
+    {
+        const Key aKey = keyOf(theShape, theExtra);
+
+        if (!mEntries.contains(aKey))
+        {
+            mOrder.enqueue(aKey);
+        }
+
+        Entry anEntry;
+        anEntry.shape = theShape;
+        anEntry.value = theValue;
+
+        mEntries.insert(aKey, anEntry);
+
+        while (mOrder.size() > mLimit)
+        {
+            mEntries.remove(mOrder.dequeue());
+        }
+    }
+
+    //! drop the values of theShape for all the extra keys.
+    void remove(const TopoDS_Shape& theShape)
+    {
+        QMutableHashIterator<Key, Entry> anIter(mEntries);
+
+        while (anIter.hasNext())
+        {
+            anIter.next();
+
+            if (anIter.value().shape.IsSame(theShape))
+            {
+                mOrder.removeOne(anIter.key());
+                anIter.remove();
+            }
+        }
+    }
+
+    void clear()
+    {
+        mEntries.clear();
+        mOrder.clear();
+    }
+
+    int size() const
+    {
+        return mEntries.size();
+    }
+
+private:
+    typedef QPair<QPair<const void*, int>, Extra> Key;
+
+    struct Entry
+    {
+        TopoDS_Shape shape;
+        T value;
+    };
+
+    static Key keyOf(const TopoDS_Shape& theShape, const Extra& theExtra)
+    {
+        // the TShape and the location, the orientation does not change the values.
+        return Key(qMakePair(static_cast<const void*>(theShape.TShape().operator->()), theShape.HashCode(INT_MAX)), theExtra);
+    }
+
+    int mLimit;
+
+    QHash<Key, Entry> mEntries;
+
+    //! the keys in insertion order, for the eviction.
+    QQueue<Key> mOrder;
+};
+
+#endif // SHAPECACHE_H
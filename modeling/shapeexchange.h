@@ -0,0 +1,28 @@
+#ifndef SHAPEEXCHANGE_H
+#define SHAPEEXCHANGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QtPlugin>
+
+#include <TopoDS_Shape.hxx>
+
+//! Interface of the data exchange plugin. The STEP, IGES and STL toolkits
+//! are only linked by the plugin, which ToolkitPlugins loads on first use.
+class ShapeExchange
+{
+public:
+    virtual ~ShapeExchange() {}
+
+    //! the lower case file suffixes written, e.g. "step".
+    virtual QStringList formats() const = 0;
+
+    //! write theShape in the format given by the suffix of theFileName.
+    virtual bool write(const TopoDS_Shape& theShape, const QString& theFileName, QString& theError) = 0;
+};
+
+#define ShapeExchange_iid "org.occqt.ShapeExchange/1.0"
+
+Q_DECLARE_INTERFACE(ShapeExchange, ShapeExchange_iid)
+
+#endif // SHAPEEXCHANGE_H
@@ -0,0 +1,259 @@
+#include "shapefactory.h"
+#include "topologyindex.h"
+
+#include <Standard_Failure.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepBuilderAPI_Transform.hxx>
+#include <BRepTools_ReShape.hxx>
+#include <Poly_PolygonOnTriangulation.hxx>
+#include <Poly_Triangulation.hxx>
+
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCone.hxx>
+#include <BRepPrimAPI_MakeSphere.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepPrimAPI_MakeTorus.hxx>
+#include <BRepPrimAPI_MakePrism.hxx>
+#include <BRepPrimAPI_MakeRevol.hxx>
+#include <BRepOffsetAPI_ThruSections.hxx>
+#include <BRepFilletAPI_MakeFillet.hxx>
+#include <BRepFilletAPI_MakeChamfer.hxx>
+
+#include <BRepAlgoAPI_Cut.hxx>
+#include <BRepAlgoAPI_Fuse.hxx>
+#include <BRepAlgoAPI_Common.hxx>
+#include <BRepAlgoAPI_Section.hxx>
+
+TopoDS_Shape ShapeFactory::makeBox(const gp_Ax2& theAxis, const Standard_Real theDx, const Standard_Real theDy, const Standard_Real theDz)
+{
+    return BRepPrimAPI_MakeBox(theAxis, theDx, theDy, theDz).Shape();
+}
+
+TopoDS_Shape ShapeFactory::makeCone(const gp_Ax2& theAxis, const Standard_Real theR1, const Standard_Real theR2, const Standard_Real theHeight)
+{
+    return BRepPrimAPI_MakeCone(theAxis, theR1, theR2, theHeight).Shape();
+}
+
+TopoDS_Shape ShapeFactory::makeSphere(const gp_Ax2& theAxis, const Standard_Real theRadius)
+{
+    return BRepPrimAPI_MakeSphere(theAxis, theRadius).Shape();
+}
+
+TopoDS_Shape ShapeFactory::makeCylinder(const gp_Ax2& theAxis, const Standard_Real theRadius, const Standard_Real theHeight, const Standard_Real theAngle)
+{
+    return BRepPrimAPI_MakeCylinder(theAxis, theRadius, theHeight, theAngle).Shape();
+}
+
+TopoDS_Shape ShapeFactory::makeTorus(const gp_Ax2& theAxis, const Standard_Real theR1, const Standard_Real theR2, const Standard_Real theAngle)
+{
+    return BRepPrimAPI_MakeTorus(theAxis, theR1, theR2, theAngle).Shape();
+}
+
+TopoDS_Shape ShapeFactory::fillet(const TopoDS_Shape& theShape, const Standard_Real theRadius)
+{
+    const TopoDS_Shape aShape = workingCopy(theShape);
+    BRepFilletAPI_MakeFillet MF(aShape);
+
+    // Add all the edges to fillet, each shared edge once.
+    QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(aShape);
+    const TopTools_IndexedMapOfShape& anEdges = anIndex->edges();
+
+    for (Standard_Integer i = 1; i <= anEdges.Extent(); ++i)
+    {
+        MF.Add(theRadius, TopoDS::Edge(anEdges(i)));
+    }
+
+    return MF.Shape();
+}
+
+TopoDS_Shape ShapeFactory::chamfer(const TopoDS_Shape& theShape, const Standard_Real theDistance)
+{
+    const TopoDS_Shape aShape = workingCopy(theShape);
+    BRepFilletAPI_MakeChamfer MC(aShape);
+    QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(aShape);
+    const TopTools_IndexedDataMapOfShapeListOfShape& aEdgeFaceMap = anIndex->edgeFaces();
+
+    for (Standard_Integer i = 1; i <= aEdgeFaceMap.Extent(); ++i)
+    {
+        if (aEdgeFaceMap.FindFromIndex(i).IsEmpty())
+        {
+            continue;
+        }
+
+        TopoDS_Edge anEdge = TopoDS::Edge(aEdgeFaceMap.FindKey(i));
+        TopoDS_Face aFace = TopoDS::Face(aEdgeFaceMap.FindFromIndex(i).First());
+
+        MC.Add(theDistance, theDistance, anEdge, aFace);
+    }
+
+    return MC.Shape();
+}
+
+TopoDS_Shape ShapeFactory::cut(const TopoDS_Shape& theShape, const TopoDS_Shape& theTool)
+{
+    return BRepAlgoAPI_Cut(workingCopy(theShape), workingCopy(theTool));
+}
+
+TopoDS_Shape ShapeFactory::fuse(const TopoDS_Shape& theShape1, const TopoDS_Shape& theShape2)
+{
+    return BRepAlgoAPI_Fuse(workingCopy(theShape1), workingCopy(theShape2));
+}
+
+TopoDS_Shape ShapeFactory::common(const TopoDS_Shape& theShape1, const TopoDS_Shape& theShape2)
+{
+    return BRepAlgoAPI_Common(workingCopy(theShape1), workingCopy(theShape2));
+}
+
+TopoDS_Shape ShapeFactory::section(const TopoDS_Shape& theShape, const gp_Pln& thePlane)
+{
+    BRepAlgoAPI_Section aSection(workingCopy(theShape), thePlane, Standard_False);
+    aSection.ComputePCurveOn1(Standard_False);
+    aSection.Approximation(Standard_False);
+    aSection.Build();
+
+    return aSection.Shape();
+}
+
+TopoDS_Shape ShapeFactory::prism(const TopoDS_Shape& theProfile, const gp_Vec& theVector)
+{
+    return BRepPrimAPI_MakePrism(theProfile, theVector).Shape();
+}
+
+TopoDS_Shape ShapeFactory::revolved(const TopoDS_Shape& theProfile, const gp_Ax1& theAxis, const Standard_Real theAngle)
+{
+    return BRepPrimAPI_MakeRevol(theProfile, theAxis, theAngle).Shape();
+}
+
+TopoDS_Shape ShapeFactory::loft(const QList<TopoDS_Wire>& theSections, const bool isSolid)
+{
+    BRepOffsetAPI_ThruSections aGenerator(isSolid);
+
+    foreach (const TopoDS_Wire& aSection, theSections)
+    {
+        aGenerator.AddWire(aSection);
+    }
+
+    return aGenerator.Shape();
+}
+
+TopoDS_Shape ShapeFactory::translated(const TopoDS_Shape& theShape, const gp_Vec& theVector)
+{
+    gp_Trsf aTrsf;
+    aTrsf.SetTranslation(theVector);
+
+    return transformed(theShape, aTrsf);
+}
+
+TopoDS_Shape ShapeFactory::transformed(const TopoDS_Shape& theShape, const gp_Trsf& theTrsf)
+{
+    BRepBuilderAPI_Transform aTransform(theShape, theTrsf);
+
+    return aTransform.Shape();
+}
+
+TopoDS_Shape ShapeFactory::copied(const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return theShape;
+    }
+
+    return BRepBuilderAPI_Copy(theShape).Shape();
+}
+
+TopoDS_Shape ShapeFactory::workingCopy(const TopoDS_Shape& theShape)
+{
+    if (theShape.IsNull())
+    {
+        return theShape;
+    }
+
+    // the algorithms write tolerances, pcurves and flags into the topology,
+    // the curves and surfaces they change are replaced, not modified.
+    BRepBuilderAPI_Copy aCopy(theShape, Standard_False);
+
+    try
+    {
+        BRep_Builder aBuilder;
+        QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(theShape);
+        const TopTools_IndexedMapOfShape& aFaces = anIndex->faces();
+
+        for (Standard_Integer i = 1; i <= aFaces.Extent(); ++i)
+        {
+            const TopoDS_Face& aFace = TopoDS::Face(aFaces(i));
+
+            TopLoc_Location aLocation;
+            const Handle(Poly_Triangulation) aTriangulation = BRep_Tool::Triangulation(aFace, aLocation);
+
+            if (aTriangulation.IsNull())
+            {
+                continue;
+            }
+
+            aBuilder.UpdateFace(TopoDS::Face(aCopy.Modified(aFace).First()), aTriangulation);
+
+            // the polygons of the edges on the triangulation, a mesh is only complete with them.
+            for (TopExp_Explorer anExp(aFace, TopAbs_EDGE); anExp.More(); anExp.Next())
+            {
+                const TopoDS_Edge& anEdge = TopoDS::Edge(anExp.Current());
+                const TopoDS_Edge aCopiedEdge = TopoDS::Edge(aCopy.Modified(anEdge).First());
+
+                if (BRep_Tool::IsClosed(anEdge, aFace))
+                {
+                    const Handle(Poly_PolygonOnTriangulation) aForward = BRep_Tool::PolygonOnTriangulation(
+                                TopoDS::Edge(anEdge.Oriented(TopAbs_FORWARD)), aTriangulation, aLocation);
+                    const Handle(Poly_PolygonOnTriangulation) aReversed = BRep_Tool::PolygonOnTriangulation(
+                                TopoDS::Edge(anEdge.Oriented(TopAbs_REVERSED)), aTriangulation, aLocation);
+
+                    if (!aForward.IsNull() && !aReversed.IsNull())
+                    {
+                        aBuilder.UpdateEdge(aCopiedEdge, aForward, aReversed, aTriangulation, aLocation);
+                    }
+                }
+                else
+                {
+                    const Handle(Poly_PolygonOnTriangulation) aPolygon = BRep_Tool::PolygonOnTriangulation(anEdge, aTriangulation, aLocation);
+
+                    if (!aPolygon.IsNull())
+                    {
+                        aBuilder.UpdateEdge(aCopiedEdge, aPolygon, aTriangulation, aLocation);
+                    }
+                }
+            }
+        }
+    }
+    catch (Standard_Failure)
+    {
+        // the copy is complete, only some of its faces will be meshed again.
+    }
+
+    return aCopy.Shape();
+}
+
+TopoDS_Shape ShapeFactory::replaced(const TopoDS_Shape& theShape, const TopoDS_Shape& theOld, const TopoDS_Shape& theNew)
+{
+    // a private ReShape per call, the history is not shared between threads.
+    Handle(BRepTools_ReShape) aReShape = new BRepTools_ReShape();
+    aReShape->Replace(theOld, theNew, Standard_True);
+
+    return aReShape->Apply(theShape);
+}
+
+Bnd_Box ShapeFactory::boundingBox(const TopoDS_Shape& theShape)
+{
+    Bnd_Box aBox;
+    BRepBndLib::Add(theShape, aBox);
+
+    return aBox;
+}
+
+TopoDS_Shape ShapeFactory::makeBox(const Bnd_Box& theBox)
+{
+    return BRepPrimAPI_MakeBox(theBox.CornerMin(), theBox.CornerMax()).Shape();
+}
@@ -0,0 +1,75 @@
+#ifndef SHAPEFACTORY_H
+#define SHAPEFACTORY_H
+
+#include <cmath>
+
+#include <QList>
+
+#include <TopoDS_Shape.hxx>
+#include <TopoDS_Wire.hxx>
+#include <Bnd_Box.hxx>
+#include <gp_Ax1.hxx>
+#include <gp_Ax2.hxx>
+#include <gp_Pln.hxx>
+#include <gp_Trsf.hxx>
+#include <gp_Vec.hxx>
+
+//! The modeling operations behind the MainWindow test slots, without any
+//! viewer or context, so they can be reused by generators and batch jobs.
+//! Failures of the OCC algorithms are reported as Standard_Failure.
+//!
+//! The functions keep no state and leave their arguments untouched, so
+//! threads may share inputs and displayed shapes may be operands. The
+//! booleans, fillets and chamfers write into the topology they work on, they
+//! run on working copies of their inputs.
+class ShapeFactory
+{
+public:
+    //! primitives.
+    static TopoDS_Shape makeBox(const gp_Ax2& theAxis, const Standard_Real theDx, const Standard_Real theDy, const Standard_Real theDz);
+    static TopoDS_Shape makeCone(const gp_Ax2& theAxis, const Standard_Real theR1, const Standard_Real theR2, const Standard_Real theHeight);
+    static TopoDS_Shape makeSphere(const gp_Ax2& theAxis, const Standard_Real theRadius);
+    static TopoDS_Shape makeCylinder(const gp_Ax2& theAxis, const Standard_Real theRadius, const Standard_Real theHeight, const Standard_Real theAngle = 2.0 * M_PI);
+    static TopoDS_Shape makeTorus(const gp_Ax2& theAxis, const Standard_Real theR1, const Standard_Real theR2, const Standard_Real theAngle = 2.0 * M_PI);
+
+    //! round or bevel every edge of the shape.
+    static TopoDS_Shape fillet(const TopoDS_Shape& theShape, const Standard_Real theRadius);
+    static TopoDS_Shape chamfer(const TopoDS_Shape& theShape, const Standard_Real theDistance);
+
+    //! boolean operations.
+    static TopoDS_Shape cut(const TopoDS_Shape& theShape, const TopoDS_Shape& theTool);
+    static TopoDS_Shape fuse(const TopoDS_Shape& theShape1, const TopoDS_Shape& theShape2);
+    static TopoDS_Shape common(const TopoDS_Shape& theShape1, const TopoDS_Shape& theShape2);
+
+    //! the section edges of the shape by a plane, not approximated and without pcurves.
+    static TopoDS_Shape section(const TopoDS_Shape& theShape, const gp_Pln& thePlane);
+
+    //! sweeps: a vertex gives an edge, an edge a face, a wire a shell and a face a solid.
+    static TopoDS_Shape prism(const TopoDS_Shape& theProfile, const gp_Vec& theVector);
+    static TopoDS_Shape revolved(const TopoDS_Shape& theProfile, const gp_Ax1& theAxis, const Standard_Real theAngle = 2.0 * M_PI);
+
+    //! a shell or a solid through the section wires, in order.
+    static TopoDS_Shape loft(const QList<TopoDS_Wire>& theSections, const bool isSolid);
+
+    //! a translated copy of the shape.
+    static TopoDS_Shape translated(const TopoDS_Shape& theShape, const gp_Vec& theVector);
+    static TopoDS_Shape transformed(const TopoDS_Shape& theShape, const gp_Trsf& theTrsf);
+
+    //! a copy sharing no topology and no geometry with theShape.
+    static TopoDS_Shape copied(const TopoDS_Shape& theShape);
+
+    //! theShape with its sub-shape theOld replaced by theNew.
+    static TopoDS_Shape replaced(const TopoDS_Shape& theShape, const TopoDS_Shape& theOld, const TopoDS_Shape& theNew);
+
+    //! the box of the shape, tight around its triangulation if it has one.
+    static Bnd_Box boundingBox(const TopoDS_Shape& theShape);
+    static TopoDS_Shape makeBox(const Bnd_Box& theBox);
+
+private:
+    //! a copy of theShape for an algorithm that writes into its arguments.
+    //! Only the topology is copied, the geometry and the face meshes are
+    //! shared, so the faces the algorithm keeps need no new mesh.
+    static TopoDS_Shape workingCopy(const TopoDS_Shape& theShape);
+};
+
+#endif // SHAPEFACTORY_H
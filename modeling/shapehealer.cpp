@@ -0,0 +1,193 @@
+#include "shapehealer.h"
+#include "shapefactory.h"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QStringList>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+
+#include <BRepCheck_Analyzer.hxx>
+#include <BRepCheck_ListIteratorOfListOfStatus.hxx>
+#include <BRepCheck_Result.hxx>
+#include <ShapeExtend_Status.hxx>
+#include <ShapeFix_Shape.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopTools_MapOfShape.hxx>
+
+namespace
+{
+    //! the sub-shapes of the type that carry a check error.
+    int countInvalid(const BRepCheck_Analyzer& theAnalyzer, const TopoDS_Shape& theShape, const TopAbs_ShapeEnum theType)
+    {
+        int aCount = 0;
+        TopTools_MapOfShape aVisited;
+
+        for (TopExp_Explorer anExp(theShape, theType); anExp.More(); anExp.Next())
+        {
+            if (!aVisited.Add(anExp.Current()))
+            {
+                continue;
+            }
+
+            const Handle(BRepCheck_Result)& aResult = theAnalyzer.Result(anExp.Current());
+
+            if (aResult.IsNull())
+            {
+                continue;
+            }
+
+            BRepCheck_ListIteratorOfListOfStatus aStatus(aResult->Status());
+
+            if (aStatus.More() && aStatus.Value() != BRepCheck_NoError)
+            {
+                ++aCount;
+            }
+        }
+
+        return aCount;
+    }
+}
+
+ShapeHealer::ShapeHealer()
+    : mTolerance(0.0)
+{
+}
+
+void ShapeHealer::setTolerance(const Standard_Real theTolerance)
+{
+    mTolerance = theTolerance;
+}
+
+void ShapeHealer::add(const unsigned int theId, const TopoDS_Shape& theShape)
+{
+    Report aReport;
+    aReport.id = theId;
+    aReport.shape = theShape;
+
+    mReports.append(aReport);
+}
+
+QVector<ShapeHealer::Report> ShapeHealer::run()
+{
+    const Standard_Real aTolerance = mTolerance;
+
+    QtConcurrent::blockingMap(mReports, [aTolerance](Report& theReport)
+    {
+        const unsigned int anId = theReport.id;
+
+        theReport = heal(theReport.shape, aTolerance);
+        theReport.id = anId;
+    });
+
+    return mReports;
+}
+
+ShapeHealer::Report ShapeHealer::heal(const TopoDS_Shape& theShape, const Standard_Real theTolerance)
+{
+    QElapsedTimer aTimer;
+    aTimer.start();
+
+    Report aReport;
+    aReport.id = 0;
+    aReport.wasValid = false;
+    aReport.isValid = false;
+    aReport.isChanged = false;
+    aReport.shape = theShape;
+    aReport.invalidFaces = 0;
+    aReport.invalidEdges = 0;
+    aReport.invalidVertices = 0;
+
+    if (theShape.IsNull())
+    {
+        aReport.error = "null shape";
+        aReport.time = aTimer.elapsed();
+        return aReport;
+    }
+
+    try
+    {
+        BRepCheck_Analyzer anAnalyzer(theShape);
+        aReport.wasValid = anAnalyzer.IsValid();
+        aReport.isValid = aReport.wasValid;
+
+        if (!aReport.wasValid)
+        {
+            aReport.invalidFaces = countInvalid(anAnalyzer, theShape, TopAbs_FACE);
+            aReport.invalidEdges = countInvalid(anAnalyzer, theShape, TopAbs_EDGE);
+            aReport.invalidVertices = countInvalid(anAnalyzer, theShape, TopAbs_VERTEX);
+
+            // the fixer modifies the topology it is given, the shape may be displayed or shared.
+            Handle(ShapeFix_Shape) aFixer = new ShapeFix_Shape(ShapeFactory::copied(theShape));
+
+            if (theTolerance > 0.0)
+            {
+                aFixer->SetPrecision(theTolerance);
+            }
+
+            aFixer->Perform();
+
+            const TopoDS_Shape aFixed = aFixer->Shape();
+
+            aReport.isChanged = !aFixed.IsNull() && aFixer->Status(ShapeExtend_DONE);
+
+            if (aReport.isChanged)
+            {
+                aReport.shape = aFixed;
+                aReport.isValid = BRepCheck_Analyzer(aFixed).IsValid();
+            }
+        }
+    }
+    catch (Standard_Failure)
+    {
+        aReport.error = QString("OCC failure: %1").arg(Standard_Failure::Caught()->GetMessageString());
+    }
+
+    aReport.time = aTimer.elapsed();
+
+    return aReport;
+}
+
+QString ShapeHealer::describe(const Report& theReport)
+{
+    QString aState;
+
+    if (!theReport.error.isEmpty())
+    {
+        aState = theReport.error;
+    }
+    else if (theReport.wasValid)
+    {
+        aState = QObject::tr("valid");
+    }
+    else
+    {
+        aState = theReport.isValid ? QObject::tr("fixed") : (theReport.isChanged ? QObject::tr("still invalid after fixing")
+                                                                                 : QObject::tr("invalid, not fixed"));
+
+        QStringList anIssues;
+
+        if (theReport.invalidFaces > 0)
+        {
+            anIssues.append(QObject::tr("%1 invalid faces").arg(theReport.invalidFaces));
+        }
+
+        if (theReport.invalidEdges > 0)
+        {
+            anIssues.append(QObject::tr("%1 invalid edges").arg(theReport.invalidEdges));
+        }
+
+        if (theReport.invalidVertices > 0)
+        {
+            anIssues.append(QObject::tr("%1 invalid vertices").arg(theReport.invalidVertices));
+        }
+
+        if (!anIssues.isEmpty())
+        {
+            aState += ", " + anIssues.join(", ");
+        }
+    }
+
+    return QObject::tr("shape %1: %2 (%3 ms)").arg(theReport.id).arg(aState).arg(theReport.time);
+}
@@ -0,0 +1,58 @@
+#ifndef SHAPEHEALER_H
+#define SHAPEHEALER_H
+
+#include <QString>
+#include <QVector>
+
+#include <TopoDS_Shape.hxx>
+
+//! Validity check and repair of shapes.
+//! Each shape is checked with BRepCheck_Analyzer, only invalid shapes go
+//! through ShapeFix_Shape and are checked again. The fix works on a copy,
+//! the original shape is never modified. A batch of shapes is processed on
+//! the thread pool, one shape per task.
+class ShapeHealer
+{
+public:
+    struct Report
+    {
+        unsigned int id;
+
+        bool wasValid;
+        bool isValid;
+
+        //! the fixed shape is a different one, the caller should replace the original.
+        bool isChanged;
+        TopoDS_Shape shape;
+
+        //! invalid sub-shapes found by the first check.
+        int invalidFaces;
+        int invalidEdges;
+        int invalidVertices;
+
+        QString error;
+        qint64 time;
+    };
+
+    ShapeHealer();
+
+    //! precision given to the fixing tools, their default when 0 or less.
+    void setTolerance(const Standard_Real theTolerance);
+
+    void add(const unsigned int theId, const TopoDS_Shape& theShape);
+
+    //! check and fix all the added shapes in parallel, one report each in order.
+    QVector<Report> run();
+
+    //! check and fix a single shape on the calling thread.
+    static Report heal(const TopoDS_Shape& theShape, const Standard_Real theTolerance);
+
+    //! one line per report, e.g. "shape 3: fixed, 2 invalid faces".
+    static QString describe(const Report& theReport);
+
+private:
+    Standard_Real mTolerance;
+    QVector<Report> mReports;
+};
+
+#endif // SHAPEHEALER_H
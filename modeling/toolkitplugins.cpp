@@ -0,0 +1,81 @@
+#include "toolkitplugins.h"
+#include "shapeexchange.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPluginLoader>
+#include <QStringList>
+
+namespace
+{
+    //! batch jobs may ask from several threads at once.
+    QMutex THE_PLUGIN_MUTEX;
+
+    ShapeExchange* THE_EXCHANGE = 0;
+    QString THE_EXCHANGE_ERROR;
+
+    //! the plugin object, it lives until the application exits.
+    QObject* loadPlugin(const QString& theName, QString& theError)
+    {
+        QStringList aDirectories;
+
+        if (!qgetenv("OCCQT_PLUGIN_PATH").isEmpty())
+        {
+            aDirectories.append(QString::fromLocal8Bit(qgetenv("OCCQT_PLUGIN_PATH")));
+        }
+
+        aDirectories.append(QDir(QCoreApplication::applicationDirPath()).filePath("plugins"));
+
+        QStringList anErrors;
+
+        foreach (const QString& aDirectory, aDirectories)
+        {
+            QPluginLoader aLoader(QDir(aDirectory).filePath(theName));
+            QObject* anInstance = aLoader.instance();
+
+            if (anInstance)
+            {
+                return anInstance;
+            }
+
+            anErrors.append(aLoader.errorString());
+        }
+
+        theError = anErrors.join("; ");
+
+        return 0;
+    }
+}
+
+ShapeExchange* ToolkitPlugins::exchange(QString* theError)
+{
+    QMutexLocker aLocker(&THE_PLUGIN_MUTEX);
+
+    // a failed load is not retried, the error stays.
+    if (THE_EXCHANGE == 0 && THE_EXCHANGE_ERROR.isEmpty())
+    {
+        QObject* aPlugin = loadPlugin("exchange", THE_EXCHANGE_ERROR);
+        THE_EXCHANGE = qobject_cast<ShapeExchange*>(aPlugin);
+
+        if (aPlugin && THE_EXCHANGE == 0)
+        {
+            THE_EXCHANGE_ERROR = "the exchange plugin has a wrong interface version";
+        }
+    }
+
+    if (THE_EXCHANGE == 0 && theError)
+    {
+        *theError = QString("cannot load the data exchange plugin: %1").arg(THE_EXCHANGE_ERROR);
+    }
+
+    return THE_EXCHANGE;
+}
+
+bool ToolkitPlugins::isExchangeLoaded()
+{
+    QMutexLocker aLocker(&THE_PLUGIN_MUTEX);
+
+    return THE_EXCHANGE != 0;
+}
@@ -0,0 +1,21 @@
+#ifndef TOOLKITPLUGINS_H
+#define TOOLKITPLUGINS_H
+
+#include <QString>
+
+class ShapeExchange;
+
+//! Loads the plugins wrapping the heavy OCC toolkits when they are first
+//! needed, so starting the application does not map them. The plugins are
+//! searched in $OCCQT_PLUGIN_PATH, then in "plugins" next to the executable.
+class ToolkitPlugins
+{
+public:
+    //! the data exchange plugin, null with theError set if it can not be loaded.
+    static ShapeExchange* exchange(QString* theError = 0);
+
+    //! whether the data exchange plugin was loaded already.
+    static bool isExchangeLoaded();
+};
+
+#endif // TOOLKITPLUGINS_H
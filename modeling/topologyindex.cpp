@@ -0,0 +1,114 @@
+#include "topologyindex.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <TopExp.hxx>
+
+namespace
+{
+    //! indices kept before the oldest ones are dropped.
+    const int THE_CAPACITY = 256;
+
+    QMutex theCacheMutex;
+
+    //! indices by TShape, the cached shape keeps its TShape alive so the address is not reused.
+    QHash<const void*, QList<QSharedPointer<const TopologyIndex> > > theCache;
+
+    //! insertion order for the eviction.
+    QList<QSharedPointer<const TopologyIndex> > theOrder;
+}
+
+TopologyIndex::TopologyIndex(const TopoDS_Shape& theShape)
+    : mShape(theShape)
+{
+    TopExp::MapShapes(theShape, TopAbs_FACE, mFaces);
+    TopExp::MapShapes(theShape, TopAbs_EDGE, mEdges);
+    TopExp::MapShapes(theShape, TopAbs_VERTEX, mVertices);
+    TopExp::MapShapesAndAncestors(theShape, TopAbs_EDGE, TopAbs_FACE, mEdgeFaces);
+}
+
+QSharedPointer<const TopologyIndex> TopologyIndex::of(const TopoDS_Shape& theShape)
+{
+    const void* aKey = theShape.TShape().Access();
+
+    {
+        QMutexLocker aLocker(&theCacheMutex);
+
+        foreach (const QSharedPointer<const TopologyIndex>& anIndex, theCache.value(aKey))
+        {
+            if (anIndex->shape().IsEqual(theShape))
+            {
+                return anIndex;
+            }
+        }
+    }
+
+    // build outside the lock, two threads may build the same index, one of them wins.
+    QSharedPointer<const TopologyIndex> anIndex(new TopologyIndex(theShape));
+
+    QMutexLocker aLocker(&theCacheMutex);
+
+    QList<QSharedPointer<const TopologyIndex> >& anEntries = theCache[aKey];
+
+    foreach (const QSharedPointer<const TopologyIndex>& anEntry, anEntries)
+    {
+        if (anEntry->shape().IsEqual(theShape))
+        {
+            return anEntry;
+        }
+    }
+
+    anEntries.append(anIndex);
+    theOrder.append(anIndex);
+
+    while (theOrder.size() > THE_CAPACITY)
+    {
+        QSharedPointer<const TopologyIndex> anOldest = theOrder.takeFirst();
+        const void* anOldKey = anOldest->shape().TShape().Access();
+
+        theCache[anOldKey].removeOne(anOldest);
+
+        if (theCache.value(anOldKey).isEmpty())
+        {
+            theCache.remove(anOldKey);
+        }
+    }
+
+    return anIndex;
+}
+
+void TopologyIndex::clearCache()
+{
+    QMutexLocker aLocker(&theCacheMutex);
+
+    theCache.clear();
+    theOrder.clear();
+}
+
+const TopoDS_Shape& TopologyIndex::shape() const
+{
+    return mShape;
+}
+
+const TopTools_IndexedMapOfShape& TopologyIndex::faces() const
+{
+    return mFaces;
+}
+
+const TopTools_IndexedMapOfShape& TopologyIndex::edges() const
+{
+    return mEdges;
+}
+
+const TopTools_IndexedMapOfShape& TopologyIndex::vertices() const
+{
+    return mVertices;
+}
+
+const TopTools_IndexedDataMapOfShapeListOfShape& TopologyIndex::edgeFaces() const
+{
+    return mEdgeFaces;
+}
@@ -0,0 +1,42 @@
+#ifndef TOPOLOGYINDEX_H
+#define TOPOLOGYINDEX_H
+
+#include <QSharedPointer>
+
+#include <TopoDS_Shape.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+#include <TopTools_IndexedDataMapOfShapeListOfShape.hxx>
+
+//! Indexed sub-shapes of a shape: each face, edge and vertex once, plus the
+//! faces around each edge. Built on the first request and shared, so selection,
+//! fillet/chamfer and export code stop re-exploring the same B-Rep.
+class TopologyIndex
+{
+public:
+    //! the index of theShape, from the cache or built now. Thread safe.
+    static QSharedPointer<const TopologyIndex> of(const TopoDS_Shape& theShape);
+
+    //! drop all the cached indices.
+    static void clearCache();
+
+    const TopoDS_Shape& shape() const;
+
+    const TopTools_IndexedMapOfShape& faces() const;
+    const TopTools_IndexedMapOfShape& edges() const;
+    const TopTools_IndexedMapOfShape& vertices() const;
+
+    //! the faces of each edge, free edges have an empty list.
+    const TopTools_IndexedDataMapOfShapeListOfShape& edgeFaces() const;
+
+private:
+    explicit TopologyIndex(const TopoDS_Shape& theShape);
+
+    TopoDS_Shape mShape;
+
+    TopTools_IndexedMapOfShape mFaces;
+    TopTools_IndexedMapOfShape mEdges;
+    TopTools_IndexedMapOfShape mVertices;
+    TopTools_IndexedDataMapOfShapeListOfShape mEdgeFaces;
+};
+
+#endif // TOPOLOGYINDEX_H
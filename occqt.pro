@@ -0,0 +1,25 @@
+#-------------------------------------------------
+#
+# The modeling library, the application, the headless batch tool, the
+# data exchange plugin and the tests.
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += modeling \
+    app \
+    batch \
+    exchange \
+    tests
+
+# the exchange plugin is loaded at run time, nothing links it: building the
+# application or the batch tool alone must still build it.
+app.file = OccWidget.pro
+app.depends = modeling exchange
+
+batch.depends = modeling exchange
+
+exchange.subdir = plugins/exchange
+
+tests.depends = modeling exchange
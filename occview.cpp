@@ -1,4 +1,7 @@
 #include "occview.h"
+#include "selectionactivator.h"
+#include "sectionplanes.h"
+#include "inputtrace.h"
 
 #include <QStyleFactory>
 
@@ -15,21 +18,37 @@
 OccView::OccView(Handle_AIS_InteractiveContext theContext, QWidget *parent)
     : QWidget(parent),
       myContext(theContext),
+      mSelectionActivator(NULL),
+      mSectionPlanes(NULL),
+      mCuller(theContext),
+      mRecording(NULL),
       mXmin(0),
       mXmax(0),
       mYmin(0),
       mYmax(0),
       mDegenerateModeIsOn(Standard_True),
       mCurrentMode(CurAction3d_DynamicRotation),
-      mRectBand(NULL)
+      mRectBand(NULL),
+      mHasPainted(false)
 {
+    // OpenGL draws into the native window, Qt must neither erase nor paint it;
+    // otherwise the background covers the first frames until the next resize.
+    setAttribute(Qt::WA_PaintOnScreen);
+    setAttribute(Qt::WA_NoSystemBackground);
 
-//    myView = theContext->CurrentViewer()->CreateView();
+    this->setMouseTracking( true );
+}
 
-//    myContext = new AIS_InteractiveContext(myViewer);
+void OccView::init()
+{
+    if ( !myView.IsNull() )
+    {
+        return;
+    }
 
-    if ( myView.IsNull() )
-      myView = theContext->CurrentViewer()->CreateView();
+    // the window and its GL context are made when the widget is shown, so the
+    // main window is up before the viewer and the view gets its final size.
+    myView = myContext->CurrentViewer()->CreateView();
 
   #if defined(_WIN32) || defined(__WIN32__)
     Aspect_Handle aWindowHandle = (Aspect_Handle )winId();
@@ -48,6 +67,9 @@ OccView::OccView(Handle_AIS_InteractiveContext theContext, QWidget *parent)
     {
       hWnd->Map();
     }
+
+    // nothing is drawn until the first paint event.
+    myView->SetImmediateUpdate(Standard_False);
     myView->SetBackgroundColor (Quantity_NOC_BLACK);
     myView->MustBeResized();
     //Eixo x, y, z
@@ -60,14 +82,11 @@ OccView::OccView(Handle_AIS_InteractiveContext theContext, QWidget *parent)
 
     mLayer = new Visual3d_Layer (myView->Viewer()->Viewer(), Aspect_TOL_UNDERLAY, aSizeDependant);
 
-    myView->FitAll();
-    myView->ZFitAll();
-    myView->Redraw();
-
     uptdateGradientBackground(mLayer, Quantity_NOC_BLUE4, Quantity_NOC_GRAY65);
 
-    this->setMouseTracking( true );
-
+    myView->FitAll();
+    myView->ZFitAll();
+    myView->SetImmediateUpdate(Standard_True);
 }
 
 QSize OccView::sizeHint() const
@@ -82,14 +101,24 @@ void OccView::pan()
 
 void OccView::fitAll()
 {
+    // fit to the whole scene, not to what survived the last culling.
+    mCuller.restore();
+
+    const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
     myView->FitAll();
     myView->ZFitAll();
-    myView->Redraw();
+    myView->SetImmediateUpdate(wasImmediate);
+
+    redraw();
 }
 
 void OccView::reset()
 {
+    const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
     myView->Reset();
+    myView->SetImmediateUpdate(wasImmediate);
+
+    redraw();
 }
 
 void OccView::zoom()
@@ -102,8 +131,18 @@ void OccView::rotate()
     mCurrentMode = CurAction3d_DynamicRotation;
 }
 
+void OccView::moveSection()
+{
+    mCurrentMode = CurAction3d_SectionMoving;
+}
+
 void OccView::mousePressEvent(QMouseEvent *e)
 {
+    if (mRecording)
+    {
+        mRecording->record(InputTrace::Press, e);
+    }
+
     if (e->button() == Qt::LeftButton)
     {
         onLButtonDown((e->buttons() | e->modifiers()), e->pos());
@@ -120,6 +159,11 @@ void OccView::mousePressEvent(QMouseEvent *e)
 
 void OccView::mouseReleaseEvent(QMouseEvent *e)
 {
+    if (mRecording)
+    {
+        mRecording->record(InputTrace::Release, e);
+    }
+
     if (e->button() == Qt::LeftButton)
     {
         onLButtonUp(e->buttons() | e->modifiers(), e->pos());
@@ -136,11 +180,21 @@ void OccView::mouseReleaseEvent(QMouseEvent *e)
 
 void OccView::mouseMoveEvent(QMouseEvent *e)
 {
+    if (mRecording)
+    {
+        mRecording->record(InputTrace::Move, e);
+    }
+
     onMouseMove(e->buttons(), e->pos());
 }
 
 void OccView::wheelEvent(QWheelEvent *e)
 {
+    if (mRecording)
+    {
+        mRecording->record(e);
+    }
+
     onMouseWheel(e->buttons(), e->delta(), e->pos());
 }
 
@@ -198,7 +252,11 @@ void OccView::onMouseWheel(const int theFlags, const int theDelta, const QPoint
         aY -= aFactor;
     }
 
+    const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
     myView->Zoom(thePoint.x(), thePoint.y(), aX, aY);
+    myView->SetImmediateUpdate(wasImmediate);
+
+    redraw();
 }
 
 void OccView::onLButtonUp(const int theFlags, const QPoint thePoint)
@@ -231,6 +289,10 @@ void OccView::onMButtonUp(const int theFlags, const QPoint thePoint)
     {
         panByMiddleButton(thePoint);
     }
+    else if (mCurrentMode == CurAction3d_SectionMoving && mSectionPlanes)
+    {
+        emit sectionMoved();
+    }
 }
 
 void OccView::onRButtonUp(const int theFlags, const QPoint thePoint)
@@ -263,6 +325,9 @@ void OccView::onMouseMove(const int theFlags, const QPoint thePoint)
     // Middle button.
     if (theFlags & Qt::MidButton)
     {
+        // the camera moves without redrawing, the culled redraw follows.
+        const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
+
         switch (mCurrentMode)
         {
         case CurAction3d_DynamicRotation:
@@ -278,7 +343,24 @@ void OccView::onMouseMove(const int theFlags, const QPoint thePoint)
             mXmax = thePoint.x();
             mYmax = thePoint.y();
             break;
+
+        case CurAction3d_SectionMoving:
+            // dragging up moves the plane along its normal.
+            if (mSectionPlanes)
+            {
+                mSectionPlanes->move(myView->Convert(mYmax - thePoint.y()));
+            }
+            mXmax = thePoint.x();
+            mYmax = thePoint.y();
+            break;
+
+        default:
+            break;
         }
+
+        myView->SetImmediateUpdate(wasImmediate);
+
+        redraw();
     }
 }
 
@@ -295,6 +377,11 @@ void OccView::popup(const int x, const int y)
 
 void OccView::dragEvent(const int x, const int y)
 {
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->activateIn(myView, mXmin, mYmin, x, y);
+    }
+
     myContext->Select( mXmin, mYmin, x, y, myView );
 
     emit selectionChanged();
@@ -302,26 +389,62 @@ void OccView::dragEvent(const int x, const int y)
 
 void OccView::inputEvent(const int x, const int y)
 {
-    Q_UNUSED(x);
-    Q_UNUSED(y);
+    const Standard_Boolean hasDetected = myContext->HasDetected();
 
     myContext->Select();
 
+    if (!hasDetected && mSelectionActivator)
+    {
+        Handle_AIS_InteractiveObject aPicked = mSelectionActivator->fallbackPick(myView, x, y);
+
+        if (!aPicked.IsNull() && !myContext->HasOpenedContext())
+        {
+            myContext->AddOrRemoveSelected(aPicked, Standard_True);
+        }
+    }
+
     emit selectionChanged();
 }
 
 void OccView::moveEvent(const int x, const int y)
 {
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->activateIn(myView, x, y, x, y);
+    }
+
     myContext->MoveTo(x, y, myView);
+
+    // shapes whose selection is still being built answer by their bounding box.
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->hoverFallback(myView, x, y);
+    }
 }
 
 void OccView::multiMoveEvent(const int x, const int y)
 {
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->activateIn(myView, x, y, x, y);
+    }
+
     myContext->MoveTo(x, y, myView);
+
+    // shapes whose selection is still being built answer by their bounding box.
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->hoverFallback(myView, x, y);
+    }
 }
 
 void OccView::multiDragEvent(const int x, const int y)
 {
+    if (mSelectionActivator)
+    {
+        mSelectionActivator->activateIn(myView, mXmin, mYmin, x, y);
+    }
+
     myContext->ShiftSelect( mXmin, mYmin, x, y, myView );
 
     emit selectionChanged();
@@ -329,11 +452,20 @@ void OccView::multiDragEvent(const int x, const int y)
 
 void OccView::multiInputEvent(const int x, const int y)
 {
-    Q_UNUSED(x);
-    Q_UNUSED(y);
+    const Standard_Boolean hasDetected = myContext->HasDetected();
 
     myContext->ShiftSelect();
 
+    if (!hasDetected && mSelectionActivator)
+    {
+        Handle_AIS_InteractiveObject aPicked = mSelectionActivator->fallbackPick(myView, x, y);
+
+        if (!aPicked.IsNull() && !myContext->HasOpenedContext())
+        {
+            myContext->AddOrRemoveSelected(aPicked, Standard_True);
+        }
+    }
+
     emit selectionChanged();
 }
 
@@ -371,7 +503,11 @@ void OccView::panByMiddleButton(const QPoint &thePoint)
     aCenterX = aSize.width() / 2;
     aCenterY = aSize.height() / 2;
 
+    const Standard_Boolean wasImmediate = myView->SetImmediateUpdate(Standard_False);
     myView->Pan(aCenterX - thePoint.x(), thePoint.y() - aCenterY);
+    myView->SetImmediateUpdate(wasImmediate);
+
+    redraw();
 }
 
 void OccView::uptdateGradientBackground(const Handle_Visual3d_Layer &theLayer, const Quantity_Color &theTopColor, const Quantity_Color &theBottomColor)
@@ -395,19 +531,85 @@ void OccView::uptdateGradientBackground(const Handle_Visual3d_Layer &theLayer, c
     theLayer->End();
 }
 
-Handle_V3d_View OccView::getMyView() const
+Handle_V3d_View OccView::getMyView()
 {
+    init();
+
     return myView;
 }
 
+void OccView::setSelectionActivator(SelectionActivator* theActivator)
+{
+    mSelectionActivator = theActivator;
+}
+
+void OccView::setSectionPlanes(SectionPlanes* theSectionPlanes)
+{
+    mSectionPlanes = theSectionPlanes;
+}
+
+ViewCuller& OccView::culler()
+{
+    return mCuller;
+}
+
+OccView::CurrentAction3d OccView::currentAction() const
+{
+    return mCurrentMode;
+}
+
+void OccView::setCurrentAction(const CurrentAction3d theAction)
+{
+    mCurrentMode = theAction;
+}
+
+void OccView::setInputRecording(InputTrace* theTrace)
+{
+    mRecording = theTrace;
+}
+
+void OccView::redraw()
+{
+    if (myView.IsNull())
+    {
+        return;
+    }
+
+    if (mCuller.isEnabled())
+    {
+        mCuller.update(myView);
+
+        emit culled(mCuller.drawnCount(), mCuller.outsideCount(), mCuller.smallCount());
+    }
+
+    myView->Redraw();
+}
+
 void OccView::setMyView(const Handle_V3d_View &value)
 {
     myView = value;
 }
 
+QPaintEngine* OccView::paintEngine() const
+{
+    return 0;
+}
+
+void OccView::showEvent(QShowEvent *)
+{
+    init();
+}
+
 void OccView::paintEvent(QPaintEvent *)
 {
-    myView->Redraw();
+    init();
+    redraw();
+
+    if (!mHasPainted)
+    {
+        mHasPainted = true;
+        emit firstFrame();
+    }
 }
 
 void OccView::resizeEvent(QResizeEvent *)
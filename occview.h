@@ -12,6 +12,8 @@
 
 #include <Visual3d_Layer.hxx>
 
+#include "viewculler.h"
+
 #if defined(_WIN32) || defined(__WIN32__)
 #include <WNT_Window.hxx>
 #include <Aspect_Handle.hxx>
@@ -23,6 +25,10 @@
 // the key for shortcut ( use to activate dynamic rotation, panning )
 #define CASCADESHORTCUTKEY Qt::ControlModifier
 
+class SelectionActivator;
+class SectionPlanes;
+class InputTrace;
+
 class OccView : public QWidget
 {
     Q_OBJECT
@@ -35,18 +41,49 @@ public:
         CurAction3d_WindowZooming,
         CurAction3d_DynamicPanning,
         CurAction3d_GlobalPanning,
-        CurAction3d_DynamicRotation
+        CurAction3d_DynamicRotation,
+        CurAction3d_SectionMoving
     };
 
 public:
     explicit OccView(Handle_AIS_InteractiveContext theContext, QWidget *parent = 0);
 
     QSize sizeHint() const;
-    Handle_V3d_View getMyView() const;
+
+    //! the view, created on first use if the widget was not shown yet.
+    Handle_V3d_View getMyView();
     void setMyView(const Handle_V3d_View &value);
 
+    //! objects under the cursor get their pending selection modes before picking.
+    void setSelectionActivator(SelectionActivator* theActivator);
+
+    //! the planes moved by the middle button in the section mode.
+    void setSectionPlanes(SectionPlanes* theSectionPlanes);
+
+    //! the culling applied before each redraw.
+    ViewCuller& culler();
+
+    //! cull the displayed objects for the current camera and redraw the view.
+    void redraw(void);
+
+    //! the mode of the middle button drags.
+    CurrentAction3d currentAction(void) const;
+    void setCurrentAction(const CurrentAction3d theAction);
+
+    //! append the mouse and wheel events to theTrace, null stops the recording.
+    void setInputRecording(InputTrace* theTrace);
+
 signals:
     void selectionChanged(void);
+
+    //! a section plane drag has ended, the exact sections are out of date.
+    void sectionMoved(void);
+
+    //! the counters of the last culled redraw.
+    void culled(int theDrawn, int theOutside, int theSmall);
+
+    //! the view has been drawn for the first time.
+    void firstFrame(void);
 public slots:
 
     //! operations for the view.
@@ -55,9 +92,14 @@ public slots:
     void reset(void);
     void zoom(void);
     void rotate(void);
+    void moveSection(void);
 
 protected:
+    //! OpenGL paints the widget, Qt has no paint engine for it.
+    virtual QPaintEngine*         paintEngine() const;
+
     // Paint events.
+    virtual void                  showEvent( QShowEvent* );
     virtual void                  paintEvent( QPaintEvent* );
     virtual void                  resizeEvent( QResizeEvent* );
 
@@ -94,7 +136,8 @@ protected:
     void uptdateGradientBackground(const Handle_Visual3d_Layer &theLayer, const  Quantity_Color& theTopColor, const Quantity_Color& theBottomColor);
 
 private:
-
+    //! create the view in the native window of the widget, once.
+    void init(void);
 
     //! the occ viewer.
     Handle_V3d_View myView;
@@ -103,6 +146,18 @@ private:
     //! the occ context.
     Handle_AIS_InteractiveContext myContext;
 
+    //! builds the selection of lazily displayed objects, may be null.
+    SelectionActivator* mSelectionActivator;
+
+    //! the section planes, may be null.
+    SectionPlanes* mSectionPlanes;
+
+    //! hides what is off screen or below a pixel.
+    ViewCuller mCuller;
+
+    //! the trace recording the input events, may be null.
+    InputTrace* mRecording;
+
     //! the mouse current mode.
     CurrentAction3d mCurrentMode;
 
@@ -121,6 +176,9 @@ private:
     Handle_Visual3d_Layer mLayer;
     Quantity_Color mTopColor;
     Quantity_Color mBottomColor;
+
+    //! firstFrame() has been emitted.
+    bool mHasPainted;
 };
 
 #endif // OCCVIEW_H
@@ -0,0 +1,24 @@
+#-------------------------------------------------
+#
+# Data exchange plugin, loaded by the application on the first
+# STEP, IGES or STL export.
+#
+#-------------------------------------------------
+
+QT       += core
+
+TARGET = exchange
+TEMPLATE = lib
+CONFIG += plugin c++11
+
+DESTDIR = $$OUT_PWD/..
+
+SOURCES += exchangeplugin.cpp
+
+HEADERS += exchangeplugin.h \
+    ../../modeling/shapeexchange.h
+
+INCLUDEPATH += /usr/include/oce
+
+LIBS += -L/usr/lib64/oce -lTKernel -lTKMath -lTKBRep -lTKG2d -lTKG3d -lTKGeomBase \
+        -lTKIGES -lTKSTL -lTKSTEP -lTKSTEPAttr -lTKSTEP209 -lTKSTEPBase -lTKXSBase
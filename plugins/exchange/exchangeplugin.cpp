@@ -0,0 +1,64 @@
+#include "exchangeplugin.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <IGESControl_Controller.hxx>
+#include <IGESControl_Writer.hxx>
+#include <STEPControl_Writer.hxx>
+#include <StlAPI_Writer.hxx>
+
+QStringList ExchangePlugin::formats() const
+{
+    return QStringList() << "step" << "stp" << "iges" << "igs" << "stl";
+}
+
+bool ExchangePlugin::write(const TopoDS_Shape& theShape, const QString& theFileName, QString& theError)
+{
+    const QString aSuffix = QFileInfo(theFileName).suffix().toLower();
+    const QByteArray aFileName = theFileName.toLocal8Bit();
+
+    bool isDone = false;
+
+    if (aSuffix == "step" || aSuffix == "stp")
+    {
+        STEPControl_Writer aWriter;
+        isDone = aWriter.Transfer(theShape, STEPControl_AsIs) == IFSelect_RetDone
+              && aWriter.Write(aFileName.constData()) == IFSelect_RetDone;
+    }
+    else if (aSuffix == "iges" || aSuffix == "igs")
+    {
+        IGESControl_Controller::Init();
+        IGESControl_Writer aWriter;
+        isDone = aWriter.AddShape(theShape);
+        aWriter.ComputeModel();
+        isDone = isDone && aWriter.Write(aFileName.constData());
+    }
+    else if (aSuffix == "stl")
+    {
+        // the writer reports no failure, only a new non-empty file tells it wrote.
+        if (QFile::exists(theFileName) && !QFile::remove(theFileName))
+        {
+            theError = QString("cannot replace %1").arg(theFileName);
+            return false;
+        }
+
+        StlAPI_Writer aWriter;
+        aWriter.Write(theShape, aFileName.constData());
+
+        const QFileInfo aFileInfo(theFileName);
+        isDone = aFileInfo.exists() && aFileInfo.size() > 0;
+    }
+    else
+    {
+        theError = QString("unknown export format '%1'").arg(aSuffix);
+        return false;
+    }
+
+    if (!isDone)
+    {
+        theError = QString("cannot write %1").arg(theFileName);
+    }
+
+    return isDone;
+}
@@ -0,0 +1,22 @@
+#ifndef EXCHANGEPLUGIN_H
+#define EXCHANGEPLUGIN_H
+
+#include "../../modeling/shapeexchange.h"
+
+#include <QObject>
+
+//! Writes STEP, IGES and STL files. It links the data exchange toolkits so
+//! the application does not have to map them at startup.
+class ExchangePlugin : public QObject, public ShapeExchange
+{
+    Q_OBJECT
+    Q_PLUGIN_METADATA(IID ShapeExchange_iid)
+    Q_INTERFACES(ShapeExchange)
+
+public:
+    virtual QStringList formats() const;
+
+    virtual bool write(const TopoDS_Shape& theShape, const QString& theFileName, QString& theError);
+};
+
+#endif // EXCHANGEPLUGIN_H
@@ -0,0 +1,104 @@
+#include "propertiespanel.h"
+
+#include <QComboBox>
+#include <QFormLayout>
+#include <QLabel>
+
+PropertiesPanel::PropertiesPanel(MassProperties& theProperties, QWidget* theParent)
+    : QWidget(theParent),
+      mProperties(theProperties)
+{
+    mPrecisionBox = new QComboBox(this);
+    mPrecisionBox->addItem(tr("Fast"), 0.0);
+    mPrecisionBox->addItem(tr("0.1 %"), 1.0e-3);
+    mPrecisionBox->addItem(tr("0.001 %"), 1.0e-5);
+    mPrecisionBox->addItem(tr("1e-7"), 1.0e-7);
+    mPrecisionBox->setToolTip(tr("Relative precision of the integration"));
+    connect(mPrecisionBox, SIGNAL(currentIndexChanged(int)), this, SLOT(setPrecision(int)));
+
+    mNameLabel = new QLabel(tr("No selection"), this);
+    mVolumeLabel = new QLabel(this);
+    mAreaLabel = new QLabel(this);
+    mCenterLabel = new QLabel(this);
+    mInertiaLabel = new QLabel(this);
+    mPrincipalLabel = new QLabel(this);
+    mTimeLabel = new QLabel(this);
+
+    foreach (QLabel* aLabel, findChildren<QLabel*>())
+    {
+        aLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    }
+
+    QFormLayout* aLayout = new QFormLayout(this);
+    aLayout->addRow(tr("Precision:"), mPrecisionBox);
+    aLayout->addRow(tr("Shape:"), mNameLabel);
+    aLayout->addRow(tr("Volume:"), mVolumeLabel);
+    aLayout->addRow(tr("Area:"), mAreaLabel);
+    aLayout->addRow(tr("Center of mass:"), mCenterLabel);
+    aLayout->addRow(tr("Inertia:"), mInertiaLabel);
+    aLayout->addRow(tr("Principal moments:"), mPrincipalLabel);
+    aLayout->addRow(tr("Computed in:"), mTimeLabel);
+}
+
+void PropertiesPanel::showShape(const TopoDS_Shape& theShape, const QString& theName)
+{
+    mShape = theShape;
+
+    mNameLabel->setText(theShape.IsNull() ? tr("No selection") : theName);
+
+    foreach (QLabel* aLabel, QList<QLabel*>() << mVolumeLabel << mAreaLabel << mCenterLabel
+                                              << mInertiaLabel << mPrincipalLabel << mTimeLabel)
+    {
+        aLabel->setText(theShape.IsNull() ? QString() : tr("..."));
+    }
+
+    if (theShape.IsNull())
+    {
+        return;
+    }
+
+    const Standard_Real aPrecision = mProperties.precision();
+
+    mProperties.request(theShape, [this, aPrecision](const TopoDS_Shape& theComputed, const MassProperties::Values& theValues)
+    {
+        // the selection or the precision changed meanwhile.
+        if (theComputed.IsSame(mShape) && aPrecision == mProperties.precision())
+        {
+            showValues(theValues);
+        }
+    });
+}
+
+void PropertiesPanel::setPrecision(int theIndex)
+{
+    mProperties.setPrecision(mPrecisionBox->itemData(theIndex).toDouble());
+
+    showShape(mShape, mNameLabel->text());
+}
+
+void PropertiesPanel::showValues(const MassProperties::Values& theValues)
+{
+    if (!theValues.isValid)
+    {
+        foreach (QLabel* aLabel, QList<QLabel*>() << mVolumeLabel << mAreaLabel << mCenterLabel
+                                                  << mInertiaLabel << mPrincipalLabel)
+        {
+            aLabel->setText(tr("n/a"));
+        }
+
+        mTimeLabel->setText(tr("failed after %1 ms").arg(theValues.time));
+        return;
+    }
+
+    const gp_Mat& anInertia = theValues.inertia;
+
+    mVolumeLabel->setText(QString::number(theValues.volume, 'g', 10));
+    mAreaLabel->setText(QString::number(theValues.area, 'g', 10));
+    mCenterLabel->setText(QString("%1, %2, %3").arg(theValues.center.X()).arg(theValues.center.Y()).arg(theValues.center.Z()));
+    mInertiaLabel->setText(QString("Ixx %1, Iyy %2, Izz %3\nIxy %4, Ixz %5, Iyz %6")
+                           .arg(anInertia(1, 1)).arg(anInertia(2, 2)).arg(anInertia(3, 3))
+                           .arg(anInertia(1, 2)).arg(anInertia(1, 3)).arg(anInertia(2, 3)));
+    mPrincipalLabel->setText(QString("%1, %2, %3").arg(theValues.principal[0]).arg(theValues.principal[1]).arg(theValues.principal[2]));
+    mTimeLabel->setText(theValues.error > 0.0 ? tr("%1 ms, error %2").arg(theValues.time).arg(theValues.error)
+                                              : tr("%1 ms").arg(theValues.time));
+}
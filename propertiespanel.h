@@ -0,0 +1,47 @@
+#ifndef PROPERTIESPANEL_H
+#define PROPERTIESPANEL_H
+
+#include <QWidget>
+
+#include <TopoDS_Shape.hxx>
+
+#include "massproperties.h"
+
+class QComboBox;
+class QLabel;
+
+//! Shows the mass properties of the selected shape. The values come from
+//! the MassProperties service and fill in when the worker is done, so
+//! selecting stays responsive.
+class PropertiesPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit PropertiesPanel(MassProperties& theProperties, QWidget* theParent = 0);
+
+    //! show the properties of theShape, a null shape clears the panel.
+    void showShape(const TopoDS_Shape& theShape, const QString& theName);
+
+private slots:
+    void setPrecision(int theIndex);
+
+private:
+    void showValues(const MassProperties::Values& theValues);
+
+    MassProperties& mProperties;
+
+    //! the shape shown, results for other shapes are ignored.
+    TopoDS_Shape mShape;
+
+    QComboBox* mPrecisionBox;
+
+    QLabel* mNameLabel;
+    QLabel* mVolumeLabel;
+    QLabel* mAreaLabel;
+    QLabel* mCenterLabel;
+    QLabel* mInertiaLabel;
+    QLabel* mPrincipalLabel;
+    QLabel* mTimeLabel;
+};
+
+#endif // PROPERTIESPANEL_H
@@ -0,0 +1,313 @@
+#include "scenecommands.h"
+#include "meshcache.h"
+#include "selectionactivator.h"
+#include "stylepalette.h"
+
+#include <QObject>
+
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+
+void updateShapeInPlace(const Handle_AIS_InteractiveContext& theContext, const Handle_AIS_Shape& theShape,
+                        const TopoDS_Shape& theNewShape, MeshCache* theMeshCache)
+{
+    // faces taken over from the old shape are already triangulated and are skipped.
+    if (theMeshCache)
+    {
+        theMeshCache->mesh(theNewShape, MeshCache::deflection(theNewShape));
+    }
+
+    theShape->Set(theNewShape);
+
+    // recompute the presentation of the current mode and the selections in place,
+    // the drawer, the highlight and the selection membership belong to the object.
+    theContext->Redisplay(theShape, Standard_False, Standard_False);
+}
+
+DisplayShapeCommand::DisplayShapeCommand(const Handle_AIS_InteractiveContext& theContext, ShapeMap& theMap,
+                                         const unsigned int theId, const Handle_AIS_Shape& theShape,
+                                         SelectionActivator* theActivator, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Display shape %1").arg(theId), theParent),
+      mContext(theContext),
+      mMap(theMap),
+      mId(theId),
+      mShape(theShape),
+      mActivator(theActivator)
+{
+}
+
+void DisplayShapeCommand::redo()
+{
+    mPrevious = mMap.value(mId);
+
+    if (mActivator)
+    {
+        mActivator->display(mShape, Standard_False);
+    }
+    else
+    {
+        mContext->Display(mShape, Standard_False);
+    }
+    mMap.insert(mId, mShape);
+}
+
+void DisplayShapeCommand::undo()
+{
+    // removing drops the presentation, redo recomputes it from the shared triangulation.
+    mContext->Remove(mShape, Standard_False);
+
+    if (mPrevious.IsNull())
+    {
+        mMap.remove(mId);
+    }
+    else
+    {
+        mMap.insert(mId, mPrevious);
+    }
+
+    mPrevious.Nullify();
+}
+
+DisplayInstanceCommand::DisplayInstanceCommand(const Handle_AIS_InteractiveContext& theContext, InstanceMap& theMap,
+                                               const unsigned int theId, const Handle_AIS_ConnectedInteractive& theInstance,
+                                               SelectionActivator* theActivator, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Display instance %1").arg(theId), theParent),
+      mContext(theContext),
+      mMap(theMap),
+      mId(theId),
+      mInstance(theInstance),
+      mActivator(theActivator)
+{
+}
+
+void DisplayInstanceCommand::redo()
+{
+    mPrevious = mMap.value(mId);
+
+    if (mActivator)
+    {
+        mActivator->display(mInstance, Standard_False);
+    }
+    else
+    {
+        mContext->Display(mInstance, Standard_False);
+    }
+    mMap.insert(mId, mInstance);
+}
+
+void DisplayInstanceCommand::undo()
+{
+    // the prototype keeps the triangulation, only the transformed presentation goes.
+    mContext->Remove(mInstance, Standard_False);
+
+    if (mPrevious.IsNull())
+    {
+        mMap.remove(mId);
+    }
+    else
+    {
+        mMap.insert(mId, mPrevious);
+    }
+
+    mPrevious.Nullify();
+}
+
+EraseObjectCommand::EraseObjectCommand(const Handle_AIS_InteractiveContext& theContext,
+                                       const Handle_AIS_InteractiveObject& theObject,
+                                       SelectionActivator* theActivator, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Erase"), theParent),
+      mContext(theContext),
+      mObject(theObject),
+      mActivator(theActivator)
+{
+}
+
+void EraseObjectCommand::redo()
+{
+    // an erased object would keep its presentation and sensitive entities for the whole history.
+    mContext->Remove(mObject, Standard_False);
+}
+
+void EraseObjectCommand::undo()
+{
+    if (mActivator)
+    {
+        mActivator->display(mObject, Standard_False);
+    }
+    else
+    {
+        mContext->Display(mObject, Standard_False);
+    }
+}
+
+ModifyShapeCommand::ModifyShapeCommand(const Handle_AIS_InteractiveContext& theContext,
+                                       const Handle_AIS_Shape& theShape, const TopoDS_Shape& theNewShape,
+                                       MeshCache* theMeshCache, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Modify shape"), theParent),
+      mContext(theContext),
+      mShape(theShape),
+      mMeshCache(theMeshCache),
+      mOldShape(theShape->Shape()),
+      mNewShape(theNewShape)
+{
+}
+
+void ModifyShapeCommand::redo()
+{
+    updateShapeInPlace(mContext, mShape, mNewShape, mMeshCache);
+}
+
+void ModifyShapeCommand::undo()
+{
+    // the old shape still holds its triangulation, nothing is meshed again.
+    updateShapeInPlace(mContext, mShape, mOldShape, mMeshCache);
+}
+
+ColorShapeCommand::ColorShapeCommand(const Handle_AIS_InteractiveContext& theContext,
+                                     const Handle_AIS_Shape& theShape, const Quantity_Color* theColor,
+                                     StylePalette* thePalette, QUndoCommand* theParent)
+    : QUndoCommand(theColor ? QObject::tr("Set color") : QObject::tr("Unset color"), theParent),
+      mContext(theContext),
+      mShape(theShape),
+      mPalette(thePalette),
+      mStyle(thePalette ? thePalette->styleOf(theShape) : QString()),
+      mHadColor(theShape->HasColor()),
+      mHasColor(theColor != 0)
+{
+    if (mHadColor)
+    {
+        theShape->Color(mOldColor);
+    }
+
+    if (theColor)
+    {
+        mNewColor = *theColor;
+    }
+}
+
+void ColorShapeCommand::redo()
+{
+    AIS_ListOfInteractive aShapes;
+    aShapes.Append(mShape);
+
+    // the drawer gets its own aspects back before they are edited.
+    if (!mStyle.isEmpty())
+    {
+        mPalette->release(aShapes);
+    }
+
+    apply(mHasColor, mNewColor);
+}
+
+void ColorShapeCommand::undo()
+{
+    apply(mHadColor, mOldColor);
+
+    if (!mStyle.isEmpty())
+    {
+        AIS_ListOfInteractive aShapes;
+        aShapes.Append(mShape);
+
+        mPalette->apply(mStyle, aShapes);
+    }
+}
+
+void ColorShapeCommand::apply(const bool theHasColor, const Quantity_Color& theColor)
+{
+    if (theHasColor)
+    {
+        mContext->SetColor(mShape, theColor, Standard_False);
+    }
+    else
+    {
+        mContext->UnsetColor(mShape, Standard_False);
+    }
+}
+
+FeatureParameterCommand::FeatureParameterCommand(FeatureGraph& theGraph, const FeatureGraph::NodeId theNode,
+                                                 const int theIndex, const double theValue, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Set feature parameter"), theParent),
+      mGraph(theGraph),
+      mNode(theNode),
+      mIndex(theIndex),
+      mOldValue(theGraph.parameter(theNode, theIndex)),
+      mNewValue(theValue)
+{
+}
+
+void FeatureParameterCommand::redo()
+{
+    mGraph.setParameter(mNode, mIndex, mNewValue);
+}
+
+void FeatureParameterCommand::undo()
+{
+    // the displayed shapes are restored by their own commands, the graph
+    // results stay dirty until the next edit recomputes them.
+    mGraph.setParameter(mNode, mIndex, mOldValue);
+}
+
+ApplyStyleCommand::ApplyStyleCommand(StylePalette& thePalette, const AIS_ListOfInteractive& theObjects,
+                                     const QString& theStyle, QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Apply style %1").arg(theStyle), theParent),
+      mPalette(thePalette),
+      mObjects(theObjects),
+      mStyle(theStyle)
+{
+    for (AIS_ListIteratorOfListOfInteractive anIter(theObjects); anIter.More(); anIter.Next())
+    {
+        mPrevious[thePalette.styleOf(anIter.Value())].Append(anIter.Value());
+    }
+}
+
+void ApplyStyleCommand::redo()
+{
+    mPalette.apply(mStyle, mObjects);
+}
+
+void ApplyStyleCommand::undo()
+{
+    // one bulk operation per previous style.
+    for (QMap<QString, AIS_ListOfInteractive>::const_iterator anIter = mPrevious.constBegin(); anIter != mPrevious.constEnd(); ++anIter)
+    {
+        if (anIter.key().isEmpty())
+        {
+            mPalette.release(anIter.value());
+        }
+        else
+        {
+            mPalette.apply(anIter.key(), anIter.value());
+        }
+    }
+}
+
+DefineStyleCommand::DefineStyleCommand(StylePalette& thePalette, const QString& theStyle,
+                                       const Quantity_Color& theColor, const Graphic3d_NameOfMaterial theMaterial,
+                                       QUndoCommand* theParent)
+    : QUndoCommand(QObject::tr("Define style %1").arg(theStyle), theParent),
+      mPalette(thePalette),
+      mStyle(theStyle),
+      mExisted(thePalette.contains(theStyle)),
+      mOldMaterial(theMaterial),
+      mNewColor(theColor),
+      mNewMaterial(theMaterial)
+{
+    if (mExisted)
+    {
+        mOldColor = thePalette.color(theStyle);
+        mOldMaterial = thePalette.material(theStyle);
+    }
+}
+
+void DefineStyleCommand::redo()
+{
+    mPalette.define(mStyle, mNewColor, mNewMaterial);
+}
+
+void DefineStyleCommand::undo()
+{
+    // a new style stays defined, it has no members left after the undo of their apply.
+    if (mExisted)
+    {
+        mPalette.define(mStyle, mOldColor, mOldMaterial);
+    }
+}
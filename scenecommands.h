@@ -0,0 +1,213 @@
+#ifndef SCENECOMMANDS_H
+#define SCENECOMMANDS_H
+
+#include "featuregraph.h"
+
+#include <QMap>
+#include <QUndoCommand>
+
+#include <TopoDS_Shape.hxx>
+#include <Quantity_Color.hxx>
+#include <Graphic3d_NameOfMaterial.hxx>
+
+#include <AIS_ConnectedInteractive.hxx>
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_ListOfInteractive.hxx>
+#include <AIS_Shape.hxx>
+
+class MeshCache;
+class SelectionActivator;
+class StylePalette;
+
+//! The map from shape ids to interactive shapes edited by the commands.
+typedef QMap<unsigned int, Handle(AIS_Shape)> ShapeMap;
+
+//! The map from ids to the placements of shared prototypes.
+typedef QMap<unsigned int, Handle(AIS_ConnectedInteractive)> InstanceMap;
+
+//! Swap the shape of an existing interactive shape instead of erasing it and
+//! displaying a new one. The object keeps its attributes and selection state;
+//! faces shared with the previous shape keep their triangulation, so only the
+//! new faces are meshed before the presentation and selection are rebuilt.
+void updateShapeInPlace(const Handle_AIS_InteractiveContext& theContext, const Handle_AIS_Shape& theShape,
+                        const TopoDS_Shape& theNewShape, MeshCache* theMeshCache = 0);
+
+// Scene edits for the undo stack.
+// Commands keep handles only: a TopoDS_Shape references its TShape, so the
+// parts of a shape that an edit did not touch are shared by all the states
+// of the history instead of being copied.
+
+//! display a shape and register it under an id.
+class DisplayShapeCommand : public QUndoCommand
+{
+public:
+    //! with theActivator the selection of the shape is built lazily.
+    DisplayShapeCommand(const Handle_AIS_InteractiveContext& theContext, ShapeMap& theMap,
+                        const unsigned int theId, const Handle_AIS_Shape& theShape,
+                        SelectionActivator* theActivator = 0, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    Handle_AIS_InteractiveContext mContext;
+    ShapeMap& mMap;
+    unsigned int mId;
+    Handle_AIS_Shape mShape;
+    SelectionActivator* mActivator;
+
+    //! the shape registered under the id before, if any.
+    Handle_AIS_Shape mPrevious;
+};
+
+//! display a placement of a prototype and register it under an id.
+class DisplayInstanceCommand : public QUndoCommand
+{
+public:
+    //! with theActivator the selection of the instance is built lazily.
+    DisplayInstanceCommand(const Handle_AIS_InteractiveContext& theContext, InstanceMap& theMap,
+                           const unsigned int theId, const Handle_AIS_ConnectedInteractive& theInstance,
+                           SelectionActivator* theActivator = 0, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    Handle_AIS_InteractiveContext mContext;
+    InstanceMap& mMap;
+    unsigned int mId;
+    Handle_AIS_ConnectedInteractive mInstance;
+    SelectionActivator* mActivator;
+
+    //! the instance registered under the id before, if any.
+    Handle_AIS_ConnectedInteractive mPrevious;
+};
+
+//! erase an object. Its presentation and selection are removed from the
+//! context and recomputed on undo, the history only keeps the handle, whose
+//! shape shares its triangulation with the other states.
+class EraseObjectCommand : public QUndoCommand
+{
+public:
+    //! with theActivator the selection of the object is built lazily again on undo.
+    EraseObjectCommand(const Handle_AIS_InteractiveContext& theContext,
+                       const Handle_AIS_InteractiveObject& theObject,
+                       SelectionActivator* theActivator = 0, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    Handle_AIS_InteractiveContext mContext;
+    Handle_AIS_InteractiveObject mObject;
+    SelectionActivator* mActivator;
+};
+
+//! replace the shape of an interactive shape, the object itself is kept.
+class ModifyShapeCommand : public QUndoCommand
+{
+public:
+    ModifyShapeCommand(const Handle_AIS_InteractiveContext& theContext,
+                       const Handle_AIS_Shape& theShape, const TopoDS_Shape& theNewShape,
+                       MeshCache* theMeshCache = 0, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    Handle_AIS_InteractiveContext mContext;
+    Handle_AIS_Shape mShape;
+    MeshCache* mMeshCache;
+    TopoDS_Shape mOldShape;
+    TopoDS_Shape mNewShape;
+};
+
+//! set or unset the color of an interactive shape.
+class ColorShapeCommand : public QUndoCommand
+{
+public:
+    //! a null theColor unsets the color. A member of a style of thePalette is
+    //! released first, its own color must not edit the aspects of the style.
+    ColorShapeCommand(const Handle_AIS_InteractiveContext& theContext,
+                      const Handle_AIS_Shape& theShape, const Quantity_Color* theColor,
+                      StylePalette* thePalette = 0, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    void apply(const bool theHasColor, const Quantity_Color& theColor);
+
+    Handle_AIS_InteractiveContext mContext;
+    Handle_AIS_Shape mShape;
+    StylePalette* mPalette;
+
+    //! the style the shape was a member of, empty for none.
+    QString mStyle;
+
+    bool mHadColor;
+    Quantity_Color mOldColor;
+    bool mHasColor;
+    Quantity_Color mNewColor;
+};
+
+//! change a parameter of a feature node, the dependents are rebuilt by the next recompute().
+class FeatureParameterCommand : public QUndoCommand
+{
+public:
+    FeatureParameterCommand(FeatureGraph& theGraph, const FeatureGraph::NodeId theNode,
+                            const int theIndex, const double theValue, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    FeatureGraph& mGraph;
+    FeatureGraph::NodeId mNode;
+    int mIndex;
+    double mOldValue;
+    double mNewValue;
+};
+
+//! make a set of objects members of a palette style.
+class ApplyStyleCommand : public QUndoCommand
+{
+public:
+    ApplyStyleCommand(StylePalette& thePalette, const AIS_ListOfInteractive& theObjects,
+                      const QString& theStyle, QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    StylePalette& mPalette;
+    AIS_ListOfInteractive mObjects;
+    QString mStyle;
+
+    //! the objects by their previous style, the empty name for objects without one.
+    QMap<QString, AIS_ListOfInteractive> mPrevious;
+};
+
+//! change the color and material of a palette style.
+class DefineStyleCommand : public QUndoCommand
+{
+public:
+    DefineStyleCommand(StylePalette& thePalette, const QString& theStyle,
+                       const Quantity_Color& theColor, const Graphic3d_NameOfMaterial theMaterial,
+                       QUndoCommand* theParent = 0);
+
+    virtual void undo();
+    virtual void redo();
+
+private:
+    StylePalette& mPalette;
+    QString mStyle;
+
+    bool mExisted;
+    Quantity_Color mOldColor;
+    Graphic3d_NameOfMaterial mOldMaterial;
+    Quantity_Color mNewColor;
+    Graphic3d_NameOfMaterial mNewMaterial;
+};
+
+#endif // SCENECOMMANDS_H
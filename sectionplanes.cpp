@@ -0,0 +1,354 @@
+#include "sectionplanes.h"
+#include "shapefactory.h"
+
+#include <QDataStream>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+#include <Standard_Failure.hxx>
+#include <gp_Vec.hxx>
+
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+#include <AIS_ListOfInteractive.hxx>
+#include <BRep_Builder.hxx>
+#include <Graphic3d_MaterialAspect.hxx>
+#include <Graphic3d_SequenceOfHClipPlane.hxx>
+#include <TopoDS_Compound.hxx>
+
+namespace
+{
+    //! sections kept before the oldest are dropped.
+    const int THE_CACHE_LIMIT = 4096;
+
+    //! plane positions closer than this share their cached sections.
+    const double THE_POSITION_RESOLUTION = 1.0e-6;
+}
+
+SectionPlanes::SectionPlanes(const Handle_AIS_InteractiveContext& theContext)
+    : mContext(theContext),
+      mCurrent(-1),
+      mGeneration(0),
+      mCache(THE_CACHE_LIMIT)
+{
+}
+
+SectionPlanes::~SectionPlanes()
+{
+    foreach (Watcher* aWatcher, mJobs.keys())
+    {
+        aWatcher->disconnect();
+        aWatcher->waitForFinished();
+        delete aWatcher;
+    }
+}
+
+int SectionPlanes::add(const gp_Pln& thePlane)
+{
+    Plane aPlane;
+    aPlane.pln = thePlane;
+    aPlane.generation = 0;
+    aPlane.clip = new Graphic3d_ClipPlane(thePlane);
+    aPlane.clip->SetCapping(Standard_True);
+    aPlane.clip->SetCappingMaterial(Graphic3d_MaterialAspect(Graphic3d_NOM_PLASTIC));
+    aPlane.clip->SetOn(Standard_True);
+
+    mPlanes.append(aPlane);
+    mCurrent = mPlanes.size() - 1;
+
+    clipDisplayed();
+
+    return mCurrent;
+}
+
+void SectionPlanes::clear()
+{
+    // running jobs finish into the cache, their results are not shown.
+    AIS_ListOfInteractive anObjects;
+    mContext->DisplayedObjects(anObjects);
+    mContext->ErasedObjects(anObjects);
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(anObjects); anIter.More(); anIter.Next())
+    {
+        foreach (const Plane& aPlane, mPlanes)
+        {
+            anIter.Value()->RemoveClipPlane(aPlane.clip);
+        }
+    }
+
+    foreach (const Plane& aPlane, mPlanes)
+    {
+        if (!aPlane.result.IsNull())
+        {
+            mContext->Remove(aPlane.result, Standard_False);
+        }
+    }
+
+    mPlanes.clear();
+    mCurrent = -1;
+}
+
+int SectionPlanes::count() const
+{
+    return mPlanes.size();
+}
+
+gp_Pln SectionPlanes::plane(const int theIndex) const
+{
+    return mPlanes.at(theIndex).pln;
+}
+
+void SectionPlanes::setCurrent(const int theIndex)
+{
+    if (theIndex >= 0 && theIndex < mPlanes.size())
+    {
+        mCurrent = theIndex;
+    }
+}
+
+int SectionPlanes::current() const
+{
+    return mCurrent;
+}
+
+void SectionPlanes::move(const Standard_Real theOffset)
+{
+    if (mCurrent < 0)
+    {
+        return;
+    }
+
+    Plane& aPlane = mPlanes[mCurrent];
+    aPlane.pln.Translate(gp_Vec(aPlane.pln.Axis().Direction()) * theOffset);
+    aPlane.clip->SetEquation(aPlane.pln);
+
+    // the exact section no longer matches, the capping shows the cut meanwhile.
+    if (!aPlane.result.IsNull() && mContext->IsDisplayed(aPlane.result))
+    {
+        mContext->Erase(aPlane.result, Standard_False);
+    }
+}
+
+void SectionPlanes::section(const QList<TopoDS_Shape>& theShapes)
+{
+    clipDisplayed();
+
+    for (int i = 0; i < mPlanes.size(); ++i)
+    {
+        Plane& aPlane = mPlanes[i];
+
+        Job aJob;
+        aJob.plane = i;
+        aJob.generation = ++mGeneration;
+        aPlane.generation = aJob.generation;
+
+        const QByteArray aKey = keyOf(aPlane.pln);
+
+        foreach (const TopoDS_Shape& aShape, theShapes)
+        {
+            if (aShape.IsNull())
+            {
+                continue;
+            }
+
+            TopoDS_Shape aSection;
+
+            if (mCache.find(aShape, aSection, aKey))
+            {
+                aJob.sections.append(aSection);
+                continue;
+            }
+
+            Task aTask;
+            aTask.pln = aPlane.pln;
+            aTask.shape = aShape;
+
+            aJob.tasks.append(aTask);
+        }
+
+        if (aJob.tasks.isEmpty())
+        {
+            show(i, aJob.sections);
+            continue;
+        }
+
+        Watcher* aWatcher = new Watcher();
+        QObject::connect(aWatcher, &Watcher::finished, [this, aWatcher]()
+        {
+            finished(aWatcher);
+        });
+
+        mJobs.insert(aWatcher, aJob);
+
+        aWatcher->setFuture(QtConcurrent::mapped(aJob.tasks, computeSection));
+    }
+}
+
+void SectionPlanes::clipDisplayed()
+{
+    if (mPlanes.isEmpty())
+    {
+        return;
+    }
+
+    AIS_ListOfInteractive anObjects;
+    mContext->DisplayedObjects(anObjects);
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(anObjects); anIter.More(); anIter.Next())
+    {
+        const Handle_AIS_InteractiveObject& anObject = anIter.Value();
+
+        if (isSection(anObject))
+        {
+            continue;
+        }
+
+        const Graphic3d_SequenceOfHClipPlane& aClipPlanes = anObject->GetClipPlanes();
+
+        foreach (const Plane& aPlane, mPlanes)
+        {
+            bool isClipped = false;
+
+            for (Graphic3d_SequenceOfHClipPlane::Iterator aClipIter(aClipPlanes); aClipIter.More() && !isClipped; aClipIter.Next())
+            {
+                isClipped = aClipIter.Value() == aPlane.clip;
+            }
+
+            if (!isClipped)
+            {
+                anObject->AddClipPlane(aPlane.clip);
+            }
+        }
+    }
+}
+
+bool SectionPlanes::isSection(const Handle_AIS_InteractiveObject& theObject) const
+{
+    foreach (const Plane& aPlane, mPlanes)
+    {
+        if (aPlane.result == theObject)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+int SectionPlanes::cacheSize() const
+{
+    return mCache.size();
+}
+
+int SectionPlanes::pendingCount() const
+{
+    int aCount = 0;
+
+    foreach (const Job& aJob, mJobs)
+    {
+        aCount += aJob.tasks.size();
+    }
+
+    return aCount;
+}
+
+void SectionPlanes::clearCache()
+{
+    mCache.clear();
+}
+
+TopoDS_Shape SectionPlanes::computeSection(const Task& theTask)
+{
+    try
+    {
+        return ShapeFactory::section(theTask.shape, theTask.pln);
+    }
+    catch (Standard_Failure)
+    {
+    }
+
+    // an empty result is cached too, the shape is not tried again at this position.
+    TopoDS_Compound anEmpty;
+    BRep_Builder().MakeCompound(anEmpty);
+
+    return anEmpty;
+}
+
+QByteArray SectionPlanes::keyOf(const gp_Pln& thePlane)
+{
+    Standard_Real aCoefficients[4];
+    thePlane.Coefficients(aCoefficients[0], aCoefficients[1], aCoefficients[2], aCoefficients[3]);
+
+    QByteArray aKey;
+    QDataStream aStream(&aKey, QIODevice::WriteOnly);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        aStream << qint64(qRound64(aCoefficients[i] / THE_POSITION_RESOLUTION));
+    }
+
+    return aKey;
+}
+
+void SectionPlanes::finished(Watcher* theWatcher)
+{
+    if (!mJobs.contains(theWatcher))
+    {
+        return;
+    }
+
+    Job aJob = mJobs.take(theWatcher);
+    const QList<TopoDS_Shape> aResults = theWatcher->future().results();
+
+    theWatcher->disconnect();
+    theWatcher->deleteLater();
+
+    for (int i = 0; i < aResults.size() && i < aJob.tasks.size(); ++i)
+    {
+        mCache.insert(aJob.tasks.at(i).shape, aResults.at(i), keyOf(aJob.tasks.at(i).pln));
+        aJob.sections.append(aResults.at(i));
+    }
+
+    // the plane moved again or is gone, the results wait in the cache.
+    if (aJob.plane >= mPlanes.size() || mPlanes.at(aJob.plane).generation != aJob.generation)
+    {
+        return;
+    }
+
+    show(aJob.plane, aJob.sections);
+    mContext->UpdateCurrentViewer();
+}
+
+void SectionPlanes::show(const int thePlane, const QList<TopoDS_Shape>& theSections)
+{
+    TopoDS_Compound aCompound;
+    BRep_Builder aBuilder;
+    aBuilder.MakeCompound(aCompound);
+
+    foreach (const TopoDS_Shape& aSection, theSections)
+    {
+        aBuilder.Add(aCompound, aSection);
+    }
+
+    Plane& aPlane = mPlanes[thePlane];
+
+    if (aPlane.result.IsNull())
+    {
+        aPlane.result = new AIS_Shape(aCompound);
+        aPlane.result->SetColor(Quantity_NOC_YELLOW);
+        aPlane.result->SetWidth(3.0);
+    }
+    else
+    {
+        aPlane.result->Set(aCompound);
+    }
+
+    // wireframe, not selectable.
+    if (mContext->IsDisplayed(aPlane.result))
+    {
+        mContext->Redisplay(aPlane.result, Standard_False);
+    }
+    else
+    {
+        mContext->Display(aPlane.result, 0, -1, Standard_False);
+    }
+}
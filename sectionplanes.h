@@ -0,0 +1,114 @@
+#ifndef SECTIONPLANES_H
+#define SECTIONPLANES_H
+
+#include "shapecache.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QVector>
+
+#include <gp_Pln.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_Shape.hxx>
+#include <Graphic3d_ClipPlane.hxx>
+
+template <typename T> class QFutureWatcher;
+
+//! Movable section planes.
+//! While a plane is dragged only its clip plane follows, which the driver
+//! applies when drawing. Once the drag stops, section() computes the exact
+//! planar sections of the given shapes on worker threads and shows them as
+//! one wire object per plane. Sections are cached by plane position and
+//! shape, so going back to an earlier position shows them at once.
+class SectionPlanes
+{
+public:
+    explicit SectionPlanes(const Handle_AIS_InteractiveContext& theContext);
+    ~SectionPlanes();
+
+    //! add a plane and make it the current one, returns its index.
+    int add(const gp_Pln& thePlane);
+
+    //! remove all the planes and their sections, the cache is kept.
+    void clear();
+
+    int count() const;
+    gp_Pln plane(const int theIndex) const;
+
+    //! the plane moved by move().
+    void setCurrent(const int theIndex);
+    int current() const;
+
+    //! shift the current plane along its normal, only the clipping follows.
+    void move(const Standard_Real theOffset);
+
+    //! show the exact sections of theShapes by all planes, cached or computed in the background.
+    void section(const QList<TopoDS_Shape>& theShapes);
+
+    //! clip the displayed objects displayed since the planes were added.
+    void clipDisplayed();
+
+    //! whether theObject shows a section, it is not clipped nor sectioned.
+    bool isSection(const Handle_AIS_InteractiveObject& theObject) const;
+
+    //! number of cached sections and of sections being computed.
+    int cacheSize() const;
+    int pendingCount() const;
+
+    void clearCache();
+
+private:
+    struct Plane
+    {
+        Handle_Graphic3d_ClipPlane clip;
+        gp_Pln pln;
+        Handle_AIS_Shape result;
+
+        //! the generation of the last section() of the plane, older results are only cached.
+        int generation;
+    };
+
+    //! a section to compute.
+    struct Task
+    {
+        gp_Pln pln;
+        TopoDS_Shape shape;
+    };
+
+    typedef QFutureWatcher<TopoDS_Shape> Watcher;
+
+    struct Job
+    {
+        int plane;
+        int generation;
+        QVector<Task> tasks;
+
+        //! the sections already known, the computed ones are added.
+        QList<TopoDS_Shape> sections;
+    };
+
+    static TopoDS_Shape computeSection(const Task& theTask);
+    static QByteArray keyOf(const gp_Pln& thePlane);
+
+    void finished(Watcher* theWatcher);
+    void show(const int thePlane, const QList<TopoDS_Shape>& theSections);
+
+    Handle_AIS_InteractiveContext mContext;
+
+    QVector<Plane> mPlanes;
+    int mCurrent;
+
+    //! bumped by every section() and never reset, so the jobs of cleared
+    //! planes never match the planes added after them.
+    int mGeneration;
+
+    QHash<Watcher*, Job> mJobs;
+
+    //! the sections by shape and plane position.
+    ShapeCache<TopoDS_Shape, QByteArray> mCache;
+};
+
+#endif // SECTIONPLANES_H
@@ -0,0 +1,541 @@
+#include "selectionactivator.h"
+#include "meshcache.h"
+
+#include <QFutureWatcher>
+#include <QMutableHashIterator>
+#include <QtConcurrent>
+
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+#include <AIS_ListOfInteractive.hxx>
+#include <AIS_Shape.hxx>
+#include <BRepBndLib.hxx>
+#include <Standard_Failure.hxx>
+#include <StdSelect_BRepSelectionTool.hxx>
+
+namespace
+{
+    //! the pixel tolerance of the picking, objects this close to the cursor count as under it.
+    const int THE_PIXEL_TOLERANCE = 4;
+
+    //! the sensitive entities of a shape for a mode, computed as AIS_Shape does.
+    Handle_SelectMgr_Selection computeSelection(const Handle_SelectMgr_SelectableObject& theObject, const TopoDS_Shape& theShape,
+                                                const Standard_Integer theMode, const Standard_Real theAngle)
+    {
+        Handle_SelectMgr_Selection aSelection = new SelectMgr_Selection(theMode);
+
+        try
+        {
+            // no automatic triangulation: the GUI thread may be meshing shared faces.
+            StdSelect_BRepSelectionTool::Load(aSelection, theObject, theShape, AIS_Shape::SelectionType(theMode),
+                                              MeshCache::deflection(theShape), theAngle, Standard_False);
+        }
+        catch (Standard_Failure)
+        {
+            aSelection.Nullify();
+        }
+
+        return aSelection;
+    }
+}
+
+SelectionActivator::SelectionActivator(const Handle_AIS_InteractiveContext& theContext)
+    : mContext(theContext),
+      mIsLazy(true),
+      mProjectionStamp(0),
+      mLocalIndex(0)
+{
+}
+
+SelectionActivator::~SelectionActivator()
+{
+    // the workers reference objects of the context, let them finish.
+    foreach (Watcher* aWatcher, mJobs.keys())
+    {
+        aWatcher->disconnect();
+        aWatcher->waitForFinished();
+        delete aWatcher;
+    }
+}
+
+void SelectionActivator::setLazy(const bool theIsLazy)
+{
+    mIsLazy = theIsLazy;
+
+    if (!mIsLazy)
+    {
+        activateAll();
+    }
+}
+
+bool SelectionActivator::isLazy() const
+{
+    return mIsLazy;
+}
+
+void SelectionActivator::display(const Handle_AIS_InteractiveObject& theObject, const Standard_Boolean theToUpdateViewer)
+{
+    if (!mIsLazy)
+    {
+        mContext->Display(theObject, theToUpdateViewer);
+        return;
+    }
+
+    // an object removed before, for example by an undo, comes back without any mode.
+    if (mContext->DisplayStatus(theObject) == AIS_DS_None)
+    {
+        mEntries.remove(theObject.Access());
+    }
+
+    const Standard_Integer aDisplayMode = theObject->HasDisplayMode() ? theObject->DisplayMode() : mContext->DisplayMode();
+
+    // selection mode -1: the object is shown but not loaded in the selector.
+    mContext->Display(theObject, aDisplayMode, -1, theToUpdateViewer);
+
+    track(theObject, false);
+}
+
+void SelectionActivator::activateStandardMode(const TopAbs_ShapeEnum theType)
+{
+    if (!mIsLazy || !mContext->HasOpenedContext())
+    {
+        mContext->ActivateStandardMode(theType);
+        return;
+    }
+
+    syncLocalContext();
+
+    const Standard_Integer aMode = AIS_Shape::SelectionMode(theType);
+
+    if (!mLocalModes.contains(aMode))
+    {
+        mLocalModes.append(aMode);
+    }
+
+    // objects displayed before were activated at display time.
+    AIS_ListOfInteractive aDisplayedList;
+    mContext->DisplayedObjects(aDisplayedList, Standard_True);
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(aDisplayedList); anIter.More(); anIter.Next())
+    {
+        track(anIter.Value(), true);
+    }
+}
+
+int SelectionActivator::activateIn(const Handle_V3d_View& theView, const int theXmin, const int theYmin, const int theXmax, const int theYmax)
+{
+    syncLocalContext();
+    syncProjection(theView);
+
+    int aCount = 0;
+
+    for (QHash<const void*, Entry>::iterator anIter = mEntries.begin(); anIter != mEntries.end(); ++anIter)
+    {
+        Entry& anEntry = anIter.value();
+
+        if (!isPending(anEntry) || !isUnder(anEntry, theXmin, theYmin, theXmax, theYmax))
+        {
+            continue;
+        }
+
+        activate(anEntry, true);
+        ++aCount;
+    }
+
+    return aCount;
+}
+
+int SelectionActivator::activateAll()
+{
+    waitForBuilds();
+    syncLocalContext();
+
+    int aCount = 0;
+
+    for (QHash<const void*, Entry>::iterator anIter = mEntries.begin(); anIter != mEntries.end(); ++anIter)
+    {
+        if (isPending(anIter.value()))
+        {
+            activate(anIter.value(), false);
+            ++aCount;
+        }
+    }
+
+    return aCount;
+}
+
+Handle_AIS_InteractiveObject SelectionActivator::fallbackPick(const Handle_V3d_View& theView, const int theX, const int theY)
+{
+    Handle_AIS_InteractiveObject aNearest;
+
+    Standard_Real anEye[3];
+    theView->Eye(anEye[0], anEye[1], anEye[2]);
+
+    Standard_Real aNearestDistance = RealLast();
+
+    syncProjection(theView);
+
+    for (QHash<const void*, Entry>::iterator anIter = mEntries.begin(); anIter != mEntries.end(); ++anIter)
+    {
+        Entry& anEntry = anIter.value();
+
+        if (anEntry.building.isEmpty() || anEntry.isHeld || !mContext->IsDisplayed(anEntry.object)
+            || !isUnder(anEntry, theX, theY, theX, theY))
+        {
+            continue;
+        }
+
+        const Bnd_Box& aBox = boundingBox(anEntry);
+
+        if (aBox.IsVoid())
+        {
+            continue;
+        }
+
+        Standard_Real aXmin, aYmin, aZmin, aXmax, aYmax, aZmax;
+        aBox.Get(aXmin, aYmin, aZmin, aXmax, aYmax, aZmax);
+
+        const gp_Pnt aCenter((aXmin + aXmax) * 0.5, (aYmin + aYmax) * 0.5, (aZmin + aZmax) * 0.5);
+        const Standard_Real aDistance = aCenter.SquareDistance(gp_Pnt(anEye[0], anEye[1], anEye[2]));
+
+        if (aDistance < aNearestDistance)
+        {
+            aNearestDistance = aDistance;
+            aNearest = anEntry.object;
+        }
+    }
+
+    return aNearest;
+}
+
+bool SelectionActivator::hoverFallback(const Handle_V3d_View& theView, const int theX, const int theY)
+{
+    Handle_AIS_InteractiveObject anObject;
+
+    // boxes stand for whole objects, sub-shapes of a local context need the real selection.
+    if (!mContext->HasOpenedContext() && !mContext->HasDetected())
+    {
+        anObject = fallbackPick(theView, theX, theY);
+    }
+
+    if (anObject == mHovered)
+    {
+        return !anObject.IsNull();
+    }
+
+    if (!mHovered.IsNull() && mContext->IsDisplayed(mHovered) && !mContext->IsSelected(mHovered))
+    {
+        mContext->Unhilight(mHovered, Standard_False);
+    }
+
+    mHovered = anObject;
+
+    if (!mHovered.IsNull() && !mContext->IsSelected(mHovered))
+    {
+        mContext->Hilight(mHovered, Standard_False);
+    }
+
+    mContext->UpdateCurrentViewer();
+
+    return !mHovered.IsNull();
+}
+
+void SelectionActivator::setHeld(const Handle_AIS_InteractiveObject& theObject, const bool theIsHeld)
+{
+    QHash<const void*, Entry>::iterator anIter = mEntries.find(theObject.Access());
+
+    if (anIter != mEntries.end())
+    {
+        anIter.value().isHeld = theIsHeld;
+    }
+}
+
+void SelectionActivator::clear()
+{
+    mEntries.clear();
+    mLocalModes.clear();
+    mHovered.Nullify();
+}
+
+int SelectionActivator::pendingCount() const
+{
+    int aCount = 0;
+
+    foreach (const Entry& anEntry, mEntries)
+    {
+        if (isPending(anEntry))
+        {
+            ++aCount;
+        }
+    }
+
+    return aCount;
+}
+
+int SelectionActivator::buildingCount() const
+{
+    return mJobs.size();
+}
+
+void SelectionActivator::track(const Handle_AIS_InteractiveObject& theObject, const bool theIsNeutralActive)
+{
+    const void* aKey = theObject.Access();
+
+    if (mEntries.contains(aKey))
+    {
+        return;
+    }
+
+    Entry anEntry;
+    anEntry.object = theObject;
+    anEntry.isNeutralActive = theIsNeutralActive;
+    anEntry.isHeld = false;
+    anEntry.rectStamp = -1;
+    anEntry.localIndex = 0;
+
+    mEntries.insert(aKey, anEntry);
+}
+
+void SelectionActivator::syncLocalContext()
+{
+    const Standard_Integer anIndex = mContext->HasOpenedContext() ? mContext->IndexOfCurrentLocal() : 0;
+
+    if (anIndex != mLocalIndex)
+    {
+        mLocalIndex = anIndex;
+        mLocalModes.clear();
+    }
+
+    // removed objects are dropped, erased ones keep their state for a later display.
+    QMutableHashIterator<const void*, Entry> anIter(mEntries);
+
+    while (anIter.hasNext())
+    {
+        if (mContext->DisplayStatus(anIter.next().value().object) == AIS_DS_None)
+        {
+            anIter.remove();
+        }
+    }
+}
+
+void SelectionActivator::syncProjection(const Handle_V3d_View& theView)
+{
+    // a mouse move without a camera change reuses the boxes in pixels.
+    const ViewProjection aProjection(theView);
+
+    if (aProjection != mProjection)
+    {
+        mProjection = aProjection;
+        ++mProjectionStamp;
+    }
+}
+
+bool SelectionActivator::isPending(const Entry& theEntry) const
+{
+    if (theEntry.isHeld || !mContext->IsDisplayed(theEntry.object))
+    {
+        return false;
+    }
+
+    if (mLocalIndex == 0)
+    {
+        return !theEntry.isNeutralActive && !theEntry.building.contains(0);
+    }
+
+    foreach (Standard_Integer aMode, mLocalModes)
+    {
+        if (theEntry.building.contains(aMode))
+        {
+            continue;
+        }
+
+        if (theEntry.localIndex != mLocalIndex || !theEntry.localModes.contains(aMode))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool SelectionActivator::isUnder(Entry& theEntry, const int theXmin, const int theYmin, const int theXmax, const int theYmax) const
+{
+    const Bnd_Box& aBox = boundingBox(theEntry);
+
+    // without a box the object can not be culled, it is under every pick.
+    if (aBox.IsVoid())
+    {
+        return true;
+    }
+
+    // projected once per camera, the moves in between only compare rectangles.
+    if (theEntry.rectStamp != mProjectionStamp)
+    {
+        mProjection.project(aBox, theEntry.rect[0], theEntry.rect[1], theEntry.rect[2], theEntry.rect[3]);
+        theEntry.rectStamp = mProjectionStamp;
+    }
+
+    return theEntry.rect[2] >= qMin(theXmin, theXmax) - THE_PIXEL_TOLERANCE
+        && theEntry.rect[0] <= qMax(theXmin, theXmax) + THE_PIXEL_TOLERANCE
+        && theEntry.rect[3] >= qMin(theYmin, theYmax) - THE_PIXEL_TOLERANCE
+        && theEntry.rect[1] <= qMax(theYmin, theYmax) + THE_PIXEL_TOLERANCE;
+}
+
+void SelectionActivator::activate(Entry& theEntry, const bool theInBackground)
+{
+    if (mLocalIndex == 0)
+    {
+        // the default mode of the object.
+        activateMode(theEntry, 0, theInBackground);
+        return;
+    }
+
+    foreach (Standard_Integer aMode, mLocalModes)
+    {
+        if (theEntry.localIndex != mLocalIndex || !theEntry.localModes.contains(aMode))
+        {
+            activateMode(theEntry, aMode, theInBackground);
+        }
+    }
+}
+
+void SelectionActivator::activateMode(Entry& theEntry, const Standard_Integer theMode, const bool theInBackground)
+{
+    if (theEntry.building.contains(theMode))
+    {
+        return;
+    }
+
+    Handle_AIS_Shape aShape = Handle_AIS_Shape::DownCast(theEntry.object);
+
+    if (theInBackground && !aShape.IsNull() && !aShape->HasSelection(theMode))
+    {
+        Job aJob;
+        aJob.key = theEntry.object.Access();
+        aJob.mode = theMode;
+        aJob.shape = aShape->Shape();
+
+        const Handle_SelectMgr_SelectableObject anObject = aShape;
+        const Standard_Real anAngle = aShape->Attributes()->HLRAngle();
+
+        Watcher* aWatcher = new Watcher();
+        QObject::connect(aWatcher, &Watcher::finished, [this, aWatcher]()
+        {
+            finished(aWatcher);
+        });
+
+        mJobs.insert(aWatcher, aJob);
+        theEntry.building.insert(theMode);
+
+        aWatcher->setFuture(QtConcurrent::run(computeSelection, anObject, aJob.shape, theMode, anAngle));
+
+        return;
+    }
+
+    // the selection exists or is computed here, the selector only registers it.
+    if (mLocalIndex == 0)
+    {
+        mContext->Activate(theEntry.object, theMode);
+
+        if (theMode == 0)
+        {
+            theEntry.isNeutralActive = true;
+        }
+
+        return;
+    }
+
+    if (theEntry.localIndex != mLocalIndex)
+    {
+        theEntry.localIndex = mLocalIndex;
+        theEntry.localModes.clear();
+    }
+
+    mContext->Load(theEntry.object, -1, Standard_True);
+    mContext->Activate(theEntry.object, theMode);
+
+    theEntry.localModes.insert(theMode);
+}
+
+void SelectionActivator::finished(Watcher* theWatcher)
+{
+    if (!mJobs.contains(theWatcher))
+    {
+        return;
+    }
+
+    const Job aJob = mJobs.take(theWatcher);
+    const Handle_SelectMgr_Selection aSelection = theWatcher->result();
+
+    theWatcher->disconnect();
+    theWatcher->deleteLater();
+
+    syncLocalContext();
+
+    QHash<const void*, Entry>::iterator anIter = mEntries.find(aJob.key);
+
+    if (anIter == mEntries.end())
+    {
+        return;
+    }
+
+    Entry& anEntry = anIter.value();
+    anEntry.building.remove(aJob.mode);
+
+    Handle_AIS_Shape aShape = Handle_AIS_Shape::DownCast(anEntry.object);
+
+    // a shape swapped meanwhile is built again on the next pick.
+    if (aSelection.IsNull() || aShape.IsNull() || !aShape->Shape().IsEqual(aJob.shape))
+    {
+        return;
+    }
+
+    if (!aShape->HasSelection(aJob.mode))
+    {
+        // a filled selection is taken as it is, nothing is computed again.
+        aShape->AddSelection(aSelection, aJob.mode);
+    }
+
+    const bool isWanted = (mLocalIndex == 0) ? (aJob.mode == 0 && !anEntry.isNeutralActive)
+                                             : mLocalModes.contains(aJob.mode);
+
+    if (isWanted && !anEntry.isHeld && mContext->IsDisplayed(anEntry.object))
+    {
+        activateMode(anEntry, aJob.mode, false);
+    }
+
+    if (mHovered == anEntry.object && anEntry.building.isEmpty())
+    {
+        // the real detection takes over at the next mouse move.
+        if (!mContext->IsSelected(mHovered))
+        {
+            mContext->Unhilight(mHovered, Standard_True);
+        }
+
+        mHovered.Nullify();
+    }
+}
+
+void SelectionActivator::waitForBuilds()
+{
+    foreach (Watcher* aWatcher, mJobs.keys())
+    {
+        aWatcher->waitForFinished();
+        finished(aWatcher);
+    }
+}
+
+const Bnd_Box& SelectionActivator::boundingBox(Entry& theEntry) const
+{
+    Handle_AIS_Shape aShape = Handle_AIS_Shape::DownCast(theEntry.object);
+
+    if (!aShape.IsNull() && !aShape->Shape().IsEqual(theEntry.boxShape))
+    {
+        theEntry.boxShape = aShape->Shape();
+        theEntry.box.SetVoid();
+        theEntry.rectStamp = -1;
+
+        BRepBndLib::Add(theEntry.boxShape, theEntry.box);
+    }
+
+    return theEntry.box;
+}
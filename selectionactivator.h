@@ -0,0 +1,148 @@
+#ifndef SELECTIONACTIVATOR_H
+#define SELECTIONACTIVATOR_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <Bnd_Box.hxx>
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "viewprojection.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_InteractiveObject.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <V3d_View.hxx>
+
+template <typename T> class QFutureWatcher;
+
+//! Lazy activation of selection modes.
+//! Objects are displayed without any selection mode, so no sensitive entities
+//! and no selection BVH are built at display time. The modes an object needs,
+//! the whole object at the neutral point or the standard modes of a local
+//! context, are activated the first time the cursor or a rubber band reaches
+//! the projected bounding box of the object. Objects that are only viewed
+//! never pay for their selection data.
+//!
+//! The sensitive entities of shapes are computed on worker threads and handed
+//! to the object on the GUI thread once ready. Until then an object is picked
+//! and highlighted by its bounding box only, so hover and click never wait.
+class SelectionActivator
+{
+public:
+    explicit SelectionActivator(const Handle_AIS_InteractiveContext& theContext);
+    ~SelectionActivator();
+
+    //! when off, display() activates the default mode right away.
+    void setLazy(const bool theIsLazy);
+    bool isLazy() const;
+
+    //! display an object, its selection is built on the first pick.
+    void display(const Handle_AIS_InteractiveObject& theObject, const Standard_Boolean theToUpdateViewer = Standard_False);
+
+    //! the lazy ActivateStandardMode() of the current local context, it must be open.
+    void activateStandardMode(const TopAbs_ShapeEnum theType);
+
+    //! start activating the pending modes of the objects whose projected bounding
+    //! box meets the rectangle in pixels, returns the number of objects concerned.
+    int activateIn(const Handle_V3d_View& theView, const int theXmin, const int theYmin, const int theXmax, const int theYmax);
+
+    //! activate all the pending modes now, waiting for the builds in flight.
+    int activateAll();
+
+    //! the nearest object under the pixel whose selection is still being built.
+    Handle_AIS_InteractiveObject fallbackPick(const Handle_V3d_View& theView, const int theX, const int theY);
+
+    //! highlight the fallback pick when the context detected nothing, returns true if one is highlighted.
+    bool hoverFallback(const Handle_V3d_View& theView, const int theX, const int theY);
+
+    //! a held object gets no mode activated, for example while another object picks for it.
+    void setHeld(const Handle_AIS_InteractiveObject& theObject, const bool theIsHeld);
+
+    //! forget all the objects, for example when the scene is cleared.
+    void clear();
+
+    //! the number of objects with a mode still to activate.
+    int pendingCount() const;
+
+    //! the number of selections being built on worker threads.
+    int buildingCount() const;
+
+private:
+    struct Entry
+    {
+        Handle_AIS_InteractiveObject object;
+
+        //! the shape the box was computed for, the box is refreshed when it changes.
+        TopoDS_Shape boxShape;
+        Bnd_Box box;
+
+        //! the box in pixels, valid while rectStamp is the stamp of the projection.
+        int rectStamp;
+        int rect[4];
+
+        bool isNeutralActive;
+        bool isHeld;
+
+        //! the local context the modes below were activated in.
+        Standard_Integer localIndex;
+        QSet<Standard_Integer> localModes;
+
+        //! modes whose selection is computed by a worker.
+        QSet<Standard_Integer> building;
+    };
+
+    typedef QFutureWatcher<Handle_SelectMgr_Selection> Watcher;
+
+    //! a selection computed by a worker.
+    struct Job
+    {
+        const void* key;
+        Standard_Integer mode;
+        TopoDS_Shape shape;
+    };
+
+    void track(const Handle_AIS_InteractiveObject& theObject, const bool theIsNeutralActive);
+
+    //! the modes of the current local context, reset when it changed.
+    void syncLocalContext();
+
+    //! capture the camera of theView, the boxes in pixels are kept until it changes.
+    void syncProjection(const Handle_V3d_View& theView);
+
+    bool isPending(const Entry& theEntry) const;
+    //! the box of the entry meets the rectangle in pixels, for the camera of the last syncProjection().
+    bool isUnder(Entry& theEntry, const int theXmin, const int theYmin, const int theXmax, const int theYmax) const;
+
+    //! activate the missing modes, on a worker when the selection has to be computed.
+    void activate(Entry& theEntry, const bool theInBackground);
+    void activateMode(Entry& theEntry, const Standard_Integer theMode, const bool theInBackground);
+
+    //! a selection built by a worker is ready.
+    void finished(Watcher* theWatcher);
+
+    void waitForBuilds();
+
+    const Bnd_Box& boundingBox(Entry& theEntry) const;
+
+    Handle_AIS_InteractiveContext mContext;
+    bool mIsLazy;
+
+    QHash<const void*, Entry> mEntries;
+
+    //! the camera the boxes in pixels were projected with, and its stamp.
+    ViewProjection mProjection;
+    int mProjectionStamp;
+
+    Standard_Integer mLocalIndex;
+    QList<Standard_Integer> mLocalModes;
+
+    QHash<Watcher*, Job> mJobs;
+
+    //! the object highlighted by its bounding box.
+    Handle_AIS_InteractiveObject mHovered;
+};
+
+#endif // SELECTIONACTIVATOR_H
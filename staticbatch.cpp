@@ -0,0 +1,415 @@
+#include "staticbatch.h"
+#include "topologyindex.h"
+
+#include <QHash>
+#include <QSet>
+#include <QVector>
+
+#include <gp.hxx>
+#include <gp_Dir.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Face.hxx>
+#include <TopLoc_Location.hxx>
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+
+#include <Graphic3d_ArrayOfTriangles.hxx>
+#include <Graphic3d_AspectFillArea3d.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Graphic3d_MaterialAspect.hxx>
+#include <Prs3d_Root.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+#include <PrsMgr_Presentation.hxx>
+#include <PrsMgr_PresentationManager3d.hxx>
+#include <PrsMgr_Presentations.hxx>
+#include <Select3D_SensitiveTriangulation.hxx>
+#include <SelectMgr_Selection.hxx>
+
+IMPLEMENT_STANDARD_HANDLE(StaticBatchOwner, StdSelect_BRepOwner)
+IMPLEMENT_STANDARD_RTTIEXT(StaticBatchOwner, StdSelect_BRepOwner)
+
+IMPLEMENT_STANDARD_HANDLE(StaticBatch, AIS_InteractiveObject)
+IMPLEMENT_STANDARD_RTTIEXT(StaticBatch, AIS_InteractiveObject)
+
+namespace
+{
+    //! colors equal in 8 bits per channel share a group.
+    int colorKey(const Quantity_Color& theColor)
+    {
+        return (qRound(theColor.Red() * 255.0) << 16) | (qRound(theColor.Green() * 255.0) << 8) | qRound(theColor.Blue() * 255.0);
+    }
+}
+
+StaticBatchOwner::StaticBatchOwner(const unsigned int theId, const TopoDS_Shape& theShape,
+                                   const Handle_SelectMgr_SelectableObject& theBatch)
+    // from decomposition: the highlight shows the member shape, not the batch.
+    : StdSelect_BRepOwner(theShape, theBatch, 0, Standard_True),
+      myId(theId)
+{
+}
+
+unsigned int StaticBatchOwner::Id() const
+{
+    return myId;
+}
+
+StaticBatch::StaticBatch()
+{
+    // members are highlighted through their owners.
+    SetAutoHilight(Standard_False);
+    SetDisplayMode(1);
+}
+
+void StaticBatch::Add(const unsigned int theId, const TopoDS_Shape& theShape, const Quantity_Color& theColor,
+                      const Handle_AIS_InteractiveObject& theOriginal)
+{
+    Member aMember;
+    aMember.id = theId;
+    aMember.shape = theShape;
+    aMember.color = theColor;
+    aMember.original = theOriginal;
+
+    myIndices.insert(theId, myMembers.size());
+    myMembers.append(aMember);
+
+    const int aKey = colorKey(theColor);
+    myGroupIds[aKey].append(theId);
+    myDirtyGroups.insert(aKey);
+}
+
+void StaticBatch::Remove(const Standard_Integer theIndex)
+{
+    const Member& aMember = myMembers.at(theIndex);
+    const int aKey = colorKey(aMember.color);
+
+    QList<unsigned int>& anIds = myGroupIds[aKey];
+    anIds.removeOne(aMember.id);
+
+    if (anIds.isEmpty())
+    {
+        myGroupIds.remove(aKey);
+    }
+
+    myDirtyGroups.insert(aKey);
+    myIndices.remove(aMember.id);
+
+    const int aLast = myMembers.size() - 1;
+
+    if (theIndex != aLast)
+    {
+        myMembers[theIndex] = myMembers.at(aLast);
+        myIndices.insert(myMembers.at(theIndex).id, theIndex);
+    }
+
+    myMembers.removeLast();
+}
+
+Standard_Boolean StaticBatch::Update()
+{
+    if (myDirtyGroups.isEmpty())
+    {
+        return Standard_False;
+    }
+
+    Handle_Prs3d_Presentation aPrs;
+    const PrsMgr_Presentations& aPresentations = Presentations();
+
+    for (Standard_Integer i = 1; i <= aPresentations.Length(); ++i)
+    {
+        if (aPresentations(i).Mode() == 1)
+        {
+            aPrs = aPresentations(i).Presentation()->Presentation();
+        }
+    }
+
+    // not computed yet, Compute() fills all the groups.
+    if (!aPrs.IsNull())
+    {
+        foreach (int aKey, myDirtyGroups)
+        {
+            fillGroup(aKey, aPrs);
+        }
+    }
+
+    myDirtyGroups.clear();
+
+    return Standard_True;
+}
+
+Standard_Integer StaticBatch::NbMembers() const
+{
+    return myMembers.size();
+}
+
+Standard_Integer StaticBatch::NbGroups() const
+{
+    return myGroupIds.size();
+}
+
+Standard_Integer StaticBatch::Index(const unsigned int theId) const
+{
+    return myIndices.value(theId, -1);
+}
+
+const Handle_AIS_InteractiveObject& StaticBatch::Original(const Standard_Integer theIndex) const
+{
+    return myMembers.at(theIndex).original;
+}
+
+unsigned int StaticBatch::Id(const Standard_Integer theIndex) const
+{
+    return myMembers.at(theIndex).id;
+}
+
+TColStd_ListOfInteger& StaticBatch::Modes(const Standard_Integer theIndex)
+{
+    return myMembers[theIndex].modes;
+}
+
+const TopoDS_Shape& StaticBatch::Shape(const Standard_Integer theIndex) const
+{
+    return myMembers.at(theIndex).shape;
+}
+
+const Quantity_Color& StaticBatch::Color(const Standard_Integer theIndex) const
+{
+    return myMembers.at(theIndex).color;
+}
+
+int StaticBatch::DetectedId(const Handle_AIS_InteractiveContext& theContext)
+{
+    if (!theContext->HasDetected())
+    {
+        return -1;
+    }
+
+    Handle_StaticBatchOwner anOwner = Handle_StaticBatchOwner::DownCast(theContext->DetectedOwner());
+
+    return anOwner.IsNull() ? -1 : int(anOwner->Id());
+}
+
+void StaticBatch::Compute(const Handle_PrsMgr_PresentationManager3d& thePM,
+                          const Handle_Prs3d_Presentation& thePrs,
+                          const Standard_Integer theMode)
+{
+    Q_UNUSED(thePM);
+    Q_UNUSED(theMode);
+
+    thePrs->Clear();
+
+    myPrsGroups.clear();
+    myDirtyGroups.clear();
+
+    // one array, one aspect and one draw call per color.
+    foreach (int aKey, myGroupIds.keys())
+    {
+        fillGroup(aKey, thePrs);
+    }
+}
+
+void StaticBatch::fillGroup(const int theKey, const Handle_Prs3d_Presentation& thePrs)
+{
+    Handle_Graphic3d_Group& aPrsGroup = myPrsGroups[theKey];
+
+    if (aPrsGroup.IsNull())
+    {
+        aPrsGroup = Prs3d_Root::NewGroup(thePrs);
+    }
+    else
+    {
+        aPrsGroup->Clear();
+    }
+
+    const QList<unsigned int> anIds = myGroupIds.value(theKey);
+
+    // 1. size the array.
+    Standard_Integer aNodeCount = 0;
+    Standard_Integer aTriangleCount = 0;
+
+    foreach (unsigned int anId, anIds)
+    {
+        QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(myMembers.at(myIndices.value(anId)).shape);
+
+        for (Standard_Integer f = 1; f <= anIndex->faces().Extent(); ++f)
+        {
+            TopLoc_Location aLocation;
+            Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anIndex->faces()(f)), aLocation);
+
+            if (!aTriangulation.IsNull())
+            {
+                aNodeCount += aTriangulation->NbNodes();
+                aTriangleCount += aTriangulation->NbTriangles();
+            }
+        }
+    }
+
+    // a color without members keeps an empty group.
+    if (aTriangleCount == 0)
+    {
+        return;
+    }
+
+    // 2. merge the face triangulations of the members.
+    Handle_Graphic3d_ArrayOfTriangles anArray = new Graphic3d_ArrayOfTriangles(aNodeCount, aTriangleCount * 3, Standard_True);
+
+    foreach (unsigned int anId, anIds)
+    {
+        QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(myMembers.at(myIndices.value(anId)).shape);
+
+        for (Standard_Integer f = 1; f <= anIndex->faces().Extent(); ++f)
+        {
+            const TopoDS_Face& aFace = TopoDS::Face(anIndex->faces()(f));
+
+            TopLoc_Location aLocation;
+            Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(aFace, aLocation);
+
+            if (aTriangulation.IsNull())
+            {
+                continue;
+            }
+
+            const gp_Trsf aTrsf = aLocation.Transformation();
+            const TColgp_Array1OfPnt& aNodes = aTriangulation->Nodes();
+            const Poly_Array1OfTriangle& aTriangles = aTriangulation->Triangles();
+            const Standard_Boolean isReversed = (aFace.Orientation() == TopAbs_REVERSED);
+
+            // area weighted node normals, smooth inside a face and sharp between faces.
+            QVector<gp_XYZ> aNormals(aNodes.Length(), gp_XYZ(0.0, 0.0, 0.0));
+            QVector<gp_Pnt> aPoints(aNodes.Length());
+
+            for (Standard_Integer n = aNodes.Lower(); n <= aNodes.Upper(); ++n)
+            {
+                aPoints[n - aNodes.Lower()] = aNodes(n).Transformed(aTrsf);
+            }
+
+            for (Standard_Integer t = aTriangles.Lower(); t <= aTriangles.Upper(); ++t)
+            {
+                Standard_Integer aN1, aN2, aN3;
+                aTriangles(t).Get(aN1, aN2, aN3);
+
+                if (isReversed)
+                {
+                    qSwap(aN2, aN3);
+                }
+
+                const gp_Pnt& aP1 = aPoints.at(aN1 - aNodes.Lower());
+                const gp_Pnt& aP2 = aPoints.at(aN2 - aNodes.Lower());
+                const gp_Pnt& aP3 = aPoints.at(aN3 - aNodes.Lower());
+
+                const gp_XYZ aNormal = (aP2.XYZ() - aP1.XYZ()) ^ (aP3.XYZ() - aP1.XYZ());
+
+                aNormals[aN1 - aNodes.Lower()] += aNormal;
+                aNormals[aN2 - aNodes.Lower()] += aNormal;
+                aNormals[aN3 - aNodes.Lower()] += aNormal;
+            }
+
+            const Standard_Integer aFirst = anArray->VertexNumber();
+
+            for (int n = 0; n < aPoints.size(); ++n)
+            {
+                gp_XYZ aNormal = aNormals.at(n);
+                const Standard_Real aModulus = aNormal.Modulus();
+
+                aNormal = (aModulus > gp::Resolution()) ? aNormal / aModulus : gp_XYZ(0.0, 0.0, 1.0);
+
+                anArray->AddVertex(aPoints.at(n), gp_Dir(aNormal));
+            }
+
+            for (Standard_Integer t = aTriangles.Lower(); t <= aTriangles.Upper(); ++t)
+            {
+                Standard_Integer aN1, aN2, aN3;
+                aTriangles(t).Get(aN1, aN2, aN3);
+
+                if (isReversed)
+                {
+                    qSwap(aN2, aN3);
+                }
+
+                anArray->AddEdge(aFirst + aN1 - aNodes.Lower() + 1);
+                anArray->AddEdge(aFirst + aN2 - aNodes.Lower() + 1);
+                anArray->AddEdge(aFirst + aN3 - aNodes.Lower() + 1);
+            }
+        }
+    }
+
+    Handle_Prs3d_ShadingAspect anAspect = new Prs3d_ShadingAspect();
+    anAspect->SetMaterial(myDrawer->ShadingAspect()->Material());
+    anAspect->SetColor(myMembers.at(myIndices.value(anIds.first())).color);
+
+    aPrsGroup->SetGroupPrimitivesAspect(anAspect->Aspect());
+    aPrsGroup->AddPrimitiveArray(anArray);
+}
+
+void StaticBatch::ComputeSelection(const Handle_SelectMgr_Selection& theSelection,
+                                   const Standard_Integer theMode)
+{
+    // only whole members are picked.
+    if (theMode != 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < myMembers.size(); ++i)
+    {
+        Member& aMember = myMembers[i];
+
+        if (aMember.owner.IsNull())
+        {
+            aMember.owner = new StaticBatchOwner(aMember.id, aMember.shape, this);
+
+            QSharedPointer<const TopologyIndex> anIndex = TopologyIndex::of(aMember.shape);
+
+            for (Standard_Integer f = 1; f <= anIndex->faces().Extent(); ++f)
+            {
+                TopLoc_Location aLocation;
+                Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anIndex->faces()(f)), aLocation);
+
+                if (!aTriangulation.IsNull())
+                {
+                    aMember.sensitives.append(new Select3D_SensitiveTriangulation(aMember.owner, aTriangulation, aLocation, Standard_True));
+                }
+            }
+        }
+
+        foreach (const Handle_Select3D_SensitiveEntity& aSensitive, aMember.sensitives)
+        {
+            theSelection->Add(aSensitive);
+        }
+    }
+}
+
+void StaticBatch::HilightOwnerWithColor(const Handle_PrsMgr_PresentationManager3d& thePM,
+                                        const Quantity_NameOfColor theColor,
+                                        const Handle_SelectMgr_EntityOwner& theOwner)
+{
+    theOwner->HilightWithColor(thePM, theColor);
+}
+
+void StaticBatch::HilightSelected(const Handle_PrsMgr_PresentationManager3d& thePM,
+                                  const SelectMgr_SequenceOfOwner& theOwners)
+{
+    const Quantity_NameOfColor aColor = GetContext().IsNull() ? Quantity_NOC_GRAY80 : GetContext()->SelectionColor();
+
+    for (Standard_Integer i = 1; i <= theOwners.Length(); ++i)
+    {
+        theOwners(i)->HilightWithColor(thePM, aColor);
+    }
+}
+
+void StaticBatch::ClearSelected()
+{
+    if (GetContext().IsNull())
+    {
+        return;
+    }
+
+    const Handle_PrsMgr_PresentationManager3d& aPM = GetContext()->MainPrsMgr();
+
+    foreach (const Member& aMember, myMembers)
+    {
+        if (!aMember.owner.IsNull() && aMember.owner->IsHilighted(aPM))
+        {
+            aMember.owner->Unhilight(aPM);
+        }
+    }
+}
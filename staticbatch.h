@@ -0,0 +1,132 @@
+#ifndef STATICBATCH_H
+#define STATICBATCH_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+
+#include <Standard_DefineHandle.hxx>
+#include <Quantity_Color.hxx>
+#include <TopoDS_Shape.hxx>
+#include <TColStd_ListOfInteger.hxx>
+
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <Select3D_SensitiveEntity.hxx>
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_InteractiveObject.hxx>
+#include <SelectMgr_SequenceOfOwner.hxx>
+#include <StdSelect_BRepOwner.hxx>
+
+DEFINE_STANDARD_HANDLE(StaticBatchOwner, StdSelect_BRepOwner)
+
+//! The owner of one member of a batch, it carries the id of the shape and
+//! highlights the member shape only.
+class StaticBatchOwner : public StdSelect_BRepOwner
+{
+public:
+    StaticBatchOwner(const unsigned int theId, const TopoDS_Shape& theShape,
+                     const Handle_SelectMgr_SelectableObject& theBatch);
+
+    unsigned int Id() const;
+
+    DEFINE_STANDARD_RTTI(StaticBatchOwner)
+
+private:
+    unsigned int myId;
+};
+
+DEFINE_STANDARD_HANDLE(StaticBatch, AIS_InteractiveObject)
+
+//! Many static shapes drawn as one object.
+//! The triangulations of the members are merged into one triangle array per
+//! color, so the whole batch costs one structure and one draw call per color
+//! instead of one structure per shape. Each member keeps its own sensitive
+//! triangulations and an owner with its id, so picking and highlighting
+//! still work per shape. Members come and go one by one, only the arrays of
+//! their colors are built again.
+class StaticBatch : public AIS_InteractiveObject
+{
+public:
+    StaticBatch();
+
+    //! add a triangulated shape, theOriginal is the object it stands for.
+    void Add(const unsigned int theId, const TopoDS_Shape& theShape, const Quantity_Color& theColor,
+             const Handle_AIS_InteractiveObject& theOriginal = Handle_AIS_InteractiveObject());
+
+    //! take a member out, the last member takes its index.
+    void Remove(const Standard_Integer theIndex);
+
+    //! build again the arrays of the colors whose members were added or
+    //! removed since the presentation was computed, the others are kept.
+    //! False when nothing changed.
+    Standard_Boolean Update();
+
+    Standard_Integer NbMembers() const;
+    Standard_Integer NbGroups() const;
+
+    //! the index of the member theId, -1 when it is not batched.
+    Standard_Integer Index(const unsigned int theId) const;
+
+    //! the member objects and the selection modes they had before being batched.
+    const Handle_AIS_InteractiveObject& Original(const Standard_Integer theIndex) const;
+    unsigned int Id(const Standard_Integer theIndex) const;
+    TColStd_ListOfInteger& Modes(const Standard_Integer theIndex);
+
+    //! the shape and the color the member was batched with.
+    const TopoDS_Shape& Shape(const Standard_Integer theIndex) const;
+    const Quantity_Color& Color(const Standard_Integer theIndex) const;
+
+    //! the id of the batch member under the cursor, -1 if none.
+    static int DetectedId(const Handle_AIS_InteractiveContext& theContext);
+
+    virtual void HilightOwnerWithColor(const Handle_PrsMgr_PresentationManager3d& thePM,
+                                       const Quantity_NameOfColor theColor,
+                                       const Handle_SelectMgr_EntityOwner& theOwner);
+    virtual void HilightSelected(const Handle_PrsMgr_PresentationManager3d& thePM,
+                                 const SelectMgr_SequenceOfOwner& theOwners);
+    virtual void ClearSelected();
+
+    DEFINE_STANDARD_RTTI(StaticBatch)
+
+protected:
+    virtual void Compute(const Handle_PrsMgr_PresentationManager3d& thePM,
+                         const Handle_Prs3d_Presentation& thePrs,
+                         const Standard_Integer theMode = 0);
+
+    virtual void ComputeSelection(const Handle_SelectMgr_Selection& theSelection,
+                                  const Standard_Integer theMode);
+
+private:
+    struct Member
+    {
+        unsigned int id;
+        TopoDS_Shape shape;
+        Quantity_Color color;
+        Handle_AIS_InteractiveObject original;
+        TColStd_ListOfInteger modes;
+
+        //! made by the first selection computation and kept, a new selection
+        //! of the batch only collects them.
+        Handle_StaticBatchOwner owner;
+        QList<Handle_Select3D_SensitiveEntity> sensitives;
+    };
+
+    //! fill the presentation group of the color theKey from its members.
+    void fillGroup(const int theKey, const Handle_Prs3d_Presentation& thePrs);
+
+    QList<Member> myMembers;
+
+    //! the index of each member by its id.
+    QHash<unsigned int, int> myIndices;
+
+    //! the ids of the members of each color, by color key.
+    QHash<int, QList<unsigned int> > myGroupIds;
+
+    //! the presentation group of each color and the colors to build again.
+    QHash<int, Handle_Graphic3d_Group> myPrsGroups;
+    QSet<int> myDirtyGroups;
+};
+
+#endif // STATICBATCH_H
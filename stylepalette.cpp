@@ -0,0 +1,212 @@
+#include "stylepalette.h"
+
+#include <AIS_Drawer.hxx>
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+#include <Aspect_TypeOfLine.hxx>
+#include <Graphic3d_Group.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_Presentation.hxx>
+#include <PrsMgr_Presentations.hxx>
+
+const QString StylePalette::DEFAULT_STYLE("default");
+
+StylePalette::StylePalette(const Handle_AIS_InteractiveContext& theContext)
+    : mContext(theContext)
+{
+    const Handle_AIS_Drawer& aDefaults = theContext->DefaultDrawer();
+
+    define(DEFAULT_STYLE, aDefaults->ShadingAspect()->Color(), aDefaults->ShadingAspect()->Material().Name());
+}
+
+void StylePalette::define(const QString& theName, const Quantity_Color& theColor, const Graphic3d_NameOfMaterial theMaterial)
+{
+    Style& aStyle = mStyles[theName];
+
+    if (aStyle.shading.IsNull())
+    {
+        aStyle.shading = new Prs3d_ShadingAspect();
+        aStyle.line = new Prs3d_LineAspect(theColor, Aspect_TOL_SOLID, 1.0);
+    }
+
+    // the aspects are edited in place, every drawer referencing them sees the change.
+    aStyle.shading->SetMaterial(Graphic3d_MaterialAspect(theMaterial));
+    aStyle.shading->SetColor(theColor);
+    aStyle.line->SetColor(theColor);
+
+    foreach (const void* aKey, aStyle.members)
+    {
+        push(mBindings.value(aKey).object, aStyle.shading, aStyle.line);
+    }
+}
+
+bool StylePalette::contains(const QString& theName) const
+{
+    return mStyles.contains(theName);
+}
+
+QStringList StylePalette::names() const
+{
+    QStringList aNames = mStyles.keys();
+    aNames.sort();
+
+    return aNames;
+}
+
+Quantity_Color StylePalette::color(const QString& theName) const
+{
+    return mStyles.value(theName).shading->Color();
+}
+
+Graphic3d_NameOfMaterial StylePalette::material(const QString& theName) const
+{
+    return mStyles.value(theName).shading->Material().Name();
+}
+
+int StylePalette::apply(const QString& theName, const AIS_ListOfInteractive& theObjects, const Standard_Boolean theToUpdateViewer)
+{
+    if (!mStyles.contains(theName))
+    {
+        return 0;
+    }
+
+    Style& aStyle = mStyles[theName];
+    int aCount = 0;
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(theObjects); anIter.More(); anIter.Next())
+    {
+        const Handle_AIS_InteractiveObject& anObject = anIter.Value();
+        const void* aKey = anObject.Access();
+
+        if (mBindings.contains(aKey))
+        {
+            Binding& aBinding = mBindings[aKey];
+
+            if (aBinding.style == theName)
+            {
+                continue;
+            }
+
+            mStyles[aBinding.style].members.remove(aKey);
+            aBinding.style = theName;
+        }
+        else
+        {
+            Binding aBinding;
+            aBinding.object = anObject;
+            aBinding.style = theName;
+            aBinding.ownShading = anObject->Attributes()->ShadingAspect();
+            aBinding.ownWire = anObject->Attributes()->WireAspect();
+
+            mBindings.insert(aKey, aBinding);
+        }
+
+        aStyle.members.insert(aKey);
+        push(anObject, aStyle.shading, aStyle.line);
+        ++aCount;
+    }
+
+    if (theToUpdateViewer)
+    {
+        mContext->UpdateCurrentViewer();
+    }
+
+    return aCount;
+}
+
+int StylePalette::release(const AIS_ListOfInteractive& theObjects, const Standard_Boolean theToUpdateViewer)
+{
+    int aCount = 0;
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(theObjects); anIter.More(); anIter.Next())
+    {
+        const void* aKey = anIter.Value().Access();
+
+        if (!mBindings.contains(aKey))
+        {
+            continue;
+        }
+
+        const Binding aBinding = mBindings.take(aKey);
+        mStyles[aBinding.style].members.remove(aKey);
+
+        push(aBinding.object, aBinding.ownShading, aBinding.ownWire);
+        ++aCount;
+    }
+
+    if (theToUpdateViewer)
+    {
+        mContext->UpdateCurrentViewer();
+    }
+
+    return aCount;
+}
+
+QString StylePalette::styleOf(const Handle_AIS_InteractiveObject& theObject) const
+{
+    return mBindings.value(theObject.Access()).style;
+}
+
+Quantity_Color StylePalette::colorOf(const Handle_AIS_InteractiveObject& theObject) const
+{
+    const QHash<const void*, Binding>::const_iterator anIter = mBindings.constFind(theObject.Access());
+
+    if (anIter != mBindings.constEnd())
+    {
+        return mStyles.value(anIter.value().style).shading->Color();
+    }
+
+    // the drawer falls back to the default aspect of the context.
+    return theObject->Attributes()->ShadingAspect()->Color();
+}
+
+int StylePalette::memberCount(const QString& theName) const
+{
+    return mStyles.value(theName).members.size();
+}
+
+void StylePalette::clear()
+{
+    mBindings.clear();
+
+    for (QHash<QString, Style>::iterator anIter = mStyles.begin(); anIter != mStyles.end(); ++anIter)
+    {
+        anIter.value().members.clear();
+    }
+}
+
+void StylePalette::push(const Handle_AIS_InteractiveObject& theObject,
+                        const Handle_Prs3d_ShadingAspect& theShading, const Handle_Prs3d_LineAspect& theLine)
+{
+    const Handle_AIS_Drawer& aDrawer = theObject->Attributes();
+
+    aDrawer->SetShadingAspect(theShading);
+    aDrawer->SetShadingAspectGlobal(Standard_False);
+    aDrawer->SetWireAspect(theLine);
+
+    // the computed presentations take the aspects over, nothing is recomputed.
+    const PrsMgr_Presentations& aPresentations = theObject->Presentations();
+
+    for (Standard_Integer i = 1; i <= aPresentations.Length(); ++i)
+    {
+        const Handle_Prs3d_Presentation& aStructure = aPresentations(i).Presentation()->Presentation();
+
+        aStructure->SetPrimitivesAspect(theShading->Aspect());
+        aStructure->SetPrimitivesAspect(theLine->Aspect());
+
+        // the groups hold their own aspects, as AIS_Shape::SetColor() updates them.
+        for (Graphic3d_SequenceOfGroup::Iterator aGroupIter(aStructure->Groups()); aGroupIter.More(); aGroupIter.Next())
+        {
+            const Handle_Graphic3d_Group& aGroup = aGroupIter.Value();
+
+            if (aGroup->IsGroupPrimitivesAspectSet(Graphic3d_ASPECT_FILL_AREA))
+            {
+                aGroup->SetGroupPrimitivesAspect(theShading->Aspect());
+            }
+
+            if (aGroup->IsGroupPrimitivesAspectSet(Graphic3d_ASPECT_LINE))
+            {
+                aGroup->SetGroupPrimitivesAspect(theLine->Aspect());
+            }
+        }
+    }
+}
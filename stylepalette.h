@@ -0,0 +1,91 @@
+#ifndef STYLEPALETTE_H
+#define STYLEPALETTE_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <Quantity_Color.hxx>
+#include <Graphic3d_NameOfMaterial.hxx>
+#include <Prs3d_LineAspect.hxx>
+#include <Prs3d_ShadingAspect.hxx>
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_InteractiveObject.hxx>
+#include <AIS_ListOfInteractive.hxx>
+
+//! Named styles shared by many objects.
+//! The drawer of every member references the shading and line aspects of its
+//! style instead of a private copy. Changing a style edits these shared
+//! aspects once and pushes them to the existing presentations of the members
+//! with SetPrimitivesAspect() and SetGroupPrimitivesAspect(): colors change
+//! without any presentation being recomputed, and a later recomputation picks
+//! the style up from the drawer. SetColor() on a member would edit the shared
+//! aspect, release it first. A member keeps the HasColor() of its own color,
+//! colorOf() gives the color it is drawn with.
+class StylePalette
+{
+public:
+    //! the style holding the default aspects of the context.
+    static const QString DEFAULT_STYLE;
+
+    explicit StylePalette(const Handle_AIS_InteractiveContext& theContext);
+
+    //! add a style or change an existing one, its members are updated in place.
+    void define(const QString& theName, const Quantity_Color& theColor,
+                const Graphic3d_NameOfMaterial theMaterial = Graphic3d_NOM_BRASS);
+
+    bool contains(const QString& theName) const;
+    QStringList names() const;
+
+    Quantity_Color color(const QString& theName) const;
+    Graphic3d_NameOfMaterial material(const QString& theName) const;
+
+    //! make the objects members of a style, returns the number of objects changed.
+    int apply(const QString& theName, const AIS_ListOfInteractive& theObjects, const Standard_Boolean theToUpdateViewer = Standard_False);
+
+    //! give the objects back the aspects they had before their first style.
+    int release(const AIS_ListOfInteractive& theObjects, const Standard_Boolean theToUpdateViewer = Standard_False);
+
+    //! the style of an object, empty when it has none.
+    QString styleOf(const Handle_AIS_InteractiveObject& theObject) const;
+
+    //! the shading color an object is drawn with: its style, its own color or the default one.
+    Quantity_Color colorOf(const Handle_AIS_InteractiveObject& theObject) const;
+
+    //! the number of objects referencing a style.
+    int memberCount(const QString& theName) const;
+
+    //! forget all the memberships, the objects keep their current look.
+    void clear();
+
+private:
+    struct Style
+    {
+        Handle_Prs3d_ShadingAspect shading;
+        Handle_Prs3d_LineAspect line;
+        QSet<const void*> members;
+    };
+
+    struct Binding
+    {
+        Handle_AIS_InteractiveObject object;
+        QString style;
+
+        //! the aspects of the object before it joined a style.
+        Handle_Prs3d_ShadingAspect ownShading;
+        Handle_Prs3d_LineAspect ownWire;
+    };
+
+    //! set the aspects in the drawer and in the computed presentations.
+    static void push(const Handle_AIS_InteractiveObject& theObject,
+                     const Handle_Prs3d_ShadingAspect& theShading, const Handle_Prs3d_LineAspect& theLine);
+
+    Handle_AIS_InteractiveContext mContext;
+
+    QHash<QString, Style> mStyles;
+    QHash<const void*, Binding> mBindings;
+};
+
+#endif // STYLEPALETTE_H
@@ -0,0 +1,113 @@
+#include "subshapeselection.h"
+
+#include <QSet>
+#include <QVector>
+
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+#include <SelectMgr_Selection.hxx>
+#include <StdSelect_BRepOwner.hxx>
+
+int SubShapeSelection::select(const Handle_AIS_InteractiveContext& theContext, const AIS_ListOfInteractive& theObjects,
+                              const TopAbs_ShapeEnum theType, const Predicate& thePredicate,
+                              const bool theToSelect, const Standard_Boolean theToUpdateViewer)
+{
+    if (!theContext->HasOpenedContext())
+    {
+        theContext->OpenLocalContext();
+    }
+
+    const Standard_Integer aMode = AIS_Shape::SelectionMode(theType);
+
+    QVector<Handle_SelectMgr_EntityOwner> anOwners;
+    QSet<const void*> aVisited;
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(theObjects); anIter.More(); anIter.Next())
+    {
+        // shapes and instances of shapes, which take the modes of their prototype.
+        const Handle_AIS_InteractiveObject& anObject = anIter.Value();
+
+        if (anObject.IsNull() || !anObject->AcceptShapeDecomposition())
+        {
+            continue;
+        }
+
+        // the sensitive entities of the mode are computed on activation.
+        theContext->Load(anObject, -1, Standard_True);
+        theContext->Activate(anObject, aMode);
+
+        if (!anObject->HasSelection(aMode))
+        {
+            continue;
+        }
+
+        const Handle_SelectMgr_Selection& aSelection = anObject->Selection(aMode);
+
+        for (aSelection->Init(); aSelection->More(); aSelection->Next())
+        {
+            Handle_StdSelect_BRepOwner anOwner = Handle_StdSelect_BRepOwner::DownCast(aSelection->Sensitive()->OwnerId());
+
+            // a sub-shape may have several sensitive entities, its owner counts once.
+            if (anOwner.IsNull() || aVisited.contains(anOwner.Access()))
+            {
+                continue;
+            }
+
+            aVisited.insert(anOwner.Access());
+
+            if ((anOwner->State() != 0) == theToSelect)
+            {
+                continue;
+            }
+
+            if (thePredicate && !thePredicate(anOwner->Shape()))
+            {
+                continue;
+            }
+
+            anOwners.append(anOwner);
+        }
+    }
+
+    if (anOwners.isEmpty())
+    {
+        return 0;
+    }
+
+    // each AddOrRemoveSelected would otherwise unhighlight and highlight the whole selection.
+    const Standard_Boolean isAutomatic = theContext->AutomaticHilight();
+
+    theContext->UnhilightSelected(Standard_False);
+    theContext->SetAutomaticHilight(Standard_False);
+
+    foreach (const Handle_SelectMgr_EntityOwner& anOwner, anOwners)
+    {
+        theContext->AddOrRemoveSelected(anOwner, Standard_False);
+    }
+
+    theContext->SetAutomaticHilight(isAutomatic);
+    theContext->HilightSelected(theToUpdateViewer);
+
+    return anOwners.size();
+}
+
+int SubShapeSelection::select(const Handle_AIS_InteractiveContext& theContext, const Handle_AIS_Shape& theObject,
+                              const TopAbs_ShapeEnum theType, const Predicate& thePredicate,
+                              const bool theToSelect, const Standard_Boolean theToUpdateViewer)
+{
+    AIS_ListOfInteractive anObjects;
+    anObjects.Append(theObject);
+
+    return select(theContext, anObjects, theType, thePredicate, theToSelect, theToUpdateViewer);
+}
+
+int SubShapeSelection::selectAll(const Handle_AIS_InteractiveContext& theContext, const TopAbs_ShapeEnum theType,
+                                 const Predicate& thePredicate,
+                                 const bool theToSelect, const Standard_Boolean theToUpdateViewer)
+{
+    AIS_ListOfInteractive aDisplayedList;
+
+    // the objects displayed at the neutral point, a local context loads them on activation.
+    theContext->DisplayedObjects(aDisplayedList, Standard_True);
+
+    return select(theContext, aDisplayedList, theType, thePredicate, theToSelect, theToUpdateViewer);
+}
@@ -0,0 +1,41 @@
+#ifndef SUBSHAPESELECTION_H
+#define SUBSHAPESELECTION_H
+
+#include <functional>
+
+#include <TopAbs_ShapeEnum.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_ListOfInteractive.hxx>
+#include <AIS_Shape.hxx>
+
+//! Select or deselect whole sets of sub-shapes in one operation.
+//! The owners of the matching sub-shapes are collected from the selection of
+//! each object once, the context selection is changed with the automatic
+//! highlight off and the highlight is updated a single time at the end,
+//! instead of one lookup and one full re-highlight per sub-shape.
+class SubShapeSelection
+{
+public:
+    //! decides if a sub-shape takes part, an empty predicate accepts all.
+    typedef std::function<bool (const TopoDS_Shape&)> Predicate;
+
+    //! change the sub-shapes of theType of the given objects, returns the number of owners changed.
+    //! A local context is opened if none is, the selection mode of theType is activated.
+    static int select(const Handle_AIS_InteractiveContext& theContext, const AIS_ListOfInteractive& theObjects,
+                      const TopAbs_ShapeEnum theType, const Predicate& thePredicate = Predicate(),
+                      const bool theToSelect = true, const Standard_Boolean theToUpdateViewer = Standard_True);
+
+    //! the same for one object.
+    static int select(const Handle_AIS_InteractiveContext& theContext, const Handle_AIS_Shape& theObject,
+                      const TopAbs_ShapeEnum theType, const Predicate& thePredicate = Predicate(),
+                      const bool theToSelect = true, const Standard_Boolean theToUpdateViewer = Standard_True);
+
+    //! the same for all the displayed shapes.
+    static int selectAll(const Handle_AIS_InteractiveContext& theContext, const TopAbs_ShapeEnum theType,
+                         const Predicate& thePredicate = Predicate(),
+                         const bool theToSelect = true, const Standard_Boolean theToUpdateViewer = Standard_True);
+};
+
+#endif // SUBSHAPESELECTION_H
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Meshes the primitives in closed form and compares the result with
+# BRepMesh.
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent testlib
+QT       -= widgets
+
+TARGET = tst_analyticmesher
+TEMPLATE = app
+
+CONFIG += testcase console c++11
+CONFIG -= app_bundle
+
+SOURCES += tst_analyticmesher.cpp
+
+include(../../modeling/modeling.pri)
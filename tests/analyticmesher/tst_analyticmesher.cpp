@@ -0,0 +1,112 @@
+#include "analyticmesher.h"
+#include "shapefactory.h"
+
+#include <QtTest>
+
+#include <gp_Ax2.hxx>
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+
+#include <Bnd_Box.hxx>
+#include <BRepBndLib.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepTools.hxx>
+
+//! Each primitive is meshed in closed form and by BRepMesh. The closed-form
+//! mesh must be complete for BRepTools and cover the same box.
+class TestAnalyticMesher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void primitive_data();
+    void primitive();
+
+private:
+    //! the primitive theKind, built again with new TShapes and no mesh on every call.
+    static TopoDS_Shape makeShape(const QByteArray& theKind);
+};
+
+TopoDS_Shape TestAnalyticMesher::makeShape(const QByteArray& theKind)
+{
+    // tilted, so the boxes do not follow from the axes alone.
+    const gp_Ax2 anAxis(gp_Pnt(1.0, 2.0, 3.0), gp_Dir(1.0, 1.0, 2.0));
+
+    if (theKind == "sphere")
+    {
+        return ShapeFactory::makeSphere(anAxis, 3.0);
+    }
+    else if (theKind == "cylinder")
+    {
+        return ShapeFactory::makeCylinder(anAxis, 3.0, 5.0);
+    }
+    else if (theKind == "cone")
+    {
+        return ShapeFactory::makeCone(anAxis, 3.0, 1.5, 5.0);
+    }
+    else if (theKind == "torus")
+    {
+        return ShapeFactory::makeTorus(anAxis, 3.0, 1.0);
+    }
+
+    return ShapeFactory::makeBox(anAxis, 3.0, 4.0, 5.0);
+}
+
+void TestAnalyticMesher::primitive_data()
+{
+    QTest::addColumn<QByteArray>("kind");
+    QTest::addColumn<int>("faceCount");
+
+    QTest::newRow("sphere") << QByteArray("sphere") << 1;
+    QTest::newRow("cylinder") << QByteArray("cylinder") << 3;
+    QTest::newRow("cone") << QByteArray("cone") << 3;
+    QTest::newRow("torus") << QByteArray("torus") << 1;
+    QTest::newRow("box") << QByteArray("box") << 6;
+}
+
+void TestAnalyticMesher::primitive()
+{
+    QFETCH(QByteArray, kind);
+    QFETCH(int, faceCount);
+
+    const Standard_Real aDeflection = 0.01;
+
+    const TopoDS_Shape aShape = makeShape(kind);
+
+    int aMeshedCount = -1;
+    QVERIFY(AnalyticMesher::perform(aShape, aDeflection, 0.5, &aMeshedCount));
+    QCOMPARE(aMeshedCount, faceCount);
+
+    // every face has a triangulation fine enough and every edge its polygons on them.
+    QVERIFY(BRepTools::Triangulation(aShape, aDeflection));
+
+    // a meshed shape is left as it is.
+    QVERIFY(AnalyticMesher::perform(aShape, aDeflection, 0.5, &aMeshedCount));
+    QCOMPARE(aMeshedCount, 0);
+
+    const TopoDS_Shape aReference = makeShape(kind);
+    BRepMesh_IncrementalMesh(aReference, aDeflection, Standard_False, 0.5);
+    QVERIFY(BRepTools::Triangulation(aReference, aDeflection));
+
+    // the boxes are taken around the triangulations.
+    Bnd_Box aBox;
+    BRepBndLib::Add(aShape, aBox);
+
+    Bnd_Box aReferenceBox;
+    BRepBndLib::Add(aReference, aReferenceBox);
+
+    Standard_Real aMin[3], aMax[3], aReferenceMin[3], aReferenceMax[3];
+    aBox.Get(aMin[0], aMin[1], aMin[2], aMax[0], aMax[1], aMax[2]);
+    aReferenceBox.Get(aReferenceMin[0], aReferenceMin[1], aReferenceMin[2], aReferenceMax[0], aReferenceMax[1], aReferenceMax[2]);
+
+    // both meshes lie within the deflection of the surfaces.
+    for (int i = 0; i < 3; ++i)
+    {
+        QVERIFY2(qAbs(aMin[i] - aReferenceMin[i]) <= 2.0 * aDeflection, qPrintable(QString("min %1: %2 instead of %3").arg(i).arg(aMin[i]).arg(aReferenceMin[i])));
+        QVERIFY2(qAbs(aMax[i] - aReferenceMax[i]) <= 2.0 * aDeflection, qPrintable(QString("max %1: %2 instead of %3").arg(i).arg(aMax[i]).arg(aReferenceMax[i])));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestAnalyticMesher)
+
+#include "tst_analyticmesher.moc"
@@ -0,0 +1,22 @@
+#-------------------------------------------------
+#
+# Runs the example job file on one and on several threads and compares
+# the results.
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent testlib
+QT       -= widgets
+
+TARGET = tst_batchrunner
+TEMPLATE = app
+
+CONFIG += testcase console c++11
+CONFIG -= app_bundle
+
+SOURCES += tst_batchrunner.cpp
+
+# the export jobs load the exchange plugin, built by occqt.pro into plugins/.
+DEFINES += OCCQT_TEST_PLUGIN_PATH=\\\"$$shadowed($$PWD/../../plugins)\\\"
+
+include(../../modeling/modeling.pri)
@@ -0,0 +1,142 @@
+#include "batchrunner.h"
+
+#include <QDir>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QtTest>
+
+#include <BRepCheck_Analyzer.hxx>
+#include <BRepGProp.hxx>
+#include <GProp_GProps.hxx>
+#include <TopExp.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
+
+//! The jobs of a wave share their inputs, their results must not depend on
+//! the number of threads running them.
+class TestBatchRunner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void sameResultsOnAnyThreadCount();
+
+private:
+    //! run the job file, one line per named result and the number of failed jobs.
+    void run(const int theThreadCount, QStringList& theResults, int& theFailures);
+
+    QTemporaryDir mDirectory;
+    QString mJobFile;
+    QString mCurrentPath;
+    int mThreadCount;
+
+    //! the timings and errors of the last run.
+    QString mSummary;
+};
+
+void TestBatchRunner::initTestCase()
+{
+    mJobFile = QFINDTESTDATA("../../examples/operands.job");
+    QVERIFY2(!mJobFile.isEmpty(), "examples/operands.job not found");
+    QVERIFY(mDirectory.isValid());
+
+    // the exports of the job file are written to the current directory.
+    mCurrentPath = QDir::currentPath();
+    QVERIFY(QDir::setCurrent(mDirectory.path()));
+
+    mThreadCount = QThreadPool::globalInstance()->maxThreadCount();
+
+    // the STEP export of the job file needs the plugin, not a plugins directory next to the test.
+    if (qgetenv("OCCQT_PLUGIN_PATH").isEmpty())
+    {
+        qputenv("OCCQT_PLUGIN_PATH", OCCQT_TEST_PLUGIN_PATH);
+    }
+}
+
+void TestBatchRunner::cleanupTestCase()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(mThreadCount);
+    QDir::setCurrent(mCurrentPath);
+}
+
+void TestBatchRunner::run(const int theThreadCount, QStringList& theResults, int& theFailures)
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(theThreadCount);
+
+    BatchRunner aRunner;
+    QVERIFY2(aRunner.load(mJobFile), qPrintable(aRunner.errorString()));
+
+    theFailures = aRunner.run();
+    theResults.clear();
+    mSummary = aRunner.summary();
+
+    foreach (const QString& aName, aRunner.names())
+    {
+        const TopoDS_Shape aShape = aRunner.shape(aName);
+
+        if (aShape.IsNull())
+        {
+            theResults.append(aName + " null");
+            continue;
+        }
+
+        GProp_GProps aVolume;
+        GProp_GProps anArea;
+        BRepGProp::VolumeProperties(aShape, aVolume);
+        BRepGProp::SurfaceProperties(aShape, anArea);
+
+        TopTools_IndexedMapOfShape aFaces;
+        TopExp::MapShapes(aShape, TopAbs_FACE, aFaces);
+
+        theResults.append(QString("%1 valid %2 faces %3 volume %4 area %5")
+                          .arg(aName)
+                          .arg(BRepCheck_Analyzer(aShape).IsValid() ? 1 : 0)
+                          .arg(aFaces.Extent())
+                          .arg(aVolume.Mass(), 0, 'g', 10)
+                          .arg(anArea.Mass(), 0, 'g', 10));
+    }
+}
+
+void TestBatchRunner::sameResultsOnAnyThreadCount()
+{
+    QStringList aSerial;
+    int aSerialFailures = 0;
+
+    run(1, aSerial, aSerialFailures);
+
+    if (QTest::currentTestFailed())
+    {
+        return;
+    }
+
+    QVERIFY(!aSerial.isEmpty());
+
+    // equal failure counts would also hide a job that fails on any thread count.
+    QVERIFY2(aSerialFailures == 0, qPrintable(mSummary));
+
+    // a race does not show on every run, the parallel runs are repeated.
+    const int aThreadCount = qMax(4, QThread::idealThreadCount());
+
+    for (int i = 0; i < 5; ++i)
+    {
+        QStringList aParallel;
+        int aParallelFailures = 0;
+
+        run(aThreadCount, aParallel, aParallelFailures);
+
+        if (QTest::currentTestFailed())
+        {
+            return;
+        }
+
+        QCOMPARE(aParallelFailures, aSerialFailures);
+        QCOMPARE(aParallel, aSerial);
+    }
+}
+
+QTEST_GUILESS_MAIN(TestBatchRunner)
+
+#include "tst_batchrunner.moc"
@@ -0,0 +1,19 @@
+#-------------------------------------------------
+#
+# Saves a mesh with one cache and loads it with another, and checks that
+# damaged mesh files are dropped and meshed again.
+#
+#-------------------------------------------------
+
+QT       += core gui concurrent testlib
+QT       -= widgets
+
+TARGET = tst_meshcache
+TEMPLATE = app
+
+CONFIG += testcase console c++11
+CONFIG -= app_bundle
+
+SOURCES += tst_meshcache.cpp
+
+include(../../modeling/modeling.pri)
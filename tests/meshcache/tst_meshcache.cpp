@@ -0,0 +1,170 @@
+#include "meshcache.h"
+#include "shapefactory.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtTest>
+
+#include <gp_Ax2.hxx>
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+
+#include <BRep_Tool.hxx>
+#include <Poly_Triangulation.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+
+//! A mesh saved by one cache is attached by another. A damaged file must
+//! never attach a triangulation, it is dropped and the shape meshed again.
+class TestMeshCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void damagedFile_data();
+    void damagedFile();
+
+private:
+    //! the same B-Rep on every call, with new TShapes and no mesh. The box cut
+    //! by a tilted sphere has faces the closed-form mesher leaves to BRepMesh.
+    static TopoDS_Shape makeShape();
+
+    //! the triangles of all the faces, -1 when a face has no triangulation.
+    static int triangleCount(const TopoDS_Shape& theShape);
+
+    //! the single mesh file of theDirectory, empty when there is none or several.
+    static QString meshFile(const QString& theDirectory);
+};
+
+TopoDS_Shape TestMeshCache::makeShape()
+{
+    const TopoDS_Shape aBox = ShapeFactory::makeBox(gp_Ax2(), 10.0, 10.0, 10.0);
+    const TopoDS_Shape aSphere = ShapeFactory::makeSphere(gp_Ax2(gp_Pnt(10.0, 10.0, 10.0), gp_Dir(1.0, 1.0, 1.0)), 5.0);
+
+    return ShapeFactory::cut(aBox, aSphere);
+}
+
+int TestMeshCache::triangleCount(const TopoDS_Shape& theShape)
+{
+    int aCount = 0;
+
+    for (TopExp_Explorer anExp(theShape, TopAbs_FACE); anExp.More(); anExp.Next())
+    {
+        TopLoc_Location aLocation;
+        Handle_Poly_Triangulation aTriangulation = BRep_Tool::Triangulation(TopoDS::Face(anExp.Current()), aLocation);
+
+        if (aTriangulation.IsNull())
+        {
+            return -1;
+        }
+
+        aCount += aTriangulation->NbTriangles();
+    }
+
+    return aCount;
+}
+
+QString TestMeshCache::meshFile(const QString& theDirectory)
+{
+    const QStringList aFiles = QDir(theDirectory).entryList(QStringList() << "*.mesh", QDir::Files);
+
+    return aFiles.size() == 1 ? QDir(theDirectory).filePath(aFiles.first()) : QString();
+}
+
+void TestMeshCache::roundTrip()
+{
+    QTemporaryDir aDirectory;
+    QVERIFY(aDirectory.isValid());
+
+    const TopoDS_Shape aSaved = makeShape();
+    const Standard_Real aDeflection = MeshCache::deflection(aSaved);
+
+    MeshCache aWriter(aDirectory.path());
+    QVERIFY(!aWriter.mesh(aSaved, aDeflection));
+    QCOMPARE(aWriter.misses(), 1);
+    QVERIFY(triangleCount(aSaved) > 0);
+    QVERIFY(!meshFile(aDirectory.path()).isEmpty());
+
+    const TopoDS_Shape aLoaded = makeShape();
+
+    MeshCache aReader(aDirectory.path());
+    QVERIFY(aReader.mesh(aLoaded, aDeflection));
+    QCOMPARE(aReader.hits(), 1);
+    QCOMPARE(aReader.misses(), 0);
+    QCOMPARE(triangleCount(aLoaded), triangleCount(aSaved));
+}
+
+void TestMeshCache::damagedFile_data()
+{
+    QTest::addColumn<QByteArray>("damage");
+
+    QTest::newRow("truncated") << QByteArray("truncated");
+    QTest::newRow("huge node count") << QByteArray("node count");
+    QTest::newRow("node index out of range") << QByteArray("triangle index");
+    QTest::newRow("trailing bytes") << QByteArray("trailing");
+}
+
+void TestMeshCache::damagedFile()
+{
+    QFETCH(QByteArray, damage);
+
+    QTemporaryDir aDirectory;
+    QVERIFY(aDirectory.isValid());
+
+    const Standard_Real aDeflection = MeshCache::deflection(makeShape());
+
+    MeshCache aWriter(aDirectory.path());
+    aWriter.mesh(makeShape(), aDeflection);
+
+    const QString aFileName = meshFile(aDirectory.path());
+    QVERIFY(!aFileName.isEmpty());
+
+    QFile aFile(aFileName);
+    QVERIFY(aFile.open(QIODevice::ReadWrite));
+
+    QByteArray aData = aFile.readAll();
+    QVERIFY(aData.size() > 32);
+
+    if (damage == "truncated")
+    {
+        aData.truncate(aData.size() / 2);
+    }
+    else if (damage == "node count")
+    {
+        // the node count of the first face follows the magic, the version and the face count.
+        aData.replace(12, 4, QByteArray("\xf0\xff\xff\x7f", 4));
+    }
+    else if (damage == "triangle index")
+    {
+        // the last node index of the last triangle of the last face.
+        aData.replace(aData.size() - 4, 4, QByteArray("\xff\xff\xff\x00", 4));
+    }
+    else
+    {
+        aData.append("junk");
+    }
+
+    QVERIFY(aFile.resize(0));
+    QCOMPARE(aFile.write(aData), qint64(aData.size()));
+    aFile.close();
+
+    const TopoDS_Shape aShape = makeShape();
+
+    MeshCache aReader(aDirectory.path());
+    QVERIFY(!aReader.mesh(aShape, aDeflection));
+    QCOMPARE(aReader.hits(), 0);
+    QCOMPARE(aReader.misses(), 1);
+
+    // meshed by BRepMesh instead.
+    QVERIFY(triangleCount(aShape) > 0);
+
+    // the damaged file was replaced by a good one.
+    MeshCache aThird(aDirectory.path());
+    QVERIFY(aThird.mesh(makeShape(), aDeflection));
+}
+
+QTEST_GUILESS_MAIN(TestMeshCache)
+
+#include "tst_meshcache.moc"
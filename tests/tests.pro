@@ -0,0 +1,11 @@
+#-------------------------------------------------
+#
+# Unit tests, run with "make check".
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS += analyticmesher \
+    batchrunner \
+    meshcache
@@ -0,0 +1,252 @@
+#include "viewculler.h"
+
+#include <QMutableHashIterator>
+#include <QSet>
+
+#include <AIS_ListIteratorOfListOfInteractive.hxx>
+#include <AIS_ListOfInteractive.hxx>
+#include <AIS_Shape.hxx>
+#include <BRepBndLib.hxx>
+#include <Prs3d_Presentation.hxx>
+#include <PrsMgr_Presentation.hxx>
+#include <PrsMgr_Presentations.hxx>
+
+ViewCuller::ViewCuller(const Handle_AIS_InteractiveContext& theContext)
+    : mContext(theContext),
+      mIsEnabled(true),
+      mPixelThreshold(2.0),
+      mProjectionStamp(0),
+      mDrawnCount(0),
+      mOutsideCount(0),
+      mSmallCount(0)
+{
+}
+
+void ViewCuller::setEnabled(const bool theIsEnabled)
+{
+    mIsEnabled = theIsEnabled;
+
+    if (!mIsEnabled)
+    {
+        restore();
+    }
+}
+
+bool ViewCuller::isEnabled() const
+{
+    return mIsEnabled;
+}
+
+void ViewCuller::setPixelThreshold(const double theThreshold)
+{
+    mPixelThreshold = theThreshold;
+
+    // every box is classified again on the next update.
+    ++mProjectionStamp;
+}
+
+double ViewCuller::pixelThreshold() const
+{
+    return mPixelThreshold;
+}
+
+void ViewCuller::update(const Handle_V3d_View& theView)
+{
+    if (!mIsEnabled)
+    {
+        return;
+    }
+
+    const ViewProjection aProjection(theView);
+
+    if (aProjection != mProjection)
+    {
+        mProjection = aProjection;
+        ++mProjectionStamp;
+    }
+
+    mDrawnCount = 0;
+    mOutsideCount = 0;
+    mSmallCount = 0;
+
+    AIS_ListOfInteractive aDisplayedList;
+    mContext->DisplayedObjects(aDisplayedList, Standard_True);
+
+    QSet<const void*> aDisplayed;
+
+    for (AIS_ListIteratorOfListOfInteractive anIter(aDisplayedList); anIter.More(); anIter.Next())
+    {
+        const void* aKey = anIter.Value().Access();
+        aDisplayed.insert(aKey);
+
+        QHash<const void*, Entry>::iterator anEntryIter = mEntries.find(aKey);
+
+        if (anEntryIter == mEntries.end())
+        {
+            Entry anEntry;
+            anEntry.object = anIter.Value();
+            anEntry.isCulled = false;
+            anEntry.isExcluded = false;
+            anEntry.stamp = -1;
+
+            anEntryIter = mEntries.insert(aKey, anEntry);
+        }
+
+        Entry& anEntry = anEntryIter.value();
+
+        if (anEntry.isExcluded)
+        {
+            continue;
+        }
+
+        const Bnd_Box& aBox = boundingBox(anEntry);
+
+        // an unchanged box seen by an unchanged camera keeps its classification.
+        if (anEntry.stamp != mProjectionStamp)
+        {
+            int aPxmin = 0, aPymin = 0, aPxmax = 0, aPymax = 0;
+
+            // objects without a box, e.g. batches and instances, are always drawn.
+            anEntry.isOutside = false;
+            anEntry.isSmall = false;
+
+            if (mProjection.project(aBox, aPxmin, aPymin, aPxmax, aPymax))
+            {
+                anEntry.isOutside = aPxmax < 0 || aPymax < 0 || aPxmin > mProjection.width() || aPymin > mProjection.height();
+                anEntry.isSmall = !anEntry.isOutside && qMax(aPxmax - aPxmin, aPymax - aPymin) < mPixelThreshold;
+            }
+
+            anEntry.stamp = mProjectionStamp;
+        }
+
+        if (anEntry.isOutside || anEntry.isSmall)
+        {
+            anEntry.isOutside ? ++mOutsideCount : ++mSmallCount;
+
+            if (!anEntry.isCulled)
+            {
+                setVisible(anEntry.object, false);
+                anEntry.isCulled = true;
+            }
+        }
+        else
+        {
+            ++mDrawnCount;
+
+            if (anEntry.isCulled)
+            {
+                setVisible(anEntry.object, true);
+                anEntry.isCulled = false;
+            }
+        }
+    }
+
+    // erased or removed objects are shown again, so a later display finds them visible.
+    QMutableHashIterator<const void*, Entry> anIter(mEntries);
+
+    while (anIter.hasNext())
+    {
+        anIter.next();
+
+        if (!aDisplayed.contains(anIter.key()) && !anIter.value().isExcluded)
+        {
+            if (anIter.value().isCulled)
+            {
+                setVisible(anIter.value().object, true);
+            }
+
+            anIter.remove();
+        }
+    }
+}
+
+void ViewCuller::restore()
+{
+    for (QHash<const void*, Entry>::iterator anIter = mEntries.begin(); anIter != mEntries.end(); ++anIter)
+    {
+        if (anIter.value().isCulled)
+        {
+            setVisible(anIter.value().object, true);
+            anIter.value().isCulled = false;
+        }
+    }
+
+    mOutsideCount = 0;
+    mSmallCount = 0;
+}
+
+void ViewCuller::setExcluded(const Handle_AIS_InteractiveObject& theObject, const bool theIsExcluded)
+{
+    const void* aKey = theObject.Access();
+
+    if (!theIsExcluded)
+    {
+        mEntries.remove(aKey);
+        return;
+    }
+
+    Entry& anEntry = mEntries[aKey];
+
+    if (anEntry.object.IsNull())
+    {
+        anEntry.object = theObject;
+    }
+    else if (anEntry.isCulled)
+    {
+        setVisible(theObject, true);
+    }
+
+    anEntry.isCulled = false;
+    anEntry.isExcluded = true;
+    anEntry.stamp = -1;
+}
+
+void ViewCuller::clear()
+{
+    mEntries.clear();
+
+    mDrawnCount = 0;
+    mOutsideCount = 0;
+    mSmallCount = 0;
+}
+
+int ViewCuller::drawnCount() const
+{
+    return mDrawnCount;
+}
+
+int ViewCuller::outsideCount() const
+{
+    return mOutsideCount;
+}
+
+int ViewCuller::smallCount() const
+{
+    return mSmallCount;
+}
+
+void ViewCuller::setVisible(const Handle_AIS_InteractiveObject& theObject, const bool theIsVisible)
+{
+    const PrsMgr_Presentations& aPresentations = theObject->Presentations();
+
+    for (Standard_Integer i = 1; i <= aPresentations.Length(); ++i)
+    {
+        aPresentations(i).Presentation()->Presentation()->SetVisible(theIsVisible);
+    }
+}
+
+const Bnd_Box& ViewCuller::boundingBox(Entry& theEntry) const
+{
+    Handle_AIS_Shape aShape = Handle_AIS_Shape::DownCast(theEntry.object);
+
+    if (!aShape.IsNull() && !aShape->Shape().IsEqual(theEntry.boxShape))
+    {
+        theEntry.boxShape = aShape->Shape();
+        theEntry.box.SetVoid();
+        theEntry.stamp = -1;
+
+        BRepBndLib::Add(theEntry.boxShape, theEntry.box);
+    }
+
+    return theEntry.box;
+}
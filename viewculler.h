@@ -0,0 +1,88 @@
+#ifndef VIEWCULLER_H
+#define VIEWCULLER_H
+
+#include <QHash>
+
+#include <Bnd_Box.hxx>
+#include <TopoDS_Shape.hxx>
+
+#include "viewprojection.h"
+
+#include <AIS_InteractiveContext.hxx>
+#include <AIS_InteractiveObject.hxx>
+#include <V3d_View.hxx>
+
+//! View-frustum and small-feature culling.
+//! Before a redraw the cached world bounding box of each displayed shape is
+//! projected into the view: shapes outside the window, or smaller than the
+//! pixel threshold, get their structures hidden so the driver skips them.
+//! Only the visibility flag changes, the presentations are kept. A box is
+//! only projected again when the camera, the window or the box changed, so
+//! a redraw of an unchanged view just walks the displayed objects.
+class ViewCuller
+{
+public:
+    explicit ViewCuller(const Handle_AIS_InteractiveContext& theContext);
+
+    //! when off, everything hidden by the culling is shown again.
+    void setEnabled(const bool theIsEnabled);
+    bool isEnabled() const;
+
+    //! shapes whose projected box is smaller than this, in pixels, are dropped.
+    void setPixelThreshold(const double theThreshold);
+    double pixelThreshold() const;
+
+    //! hide or show the displayed shapes for the current camera of theView.
+    void update(const Handle_V3d_View& theView);
+
+    //! show everything hidden by the culling, e.g. before fitting the view to the scene.
+    void restore();
+
+    //! an excluded object is never culled, its visibility belongs to someone else.
+    void setExcluded(const Handle_AIS_InteractiveObject& theObject, const bool theIsExcluded);
+
+    //! forget all objects, e.g. after the context was cleared.
+    void clear();
+
+    //! counters of the last update.
+    int drawnCount() const;
+    int outsideCount() const;
+    int smallCount() const;
+
+private:
+    struct Entry
+    {
+        Handle_AIS_InteractiveObject object;
+
+        //! the shape the box was computed for, the box is refreshed when it changes.
+        TopoDS_Shape boxShape;
+        Bnd_Box box;
+
+        bool isCulled;
+        bool isExcluded;
+
+        //! the classification of the box, valid while stamp is the stamp of the projection.
+        int stamp;
+        bool isOutside;
+        bool isSmall;
+    };
+
+    static void setVisible(const Handle_AIS_InteractiveObject& theObject, const bool theIsVisible);
+    const Bnd_Box& boundingBox(Entry& theEntry) const;
+
+    Handle_AIS_InteractiveContext mContext;
+    bool mIsEnabled;
+    double mPixelThreshold;
+
+    QHash<const void*, Entry> mEntries;
+
+    //! the camera the boxes were classified with, and its stamp.
+    ViewProjection mProjection;
+    int mProjectionStamp;
+
+    int mDrawnCount;
+    int mOutsideCount;
+    int mSmallCount;
+};
+
+#endif // VIEWCULLER_H
@@ -0,0 +1,151 @@
+#include "viewprojection.h"
+
+#include <QtGlobal>
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+#include <Aspect_Window.hxx>
+#include <gp.hxx>
+#include <gp_Vec.hxx>
+
+namespace
+{
+    //! a pixel coordinate, open boxes project far outside any window without overflowing.
+    int toPixel(const Standard_Real theValue)
+    {
+        return int(std::floor(qBound(Standard_Real(INT_MIN / 2), theValue, Standard_Real(INT_MAX / 2))));
+    }
+}
+
+ViewProjection::ViewProjection()
+    : mToConvert(false),
+      mScale(0.0),
+      mWidth(0),
+      mHeight(0)
+{
+    std::fill(mState, mState + STATE_SIZE, 0.0);
+}
+
+ViewProjection::ViewProjection(const Handle_V3d_View& theView)
+    : mView(theView),
+      mToConvert(true),
+      mScale(0.0),
+      mWidth(0),
+      mHeight(0)
+{
+    std::fill(mState, mState + STATE_SIZE, 0.0);
+
+    if (theView.IsNull() || theView->Window().IsNull())
+    {
+        mView.Nullify();
+        return;
+    }
+
+    Standard_Integer aWidth = 0, aHeight = 0;
+    theView->Window()->Size(aWidth, aHeight);
+
+    mWidth = aWidth;
+    mHeight = aHeight;
+
+    Standard_Real* aState = mState;
+    theView->Eye(aState[0], aState[1], aState[2]);
+    theView->At(aState[3], aState[4], aState[5]);
+    theView->Up(aState[6], aState[7], aState[8]);
+    theView->Size(aState[9], aState[10]);
+    aState[11] = aWidth * 65536.0 + aHeight;
+    aState[12] = theView->Type();
+
+    const gp_Vec aDirection(gp_Pnt(aState[0], aState[1], aState[2]), gp_Pnt(aState[3], aState[4], aState[5]));
+    const gp_Vec anUp(aState[6], aState[7], aState[8]);
+    const gp_Vec aRight = aDirection.Crossed(anUp);
+
+    if (theView->Type() == V3d_PERSPECTIVE || aState[9] <= 0.0
+        || aRight.Magnitude() <= gp::Resolution() * aDirection.Magnitude() * anUp.Magnitude())
+    {
+        return;
+    }
+
+    mToConvert = false;
+    mAt.SetCoord(aState[3], aState[4], aState[5]);
+    mRight = gp_Dir(aRight);
+    mUp = gp_Dir(aRight.Crossed(aDirection));
+    mScale = aWidth / aState[9];
+}
+
+bool ViewProjection::isNull() const
+{
+    return mView.IsNull();
+}
+
+int ViewProjection::width() const
+{
+    return mWidth;
+}
+
+int ViewProjection::height() const
+{
+    return mHeight;
+}
+
+bool ViewProjection::project(const Bnd_Box& theBox, int& theXmin, int& theYmin, int& theXmax, int& theYmax) const
+{
+    if (theBox.IsVoid() || mView.IsNull())
+    {
+        return false;
+    }
+
+    Standard_Real aCorner[6];
+    theBox.Get(aCorner[0], aCorner[1], aCorner[2], aCorner[3], aCorner[4], aCorner[5]);
+
+    if (mToConvert)
+    {
+        theXmin = INT_MAX;
+        theYmin = INT_MAX;
+        theXmax = INT_MIN;
+        theYmax = INT_MIN;
+
+        for (int i = 0; i < 8; ++i)
+        {
+            Standard_Integer aPx = 0, aPy = 0;
+            mView->Convert(aCorner[(i & 1) ? 3 : 0], aCorner[(i & 2) ? 4 : 1], aCorner[(i & 4) ? 5 : 2], aPx, aPy);
+
+            theXmin = qMin(theXmin, int(aPx));
+            theXmax = qMax(theXmax, int(aPx));
+            theYmin = qMin(theYmin, int(aPy));
+            theYmax = qMax(theYmax, int(aPy));
+        }
+
+        return true;
+    }
+
+    // the projection of an axis aligned box is the projection of its center
+    // widened by the projected half sizes, the pixel rows grow downwards.
+    const gp_XYZ aCenter = (gp_XYZ(aCorner[0], aCorner[1], aCorner[2]) + gp_XYZ(aCorner[3], aCorner[4], aCorner[5])) * 0.5;
+    const gp_XYZ aHalf = (gp_XYZ(aCorner[3], aCorner[4], aCorner[5]) - gp_XYZ(aCorner[0], aCorner[1], aCorner[2])) * 0.5;
+    const gp_XYZ anOffset = aCenter - mAt.XYZ();
+
+    const Standard_Real aX = mWidth * 0.5 + anOffset.Dot(mRight.XYZ()) * mScale;
+    const Standard_Real aY = mHeight * 0.5 - anOffset.Dot(mUp.XYZ()) * mScale;
+
+    const Standard_Real aDx = (Abs(mRight.X()) * aHalf.X() + Abs(mRight.Y()) * aHalf.Y() + Abs(mRight.Z()) * aHalf.Z()) * mScale;
+    const Standard_Real aDy = (Abs(mUp.X()) * aHalf.X() + Abs(mUp.Y()) * aHalf.Y() + Abs(mUp.Z()) * aHalf.Z()) * mScale;
+
+    theXmin = toPixel(aX - aDx);
+    theXmax = toPixel(aX + aDx);
+    theYmin = toPixel(aY - aDy);
+    theYmax = toPixel(aY + aDy);
+
+    return true;
+}
+
+bool ViewProjection::operator==(const ViewProjection& theOther) const
+{
+    return mView == theOther.mView && std::equal(mState, mState + STATE_SIZE, theOther.mState);
+}
+
+bool ViewProjection::operator!=(const ViewProjection& theOther) const
+{
+    return !(*this == theOther);
+}
@@ -0,0 +1,56 @@
+#ifndef VIEWPROJECTION_H
+#define VIEWPROJECTION_H
+
+#include <Bnd_Box.hxx>
+#include <gp_Dir.hxx>
+#include <gp_Pnt.hxx>
+
+#include <V3d_View.hxx>
+
+//! The camera and window of a view captured once, to project many world
+//! boxes to pixels without eight V3d_View::Convert() calls per box. An
+//! orthographic box is projected from its center and half sizes; a
+//! perspective camera falls back to converting the corners. Two captures
+//! compare equal as long as the camera and the window size did not change,
+//! so projected boxes can be kept until then.
+class ViewProjection
+{
+public:
+    ViewProjection();
+    explicit ViewProjection(const Handle_V3d_View& theView);
+
+    bool isNull() const;
+
+    //! the window size in pixels.
+    int width() const;
+    int height() const;
+
+    //! the pixel rectangle covered by a world box, false for a void box.
+    bool project(const Bnd_Box& theBox, int& theXmin, int& theYmin, int& theXmax, int& theYmax) const;
+
+    bool operator==(const ViewProjection& theOther) const;
+    bool operator!=(const ViewProjection& theOther) const;
+
+private:
+    enum { STATE_SIZE = 13 };
+
+    Handle_V3d_View mView;
+
+    //! the corners are converted by the view, for a perspective or a degenerate camera.
+    bool mToConvert;
+
+    gp_Pnt mAt;
+    gp_Dir mRight;
+    gp_Dir mUp;
+
+    //! pixels per model unit.
+    Standard_Real mScale;
+
+    int mWidth;
+    int mHeight;
+
+    //! eye, at, up, view size, window size and projection type, for the comparison.
+    Standard_Real mState[STATE_SIZE];
+};
+
+#endif // VIEWPROJECTION_H